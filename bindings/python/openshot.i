@@ -58,7 +58,9 @@
 #include "WriterBase.h"
 #include "AudioDevices.h"
 #include "AudioWaveformer.h"
+#include "BufferPool.h"
 #include "CacheBase.h"
+#include "CacheContent.h"
 #include "CacheDisk.h"
 #include "CacheMemory.h"
 #include "ChannelLayouts.h"
@@ -81,13 +83,16 @@
 #include "FrameMapper.h"
 #include "PlayerBase.h"
 #include "Point.h"
+#include "Profiler.h"
 #include "Profiles.h"
+#include "ProxyGenerator.h"
 #include "QtHtmlReader.h"
 #include "QtImageReader.h"
 #include "QtPlayer.h"
 #include "QtTextReader.h"
 #include "KeyFrame.h"
 #include "RendererBase.h"
+#include "SegmentExporter.h"
 #include "Settings.h"
 #include "TimelineBase.h"
 #include "Timeline.h"
@@ -139,6 +144,8 @@
 %template(MappedFrameVector) std::vector<openshot::MappedFrame>;
 %template(MetadataMap) std::map<std::string, std::string>;
 
+%template(FrameVector) std::vector<std::shared_ptr<openshot::Frame>>;
+
 /* Deprecated */
 %template(AudioDeviceInfoVector) std::vector<openshot::AudioDeviceInfo>;
 
@@ -249,6 +256,139 @@
     %}
 }
 
+/* Python objects which expose the memory of a Frame (without copying it) with the buffer protocol */
+%{
+    /* Keeps the image or audio of a frame alive, while any memoryview (or NumPy array) uses it */
+    typedef struct {
+        PyObject_HEAD
+        std::shared_ptr<void>* owner;
+        void* data;
+        const char* format;
+        Py_ssize_t itemsize;
+        int ndim;
+        Py_ssize_t shape[3];
+        Py_ssize_t strides[3];
+        bool contiguous;
+    } FrameBufferObject;
+
+    static int FrameBuffer_getbuffer(PyObject* obj, Py_buffer* view, int flags) {
+        FrameBufferObject* self = (FrameBufferObject*) obj;
+        if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES && !self->contiguous) {
+            PyErr_SetString(PyExc_BufferError, "Frame buffer is not contiguous (strides are required)");
+            view->obj = NULL;
+            return -1;
+        }
+        view->obj = obj;
+        Py_INCREF(obj);
+        view->buf = self->data;
+        view->len = self->itemsize;
+        for (int i = 0; i < self->ndim; i++)
+            view->len *= self->shape[i];
+        view->readonly = 0;
+        view->itemsize = self->itemsize;
+        view->format = (flags & PyBUF_FORMAT) ? (char*) self->format : NULL;
+        view->ndim = self->ndim;
+        view->shape = (flags & PyBUF_ND) ? self->shape : NULL;
+        view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+        view->suboffsets = NULL;
+        view->internal = NULL;
+        return 0;
+    }
+
+    static void FrameBuffer_dealloc(PyObject* obj) {
+        FrameBufferObject* self = (FrameBufferObject*) obj;
+        delete self->owner;
+        Py_TYPE(obj)->tp_free(obj);
+    }
+
+    static PyBufferProcs FrameBuffer_as_buffer = { FrameBuffer_getbuffer, NULL };
+    static PyTypeObject FrameBufferType = { PyVarObject_HEAD_INIT(NULL, 0) };
+
+    /* Create a memoryview of memory owned by a frame (the owner is kept alive by the memoryview) */
+    static PyObject* FrameBuffer_New(std::shared_ptr<void> owner, void* data, const char* format, Py_ssize_t itemsize,
+                                     int ndim, const Py_ssize_t* shape, const Py_ssize_t* strides) {
+        FrameBufferObject* self = PyObject_New(FrameBufferObject, &FrameBufferType);
+        if (!self)
+            return NULL;
+        self->owner = new std::shared_ptr<void>(owner);
+        self->data = data;
+        self->format = format;
+        self->itemsize = itemsize;
+        self->ndim = ndim;
+        self->contiguous = true;
+        Py_ssize_t contiguous_stride = itemsize;
+        for (int i = ndim - 1; i >= 0; i--) {
+            self->shape[i] = shape[i];
+            self->strides[i] = strides[i];
+            if (shape[i] > 1 && strides[i] != contiguous_stride)
+                self->contiguous = false;
+            contiguous_stride *= shape[i];
+        }
+        PyObject* view = PyMemoryView_FromObject((PyObject*) self);
+        Py_DECREF(self);
+        return view;
+    }
+%}
+
+%init %{
+    FrameBufferType.tp_name = "openshot.FrameBuffer";
+    FrameBufferType.tp_basicsize = sizeof(FrameBufferObject);
+    FrameBufferType.tp_flags = Py_TPFLAGS_DEFAULT;
+    FrameBufferType.tp_doc = "Memory of an openshot.Frame (image or audio)";
+    FrameBufferType.tp_dealloc = FrameBuffer_dealloc;
+    FrameBufferType.tp_as_buffer = &FrameBuffer_as_buffer;
+    PyType_Ready(&FrameBufferType);
+%}
+
+/* These methods create Python objects, so they need to hold the GIL */
+%nothread openshot::Frame::GetImageBuffer;
+%nothread openshot::Frame::GetAudioBuffer;
+
+%extend openshot::Frame {
+    /* The RGBA (premultiplied) pixels of the image, as a writable memoryview of shape (height, width, 4),
+       without copying. For example: numpy.asarray(frame.GetImageBuffer()) */
+    PyObject* GetImageBuffer() {
+        std::shared_ptr<QImage> image = $self->GetImage();
+        const Py_ssize_t shape[3] = { image->height(), image->width(), 4 };
+        const Py_ssize_t strides[3] = { image->bytesPerLine(), 4, 1 };
+        return FrameBuffer_New(image, image->bits(), "B", 1, 3, shape, strides);
+    }
+    /* The planar float samples of the audio, as a writable memoryview of shape (channels, samples), without copying.
+       For example: numpy.asarray(frame.GetAudioBuffer()). Get a new buffer if the frame's audio is resized. */
+    PyObject* GetAudioBuffer() {
+        std::shared_ptr<juce::AudioBuffer<float>> audio = $self->audio;
+        const int channels = audio->getNumChannels();
+        const int samples = audio->getNumSamples();
+
+        // JUCE stores all channels in one block (but channels can be further apart than the number of samples)
+        Py_ssize_t channel_stride = samples;
+        if (channels > 1)
+            channel_stride = audio->getReadPointer(1) - audio->getReadPointer(0);
+        for (int channel = 2; channel < channels; channel++) {
+            if (audio->getReadPointer(channel) - audio->getReadPointer(channel - 1) != channel_stride) {
+                PyErr_SetString(PyExc_BufferError, "Audio channels are not evenly spaced");
+                return NULL;
+            }
+        }
+
+        const Py_ssize_t shape[2] = { channels, samples };
+        const Py_ssize_t strides[2] = { channel_stride * (Py_ssize_t) sizeof(float), sizeof(float) };
+        float* data = channels > 0 ? audio->getWritePointer(0) : NULL;
+        return FrameBuffer_New(audio, data, "f", sizeof(float), 2, shape, strides);
+    }
+}
+
+/* Get a block of frames from a reader in one call (the GIL is released while the frames are decoded) */
+%extend openshot::ReaderBase {
+    std::vector<std::shared_ptr<openshot::Frame>> GetFrames(int64_t start, int64_t count) {
+        std::vector<std::shared_ptr<openshot::Frame>> frames;
+        frames.reserve(std::max<int64_t>(count, 0));
+        for (int64_t number = start; number < start + count; number++)
+            frames.push_back($self->GetFrame(number));
+        return frames;
+    }
+}
+
 %extend openshot::OpenShotVersion {
         // Give the struct a string representation
     const std::string __str__() {
@@ -267,7 +407,9 @@
 %include "WriterBase.h"
 %include "AudioDevices.h"
 %include "AudioWaveformer.h"
+%include "BufferPool.h"
 %include "CacheBase.h"
+%include "CacheContent.h"
 %include "CacheDisk.h"
 %include "CacheMemory.h"
 %include "ChannelLayouts.h"
@@ -290,13 +432,16 @@
 %include "FrameMapper.h"
 %include "PlayerBase.h"
 %include "Point.h"
+%include "Profiler.h"
 %include "Profiles.h"
+%include "ProxyGenerator.h"
 %include "QtHtmlReader.h"
 %include "QtImageReader.h"
 %include "QtPlayer.h"
 %include "QtTextReader.h"
 %include "KeyFrame.h"
 %include "RendererBase.h"
+%include "SegmentExporter.h"
 %include "Settings.h"
 %include "TimelineBase.h"
 %include "Timeline.h"
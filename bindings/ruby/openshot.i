@@ -66,7 +66,9 @@
 #include "WriterBase.h"
 #include "AudioDevices.h"
 #include "AudioWaveformer.h"
+#include "BufferPool.h"
 #include "CacheBase.h"
+#include "CacheContent.h"
 #include "CacheDisk.h"
 #include "CacheMemory.h"
 #include "ChannelLayouts.h"
@@ -89,13 +91,16 @@
 #include "FrameMapper.h"
 #include "PlayerBase.h"
 #include "Point.h"
+#include "Profiler.h"
 #include "Profiles.h"
+#include "ProxyGenerator.h"
 #include "QtHtmlReader.h"
 #include "QtImageReader.h"
 #include "QtPlayer.h"
 #include "QtTextReader.h"
 #include "KeyFrame.h"
 #include "RendererBase.h"
+#include "SegmentExporter.h"
 #include "Settings.h"
 #include "TimelineBase.h"
 #include "Timeline.h"
@@ -137,7 +142,9 @@
 %include "WriterBase.h"
 %include "AudioDevices.h"
 %include "AudioWaveformer.h"
+%include "BufferPool.h"
 %include "CacheBase.h"
+%include "CacheContent.h"
 %include "CacheDisk.h"
 %include "CacheMemory.h"
 %include "ChannelLayouts.h"
@@ -181,13 +188,16 @@
 %include "FrameMapper.h"
 %include "PlayerBase.h"
 %include "Point.h"
+%include "Profiler.h"
 %include "Profiles.h"
+%include "ProxyGenerator.h"
 %include "QtHtmlReader.h"
 %include "QtImageReader.h"
 %include "QtPlayer.h"
 %include "QtTextReader.h"
 %include "KeyFrame.h"
 %include "RendererBase.h"
+%include "SegmentExporter.h"
 %include "Settings.h"
 %include "TimelineBase.h"
 %include "Timeline.h"
@@ -0,0 +1,313 @@
+/**
+ * @file
+ * @brief Source file for Benchmark executable (performance of libopenshot hot paths)
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CacheDisk.h"
+#include "CacheMemory.h"
+#include "Clip.h"
+#include "DummyReader.h"
+#include "EffectBase.h"
+#include "EffectInfo.h"
+#include "FFmpegReader.h"
+#include "FFmpegWriter.h"
+#include "Frame.h"
+#include "KeyFrame.h"
+#include "OpenShotVersion.h"
+#include "Timeline.h"
+
+#include <QDir>
+
+using namespace openshot;
+
+/*
+ * Usage: openshot-benchmark [filter]
+ *
+ * Runs each benchmark (whose "group/name" contains the optional filter), and prints
+ * the results as JSON (to stdout), so they can be compared across versions:
+ *
+ * {"version": "0.2.7", "benchmarks": [{"group": "decode", "name": "test.mp4 (1280x720)",
+ *  "iterations": 100, "seconds": 0.8, "per_second": 125.0}, ...]}
+ *
+ * Progress is printed to stderr.
+ */
+
+// Runs benchmarks and collects their results
+class Benchmarks {
+private:
+	std::string filter;
+	Json::Value results;
+
+public:
+	Benchmarks(std::string filter) : filter(filter), results(Json::arrayValue) { }
+
+	// Is a benchmark selected (by the filter)
+	bool Selected(const std::string& group, const std::string& name) {
+		return (group + "/" + name).find(filter) != std::string::npos;
+	}
+
+	// Time a function (called with iteration 1 to warm up, then iterations 2 to iterations + 1)
+	template <typename Function>
+	void Run(const std::string& group, const std::string& name, int iterations, Function function) {
+		if (!Selected(group, name))
+			return;
+
+		Json::Value result;
+		result["group"] = group;
+		result["name"] = name;
+		result["iterations"] = iterations;
+		try {
+			function(1);
+			auto start = std::chrono::steady_clock::now();
+			for (int iteration = 2; iteration <= iterations + 1; iteration++)
+				function(iteration);
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			result["seconds"] = seconds;
+			result["per_second"] = seconds > 0.0 ? iterations / seconds : 0.0;
+			std::cerr << group << "/" << name << ": " << result["per_second"].asDouble() << " per second" << std::endl;
+		} catch (const std::exception& e) {
+			// Record the failure (and keep running the other benchmarks)
+			result["error"] = e.what();
+			std::cerr << group << "/" << name << ": " << e.what() << std::endl;
+		}
+		results.append(result);
+	}
+
+	// Generate JSON string of the results
+	std::string ToJson() {
+		Json::Value root;
+		root["version"] = OPENSHOT_VERSION_FULL;
+		root["benchmarks"] = results;
+		return root.toStyledString();
+	}
+};
+
+// Create a frame with an image and (noisy) audio
+static std::shared_ptr<Frame> create_frame(int64_t number, int width, int height, int samples)
+{
+	auto frame = std::make_shared<Frame>(number, width, height, "#336699", samples, 2);
+	frame->AddAudioSilence(samples);
+	for (int channel = 0; channel < 2; channel++)
+		for (int sample = 0; sample < samples; sample++)
+			frame->audio->setSample(channel, sample, std::sin(sample * 0.05f + channel) * 0.5f);
+	frame->SampleRate(44100);
+	return frame;
+}
+
+// Decode frames of the example videos (at their own resolution)
+static void decode(Benchmarks& benchmarks)
+{
+	for (std::string file : {"test.mp4", "test1.mp4", "run.mp4"}) {
+		if (!benchmarks.Selected("decode", file))
+			continue;
+
+		FFmpegReader r(TEST_MEDIA_PATH + file);
+		r.Open();
+		std::stringstream name;
+		name << file << " (" << r.info.width << "x" << r.info.height << ")";
+		int iterations = std::min(100, int(r.info.video_length) - 1);
+		benchmarks.Run("decode", name.str(), iterations, [&](int iteration) {
+			r.GetFrame(iteration);
+		});
+		r.Close();
+	}
+
+	// Decode (and scale) a video on timelines of several resolutions
+	for (int height : {360, 720, 1080}) {
+		int width = height * 16 / 9;
+		std::stringstream name;
+		name << "test.mp4 on timeline (" << width << "x" << height << ")";
+		if (!benchmarks.Selected("decode", name.str()))
+			continue;
+
+		Timeline t(width, height, Fraction(30, 1), 44100, 2, LAYOUT_STEREO);
+		Clip clip(TEST_MEDIA_PATH + std::string("test.mp4"));
+		t.AddClip(&clip);
+		t.Open();
+		int iterations = std::min(100, int(clip.Reader()->info.video_length) - 1);
+		benchmarks.Run("decode", name.str(), iterations, [&](int iteration) {
+			t.GetFrame(iteration);
+		});
+		t.Close();
+	}
+}
+
+// Composite layers of (synthetic) clips on a timeline
+static void composite(Benchmarks& benchmarks)
+{
+	for (int layers : {1, 4, 8}) {
+		std::stringstream name;
+		name << layers << " layers (1920x1080)";
+		if (!benchmarks.Selected("composite", name.str()))
+			continue;
+
+		Timeline t(1920, 1080, Fraction(30, 1), 44100, 2, LAYOUT_STEREO);
+		std::vector<std::unique_ptr<DummyReader>> readers;
+		std::vector<std::unique_ptr<Clip>> clips;
+		for (int layer = 1; layer <= layers; layer++) {
+			readers.emplace_back(new DummyReader(Fraction(30, 1), 1920, 1080, 44100, 2, 30.0));
+			clips.emplace_back(new Clip(readers.back().get()));
+
+			// Semi-transparent and scaled clips (so each layer is blended and transformed)
+			clips.back()->Layer(layer);
+			clips.back()->alpha = Keyframe(0.5);
+			clips.back()->scale_x = Keyframe(0.9);
+			clips.back()->scale_y = Keyframe(0.9);
+			t.AddClip(clips.back().get());
+		}
+		t.Open();
+		benchmarks.Run("composite", name.str(), 60, [&](int iteration) {
+			t.GetFrame(iteration);
+		});
+		t.Close();
+	}
+}
+
+// Apply each built-in effect to a frame
+static void effects(Benchmarks& benchmarks)
+{
+	// Effects which need pre-processed data (i.e. from OpenCV)
+	const std::set<std::string> skipped = {"Stabilizer", "Tracker", "ObjectDetection"};
+
+	EffectInfo info;
+	for (const auto& effect_json : EffectInfo::JsonValue()) {
+		std::string class_name = effect_json["class_name"].asString();
+		if (skipped.count(class_name) || !benchmarks.Selected("effect", class_name))
+			continue;
+
+		std::unique_ptr<EffectBase> effect(info.CreateEffect(class_name));
+		if (!effect)
+			continue;
+
+		// Audio effects process a frame of audio (and video effects a 1920x1080 image)
+		int width = effect->info.has_video ? 1920 : 1;
+		int height = effect->info.has_video ? 1080 : 1;
+		std::shared_ptr<Frame> frame = create_frame(1, width, height, 1470);
+		benchmarks.Run("effect", class_name, effect->info.has_video ? 30 : 300, [&](int iteration) {
+			frame = effect->GetFrame(frame, iteration);
+		});
+	}
+}
+
+// Add, get and remove frames of caches
+static void caches(Benchmarks& benchmarks)
+{
+	const std::string memory_name = "CacheMemory add/get (1280x720)";
+	const std::string disk_name = "CacheDisk add/get (1280x720)";
+	if (!benchmarks.Selected("cache", memory_name) && !benchmarks.Selected("cache", disk_name))
+		return;
+
+	// Only allocate the frames (about 220 MB) when a cache benchmark runs
+	const int frames = 60;
+	std::vector<std::shared_ptr<Frame>> source_frames;
+	for (int64_t number = 1; number <= frames; number++)
+		source_frames.push_back(create_frame(number, 1280, 720, 1470));
+
+	// Cache a frame (number), and read it back
+	auto cache_ops = [&](CacheBase& cache, int iteration) {
+		std::shared_ptr<Frame> frame = source_frames[(iteration - 1) % frames];
+		cache.Add(frame);
+		cache.GetFrame(frame->number);
+		if (iteration % frames == 0)
+			cache.Clear();
+	};
+
+	{
+		CacheMemory cache(1024 * 1024 * 1024);
+		benchmarks.Run("cache", memory_name, frames * 10, [&](int iteration) {
+			cache_ops(cache, iteration);
+		});
+	}
+
+	if (benchmarks.Selected("cache", disk_name)) {
+		std::string path = QDir::tempPath().toStdString() + "/openshot-benchmark-cache/";
+		CacheDisk cache(path, "ppm", 1.0, 1.0, 1024 * 1024 * 1024);
+		benchmarks.Run("cache", disk_name, frames, [&](int iteration) {
+			cache_ops(cache, iteration);
+		});
+		cache.Clear();
+	}
+}
+
+// Interpolate keyframes (of several interpolation types)
+static void keyframes(Benchmarks& benchmarks)
+{
+	for (InterpolationType interpolation : {LINEAR, BEZIER, CONSTANT}) {
+		std::string name = interpolation == LINEAR ? "linear" : interpolation == BEZIER ? "bezier" : "constant";
+
+		// A keyframe with many points
+		Keyframe k;
+		for (int point = 0; point < 1000; point++)
+			k.AddPoint(1 + point * 30, std::sin(point * 0.1) * 100.0, interpolation);
+
+		double total = 0.0;
+		benchmarks.Run("keyframe", "GetValue " + name, 1000000, [&](int iteration) {
+			// Jump around the keyframe (i.e. like random seeks)
+			total += k.GetValue((int64_t(iteration) * 7919) % 30000);
+		});
+		if (std::isnan(total))
+			std::cerr << "Invalid keyframe value" << std::endl;
+	}
+}
+
+// Encode frames of a timeline
+static void encode(Benchmarks& benchmarks)
+{
+	for (int height : {720, 1080}) {
+		int width = height * 16 / 9;
+		std::stringstream name;
+		name << "mpeg4 (" << width << "x" << height << ")";
+		if (!benchmarks.Selected("encode", name.str()))
+			continue;
+
+		std::vector<std::shared_ptr<Frame>> frames;
+		for (int64_t number = 1; number <= 30; number++)
+			frames.push_back(create_frame(number, width, height, 1470));
+
+		std::string path = QDir::tempPath().toStdString() + "/openshot-benchmark.mp4";
+		FFmpegWriter w(path);
+		w.SetAudioOptions(true, "aac", 44100, 2, LAYOUT_STEREO, 192000);
+		w.SetVideoOptions(true, "mpeg4", Fraction(30, 1), width, height, Fraction(1, 1), false, false, 8000000);
+		w.Open();
+		benchmarks.Run("encode", name.str(), 120, [&](int iteration) {
+			w.WriteFrame(frames[(iteration - 1) % frames.size()]);
+		});
+		w.Close();
+		QDir().remove(QString::fromStdString(path));
+	}
+}
+
+int main(int argc, char* argv[]) {
+
+	// Only run benchmarks containing the filter (if any)
+	Benchmarks benchmarks(argc > 1 ? argv[1] : "");
+
+	decode(benchmarks);
+	composite(benchmarks);
+	effects(benchmarks);
+	caches(benchmarks);
+	keyframes(benchmarks);
+	encode(benchmarks);
+
+	// Machine-readable results
+	std::cout << benchmarks.ToJson();
+	return 0;
+}
@@ -21,7 +21,14 @@ using namespace openshot;
 // Constructor that reads samples from a reader
 AudioReaderSource::AudioReaderSource(ReaderBase *audio_reader, int64_t starting_frame_number)
 	: reader(audio_reader), frame_position(starting_frame_number), videoCache(NULL), frame(NULL),
-      sample_position(0), speed(1), stream_position(0) {
+      sample_position(0), speed(1), stream_position(0), seek_position(starting_frame_number), seek_count(0),
+      handled_seek_count(0), flush_position(starting_frame_number), flush_count(0), flushed_count(0),
+      clock_start(starting_frame_number), clock_samples(0), clock_time(0) {
+
+	// Read ahead (up to) 1 second of samples
+	int channels = reader ? reader->info.channels : 2;
+	int sample_rate = reader ? reader->info.sample_rate : 44100;
+	ring.reset(new AudioRingBuffer(channels, sample_rate));
 }
 
 // Destructor
@@ -29,66 +36,115 @@ AudioReaderSource::~AudioReaderSource()
 {
 }
 
-// Get the next block of audio samples
-void AudioReaderSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+// Seek to a specific frame
+void AudioReaderSource::Seek(int64_t new_position)
 {
-	if (info.numSamples > 0) {
-	    int remaining_samples = info.numSamples;
-	    int remaining_position = info.startSample;
-
-		// Pause and fill buffer with silence (wait for pre-roll)
-		if (speed != 1 || !videoCache->isReady()) {
-			info.buffer->clear();
-			return;
+	// Nothing to flush if the ring buffer still starts at this frame (i.e. no samples were played since the
+	// last flush, which happens on each call while paused), or if a flush to this frame is still pending
+	if (new_position == seek_position && (clock_samples == 0 || flushed_count != flush_count))
+		return;
+
+	seek_position = new_position;
+	seek_count++;
+}
+
+// Get the frame number being played (the audio clock)
+int64_t AudioReaderSource::getClockPosition() const
+{
+	// The clock stops when the audio callback stops playing samples
+	int64_t now = juce::Time::getMillisecondCounter();
+	if (!reader || clock_time == 0 || now - clock_time > 100)
+		return 0;
+	double seconds = double(clock_samples) / reader->info.sample_rate;
+	return clock_start + int64_t(seconds * reader->info.fps.ToDouble());
+}
+
+// Read frames from the reader into the ring buffer
+bool AudioReaderSource::fillBuffer()
+{
+	if (!reader)
+		return false;
+
+	// Seek (and ask the audio callback to discard the samples of the previous position)
+	if (seek_count != handled_seek_count) {
+		handled_seek_count = seek_count;
+		frame_position = seek_position;
+		sample_position = 0;
+		flush_position = frame_position;
+		flush_count++;
+	}
+
+	// Don't write samples of the new position, until the old samples are discarded
+	if (flushed_count != flush_count)
+		return false;
+
+	// Only read ahead at normal speed (the next frame isn't frame_position + 1 at other speeds, or while paused)
+	if (speed != 1)
+		return false;
+
+	bool has_written = false;
+	while (ring->Free() > 0 && seek_count == handled_seek_count) {
+		if (!frame || frame->number != frame_position) {
+			try {
+				// Get the next frame (which can wait on the reader)
+				frame = reader->GetFrame(frame_position);
+			}
+			catch (const ReaderClosed & e) { return has_written; }
+			catch (const OutOfBoundsFrame & e) { return has_written; }
+			if (!frame)
+				return has_written;
 		}
 
-        while (remaining_samples > 0) {
-
-            try {
-                // Get current frame object
-                if (reader) {
-                    frame = reader->GetFrame(frame_position);
-                }
-            }
-            catch (const ReaderClosed & e) { }
-            catch (const OutOfBoundsFrame & e) { }
-
-            // Get audio samples
-            if (reader && frame) {
-                if (sample_position + remaining_samples <= frame->GetAudioSamplesCount()) {
-                    // Success, we have enough samples
-                    for (int channel = 0; channel < frame->GetAudioChannelsCount(); channel++) {
-                        if (channel < info.buffer->getNumChannels()) {
-                            info.buffer->addFrom(channel, remaining_position, *frame->GetAudioSampleBuffer(),
-                                                 channel, sample_position, remaining_samples);
-                        }
-                    }
-                    sample_position += remaining_samples;
-                    remaining_position += remaining_samples;
-                    remaining_samples = 0;
-
-                } else if (sample_position + remaining_samples > frame->GetAudioSamplesCount()) {
-                    // Not enough samples, take what we can
-                    int amount_to_copy = frame->GetAudioSamplesCount() - sample_position;
-                    for (int channel = 0; channel < frame->GetAudioChannelsCount(); channel++) {
-                        if (channel < info.buffer->getNumChannels()) {
-                            info.buffer->addFrom(channel, remaining_position, *frame->GetAudioSampleBuffer(), channel,
-                                                 sample_position, amount_to_copy);
-                        }
-                    }
-                    sample_position += amount_to_copy;
-                    remaining_position += amount_to_copy;
-                    remaining_samples -= amount_to_copy;
-                }
-
-                // Increment frame position (if samples are all used up)
-                if (sample_position == frame->GetAudioSamplesCount()) {
-                    frame_position += speed;
-                    sample_position = 0; // reset for new frame
-                }
-
-            }
+		// Write the remaining samples of the frame
+		int remaining_samples = frame->GetAudioSamplesCount() - sample_position;
+		if (remaining_samples > 0) {
+			int written = ring->Write(*frame->GetAudioSampleBuffer(), sample_position, remaining_samples);
+			sample_position += written;
+			has_written = has_written || written > 0;
 		}
+
+		// Next frame (if samples are all used up)
+		if (sample_position >= frame->GetAudioSamplesCount()) {
+			frame_position++;
+			sample_position = 0;
+		}
+	}
+
+	return has_written;
+}
+
+// Get the next block of audio samples
+void AudioReaderSource::getNextAudioBlock(const juce::AudioSourceChannelInfo& info)
+{
+	if (info.numSamples <= 0)
+		return;
+
+	// Discard the samples of the previous position (after a seek)
+	int64_t pending_flush = flush_count;
+	if (flushed_count != pending_flush) {
+		ring->Discard();
+		clock_start = flush_position.load();
+		clock_samples = 0;
+		flushed_count = pending_flush;
+	}
+
+	// Pause and fill buffer with silence (wait for pre-roll)
+	if (speed != 1 || (videoCache && !videoCache->isReady())) {
+		info.clearActiveBufferRegion();
+		return;
+	}
+
+	// Play the samples read ahead (and silence, if the feeder thread is behind)
+	int read = ring->Read(*info.buffer, info.startSample, info.numSamples);
+	for (int channel = ring->GetChannels(); channel < info.buffer->getNumChannels(); channel++)
+		info.buffer->clear(channel, info.startSample, read);
+	if (read < info.numSamples)
+		info.buffer->clear(info.startSample + read, info.numSamples - read);
+
+	// Update the audio clock
+	if (read > 0) {
+		clock_samples += read;
+		clock_time = juce::Time::getMillisecondCounter();
 	}
 }
 
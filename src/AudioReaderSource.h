@@ -13,9 +13,13 @@
 #ifndef OPENSHOT_AUDIOREADERSOURCE_H
 #define OPENSHOT_AUDIOREADERSOURCE_H
 
+#include "AudioRingBuffer.h"
 #include "ReaderBase.h"
 #include "Qt/VideoCacheThread.h"
 
+#include <atomic>
+#include <memory>
+
 #include <AppConfig.h>
 #include <juce_audio_basics/juce_audio_basics.h>
 
@@ -26,7 +30,13 @@ namespace openshot
 	/**
 	 * @brief This class is used to expose any ReaderBase derived class as an AudioSource in JUCE.
 	 *
-	 * This allows any reader to play audio through JUCE (our audio framework).
+	 * This allows any reader to play audio through JUCE (our audio framework). The realtime audio
+	 * callback (getNextAudioBlock) never calls the reader, it only reads samples from a lock-free
+	 * ring buffer, which a feeder thread fills ahead of time (see fillBuffer). If the ring buffer
+	 * runs out, silence is played (instead of blocking the audio device).
+	 *
+	 * The position of the samples being played is the audio clock (see getClockPosition), which the
+	 * video playback follows.
 	 */
 	class AudioReaderSource : public juce::PositionableAudioSource
 	{
@@ -40,6 +50,17 @@ namespace openshot
 		int64_t sample_position; /// The position of the current frame's audio buffer
         openshot::VideoCacheThread *videoCache; /// The cache thread (for pre-roll checking)
 
+		std::unique_ptr<AudioRingBuffer> ring; /// The samples read ahead (by the feeder thread)
+		std::atomic<int64_t> seek_position; /// The frame requested by the last Seek()
+		std::atomic<int64_t> seek_count; /// The number of Seek() calls
+		int64_t handled_seek_count; /// The number of Seek() calls handled by the feeder thread
+		std::atomic<int64_t> flush_position; /// The first frame after the pending flush of the ring buffer
+		std::atomic<int64_t> flush_count; /// The number of flushes requested (by the feeder thread)
+		std::atomic<int64_t> flushed_count; /// The number of flushes done (by the audio callback)
+		std::atomic<int64_t> clock_start; /// The first frame played since the last flush
+		std::atomic<int64_t> clock_samples; /// The number of samples played since the last flush
+		std::atomic<int64_t> clock_time; /// The time (in milliseconds) of the last played samples
+
 	public:
 
 		/// @brief Constructor that reads samples from a reader
@@ -50,10 +71,17 @@ namespace openshot
 		/// Destructor
 		~AudioReaderSource();
 
-		/// @brief Get the next block of audio samples
+		/// @brief Get the next block of audio samples (from the ring buffer, without waiting)
 		/// @param info This struct informs us of which samples are needed next.
 		void getNextAudioBlock (const juce::AudioSourceChannelInfo& info);
 
+		/// @brief Read frames from the reader into the ring buffer (called by the feeder thread)
+		/// @returns True if samples were written (false if the ring buffer is full, waiting on a flush, or not at normal speed)
+		bool fillBuffer();
+
+		/// Get the frame number being played (the audio clock), or 0 if no audio is playing
+		int64_t getClockPosition() const;
+
 		/// Prepare to play this audio source
 		void prepareToPlay(int, double);
 
@@ -93,8 +121,8 @@ namespace openshot
 	    /// Get Reader
 	    ReaderBase* Reader() const { return reader; }
 
-	    /// Seek to a specific frame
-	    void Seek(int64_t new_position) { frame_position = new_position; sample_position=0; }
+	    /// Seek to a specific frame (the feeder thread flushes the ring buffer, unless it already starts at this frame)
+	    void Seek(int64_t new_position);
 
 	};
 
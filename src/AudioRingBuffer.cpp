@@ -0,0 +1,86 @@
+/**
+ * @file
+ * @brief Source file for AudioRingBuffer class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+
+#include "AudioRingBuffer.h"
+
+using namespace openshot;
+
+// Constructor
+AudioRingBuffer::AudioRingBuffer(int channels, int capacity)
+	: samples(std::max(1, channels), std::max(1, capacity)), capacity(std::max(1, capacity)),
+	  write_count(0), read_count(0)
+{
+	samples.clear();
+}
+
+// Get the number of samples which can be read
+int AudioRingBuffer::Available() const
+{
+	return write_count.load(std::memory_order_acquire) - read_count.load(std::memory_order_acquire);
+}
+
+// Discard all samples which can be read
+void AudioRingBuffer::Discard()
+{
+	read_count.store(write_count.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// Read samples into an audio buffer
+int AudioRingBuffer::Read(juce::AudioBuffer<float>& destination, int start_sample, int num_samples)
+{
+	int64_t read_position = read_count.load(std::memory_order_relaxed);
+	int amount = std::min(num_samples, int(write_count.load(std::memory_order_acquire) - read_position));
+	if (amount <= 0)
+		return 0;
+
+	// Copy in (up to) 2 blocks, when the samples wrap around the end of the buffer
+	int index = read_position % capacity;
+	int first_block = std::min(amount, capacity - index);
+	int channels = std::min(destination.getNumChannels(), samples.getNumChannels());
+	for (int channel = 0; channel < channels; channel++) {
+		destination.copyFrom(channel, start_sample, samples, channel, index, first_block);
+		if (amount > first_block)
+			destination.copyFrom(channel, start_sample + first_block, samples, channel, 0, amount - first_block);
+	}
+
+	read_count.store(read_position + amount, std::memory_order_release);
+	return amount;
+}
+
+// Write samples from an audio buffer
+int AudioRingBuffer::Write(const juce::AudioBuffer<float>& source, int start_sample, int num_samples)
+{
+	int64_t write_position = write_count.load(std::memory_order_relaxed);
+	int amount = std::min(num_samples, capacity - int(write_position - read_count.load(std::memory_order_acquire)));
+	if (amount <= 0)
+		return 0;
+
+	// Copy in (up to) 2 blocks, when the samples wrap around the end of the buffer
+	int index = write_position % capacity;
+	int first_block = std::min(amount, capacity - index);
+	for (int channel = 0; channel < samples.getNumChannels(); channel++) {
+		if (channel < source.getNumChannels()) {
+			samples.copyFrom(channel, index, source, channel, start_sample, first_block);
+			if (amount > first_block)
+				samples.copyFrom(channel, 0, source, channel, start_sample + first_block, amount - first_block);
+		} else {
+			samples.clear(channel, index, first_block);
+			if (amount > first_block)
+				samples.clear(channel, 0, amount - first_block);
+		}
+	}
+
+	write_count.store(write_position + amount, std::memory_order_release);
+	return amount;
+}
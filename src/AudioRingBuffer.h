@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Header file for AudioRingBuffer class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef OPENSHOT_AUDIORINGBUFFER_H
+#define OPENSHOT_AUDIORINGBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <AppConfig.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+namespace openshot
+{
+	/**
+	 * @brief This class is a lock-free ring buffer of audio samples, for a single writer and a single reader thread.
+	 *
+	 * The realtime audio callback must never wait on a lock (or a reader), so a feeder thread writes
+	 * samples into this buffer ahead of time, and the audio callback only reads (or discards) them.
+	 * Only the writer thread may call Write(), and only the reader thread may call Read() and Discard().
+	 */
+	class AudioRingBuffer
+	{
+	private:
+		juce::AudioBuffer<float> samples;
+		int capacity;
+		std::atomic<int64_t> write_count; ///< Total samples written (only changed by the writer)
+		std::atomic<int64_t> read_count; ///< Total samples read or discarded (only changed by the reader)
+
+	public:
+		/// @brief Constructor
+		/// @param channels The number of audio channels
+		/// @param capacity The max number of samples (per channel) in the buffer
+		AudioRingBuffer(int channels, int capacity);
+
+		/// Get the number of samples which can be read
+		int Available() const;
+
+		/// Get the number of audio channels
+		int GetChannels() const { return samples.getNumChannels(); }
+
+		/// Get the max number of samples in the buffer
+		int GetCapacity() const { return capacity; }
+
+		/// Get the number of samples which can be written
+		int Free() const { return capacity - Available(); }
+
+		/// Discard all samples which can be read (reader thread only)
+		void Discard();
+
+		/// @brief Read samples into an audio buffer (reader thread only)
+		/// @returns The number of samples read (less than num_samples if the buffer runs out)
+		/// @param destination The buffer to copy the samples into (extra channels are not changed)
+		/// @param start_sample The first sample of the destination buffer
+		/// @param num_samples The max number of samples to read
+		int Read(juce::AudioBuffer<float>& destination, int start_sample, int num_samples);
+
+		/// @brief Write samples from an audio buffer (writer thread only)
+		/// @returns The number of samples written (less than num_samples if the buffer is full)
+		/// @param source The buffer to copy the samples from (missing channels are written as silence)
+		/// @param start_sample The first sample of the source buffer
+		/// @param num_samples The max number of samples to write
+		int Write(const juce::AudioBuffer<float>& source, int start_sample, int num_samples);
+	};
+
+}
+
+#endif
@@ -11,6 +11,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "AudioWaveformer.h"
+#include "Timeline.h"
 
 
 using namespace std;
@@ -61,6 +62,15 @@ AudioWaveformData AudioWaveformer::ExtractSamples(int channel, int num_per_secon
             return data;
         }
 
+        // Timelines only need to render audio (skipping video decoding, video effects, and compositing)
+        Timeline* timeline = NULL;
+        bool was_audio_only = false;
+        if (reader->Name() == "Timeline") {
+            timeline = (Timeline*) reader;
+            was_audio_only = timeline->AudioOnly();
+            timeline->AudioOnly(true);
+        }
+
         // Loop through all frames
         int sample_index = 0;
         float samples_max = 0.0;
@@ -125,6 +135,10 @@ AudioWaveformData AudioWaveformer::ExtractSamples(int channel, int num_per_secon
             data.scale(total_samples, scale);
         }
 
+        // Resume previous audio only mode (if a timeline)
+        if (timeline)
+            timeline->AudioOnly(was_audio_only);
+
         // Resume previous has_video value
         reader->info.has_video = does_reader_have_video;
     }
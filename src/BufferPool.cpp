@@ -0,0 +1,301 @@
+/**
+ * @file
+ * @brief Source file for BufferPool class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "BufferPool.h"
+
+#include <AppConfig.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+using namespace openshot;
+
+// The bytes in front of each pooled image buffer (which store its size class)
+#define IMAGE_HEADER_BYTES 64
+
+// The extra samples in each pooled audio buffer (for its list of channel pointers)
+#define AUDIO_HEADROOM_SAMPLES 64
+
+// Global reference to the pool
+BufferPool *BufferPool::m_pInstance = nullptr;
+
+// Create or Get an instance of the pool singleton
+BufferPool *BufferPool::Instance()
+{
+	if (!m_pInstance) {
+		// Create the actual instance of the pool only once
+		m_pInstance = new BufferPool;
+	}
+
+	return m_pInstance;
+}
+
+// Default constructor
+BufferPool::BufferPool() : max_bytes(1024 * 1024 * 256), bytes(0), hits(0), misses(0), released(0) { }
+
+// Round a size up to its size class (with at most 1/8 unused bytes)
+int64_t BufferPool::size_class(int64_t size)
+{
+	// Find the largest power of 2 which is not larger than the size
+	int64_t power = MIN_POOLED_BYTES;
+	while (power * 2 <= size)
+		power *= 2;
+
+	// Round up to the next 1/8 step of that power of 2
+	int64_t step = power / 8;
+	return ((size + step - 1) / step) * step;
+}
+
+// Get an image (of any color) with a pooled buffer
+std::shared_ptr<QImage> BufferPool::GetImage(int width, int height, QImage::Format format)
+{
+	// Bytes per line (each line is 32-bit aligned, just like QImage)
+	const int depth = QImage::toPixelFormat(format).bitsPerPixel();
+	const int bytes_per_line = ((width * depth + 31) >> 5) << 2;
+	const int64_t image_bytes = int64_t(bytes_per_line) * height;
+
+	// Small (or invalid) images are not worth pooling
+	if (width <= 0 || height <= 0 || format == QImage::Format_Invalid || image_bytes < MIN_POOLED_BYTES)
+		return std::make_shared<QImage>(width, height, format);
+
+	const int64_t class_bytes = size_class(image_bytes);
+	unsigned char* block = nullptr;
+	{
+		const std::lock_guard<std::mutex> lock(poolMutex);
+		auto buffers = image_buffers.find(class_bytes);
+		if (buffers != image_buffers.end() && !buffers->second.empty()) {
+			// Reuse an unused buffer
+			block = buffers->second.back();
+			buffers->second.pop_back();
+			bytes -= class_bytes;
+			hits++;
+		} else {
+			misses++;
+		}
+	}
+
+	if (!block) {
+		// Allocate a new buffer (and remember its size class in the header)
+		block = new unsigned char[IMAGE_HEADER_BYTES + class_bytes];
+		*reinterpret_cast<int64_t*>(block) = class_bytes;
+	}
+
+	// The buffer is returned to the pool, when the last QImage using it is destroyed
+	auto image = std::make_shared<QImage>(
+		block + IMAGE_HEADER_BYTES, width, height, bytes_per_line, format,
+		(QImageCleanupFunction) &BufferPool::release_image_buffer, (void*) block);
+
+	if (image->isNull())
+		// QImage did not take the buffer
+		release_image(block);
+
+	return image;
+}
+
+// QImage cleanup function, which returns the image buffer to the pool
+void BufferPool::release_image_buffer(void* info)
+{
+	if (!info)
+		return;
+	Instance()->release_image(reinterpret_cast<unsigned char*>(info));
+}
+
+// Return an image buffer to the pool (or free it)
+void BufferPool::release_image(unsigned char* block)
+{
+	const int64_t class_bytes = *reinterpret_cast<int64_t*>(block);
+	{
+		const std::lock_guard<std::mutex> lock(poolMutex);
+		if (bytes + class_bytes <= max_bytes) {
+			image_buffers[class_bytes].push_back(block);
+			bytes += class_bytes;
+			return;
+		}
+		released++;
+	}
+
+	// Pool is full
+	delete[] block;
+}
+
+// Get an audio buffer (of any samples) from the pool
+std::shared_ptr<juce::AudioBuffer<float>> BufferPool::GetAudioBuffer(int channels, int samples)
+{
+	const int64_t audio_bytes = int64_t(channels) * samples * sizeof(float);
+
+	// Small audio buffers are not worth pooling
+	if (audio_bytes < MIN_POOLED_BYTES)
+		return std::make_shared<juce::AudioBuffer<float>>(channels, samples);
+
+	const int64_t class_bytes = size_class(audio_bytes);
+	juce::AudioBuffer<float>* buffer = nullptr;
+	{
+		const std::lock_guard<std::mutex> lock(poolMutex);
+		auto buffers = audio_buffers.find(class_bytes);
+		if (buffers != audio_buffers.end() && !buffers->second.empty()) {
+			// Reuse an unused buffer
+			buffer = buffers->second.back();
+			buffers->second.pop_back();
+			bytes -= class_bytes;
+			hits++;
+		} else {
+			misses++;
+		}
+	}
+
+	if (!buffer)
+		// Allocate a new buffer (with all the samples of its size class)
+		buffer = new juce::AudioBuffer<float>(1, class_bytes / sizeof(float) + AUDIO_HEADROOM_SAMPLES);
+
+	// Resize (without reallocating the samples)
+	buffer->setSize(channels, samples, false, false, true);
+
+	// The buffer is returned to the pool, when the last shared_ptr using it is destroyed
+	return std::shared_ptr<juce::AudioBuffer<float>>(buffer, [class_bytes](juce::AudioBuffer<float>* b) {
+		Instance()->release_audio(b, class_bytes);
+	});
+}
+
+// Return an audio buffer to the pool (or free it)
+void BufferPool::release_audio(juce::AudioBuffer<float>* buffer, int64_t class_bytes)
+{
+	bool keep = false;
+	{
+		const std::lock_guard<std::mutex> lock(poolMutex);
+		keep = bytes + class_bytes <= max_bytes;
+		if (keep)
+			bytes += class_bytes;
+		else
+			released++;
+	}
+
+	if (!keep) {
+		// Pool is full
+		delete buffer;
+		return;
+	}
+
+	// Restore all the samples of its size class (only allocates if the buffer was shrunk by its frame)
+	buffer->setSize(1, class_bytes / sizeof(float) + AUDIO_HEADROOM_SAMPLES, false, false, true);
+
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	audio_buffers[class_bytes].push_back(buffer);
+}
+
+// Free unused buffers until the pool is under a limit (requires poolMutex)
+void BufferPool::trim(int64_t limit)
+{
+	// Free the largest buffers first
+	for (auto buffers = image_buffers.rbegin(); buffers != image_buffers.rend() && bytes > limit; ++buffers) {
+		while (!buffers->second.empty() && bytes > limit) {
+			delete[] buffers->second.back();
+			buffers->second.pop_back();
+			bytes -= buffers->first;
+		}
+	}
+	for (auto buffers = audio_buffers.rbegin(); buffers != audio_buffers.rend() && bytes > limit; ++buffers) {
+		while (!buffers->second.empty() && bytes > limit) {
+			delete buffers->second.back();
+			buffers->second.pop_back();
+			bytes -= buffers->first;
+		}
+	}
+}
+
+// Free all unused buffers
+void BufferPool::Clear()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	trim(0);
+	image_buffers.clear();
+	audio_buffers.clear();
+}
+
+// Gets the bytes of unused buffers in the pool
+int64_t BufferPool::GetBytes()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	return bytes;
+}
+
+// Gets the max bytes of unused buffers to keep
+int64_t BufferPool::GetMaxBytes()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	return max_bytes;
+}
+
+// Set the max bytes of unused buffers to keep (0 disables the pool)
+void BufferPool::SetMaxBytes(int64_t number_of_bytes)
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	max_bytes = number_of_bytes;
+	trim(max_bytes);
+}
+
+// Gets the number of requests which reused a buffer
+int64_t BufferPool::GetHits()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	return hits;
+}
+
+// Gets the number of requests which allocated a new buffer
+int64_t BufferPool::GetMisses()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	return misses;
+}
+
+// Gets the number of returned buffers which were freed (since the pool was full)
+int64_t BufferPool::GetReleased()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	return released;
+}
+
+// Reset the hits, misses and released counters
+void BufferPool::ResetStatistics()
+{
+	const std::lock_guard<std::mutex> lock(poolMutex);
+	hits = 0;
+	misses = 0;
+	released = 0;
+}
+
+// Generate JSON string of the pool statistics
+std::string BufferPool::Json() {
+
+	// Return formatted string
+	return JsonValue().toStyledString();
+}
+
+// Generate Json::Value of the pool statistics
+Json::Value BufferPool::JsonValue() {
+	const std::lock_guard<std::mutex> lock(poolMutex);
+
+	int64_t count = 0;
+	for (const auto& buffers : image_buffers)
+		count += buffers.second.size();
+	for (const auto& buffers : audio_buffers)
+		count += buffers.second.size();
+
+	// Create root json object
+	Json::Value root;
+	root["max_bytes"] = std::to_string(max_bytes);
+	root["bytes"] = std::to_string(bytes);
+	root["buffers"] = Json::Int64(count);
+	root["hits"] = Json::Int64(hits);
+	root["misses"] = Json::Int64(misses);
+	root["released"] = Json::Int64(released);
+
+	// return JsonValue
+	return root;
+}
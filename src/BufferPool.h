@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Header file for BufferPool class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef OPENSHOT_BUFFER_POOL_H
+#define OPENSHOT_BUFFER_POOL_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Json.h"
+
+#include <QImage>
+
+namespace juce {
+	template <typename Type> class AudioBuffer;
+}
+
+namespace openshot {
+
+	/**
+	 * @brief This class is a pool of image and audio buffers, which are reused by new frames
+	 *
+	 * Every openshot::Frame (i.e. each frame of a Timeline) needs a full size image and an audio buffer.
+	 * Instead of allocating (and page faulting) new memory for each frame, buffers are grouped in size classes,
+	 * and returned to this pool when the last QImage or shared_ptr using them is destroyed (i.e. when a frame
+	 * is removed from a cache). The next frame of a similar size reuses them.
+	 *
+	 * The pool keeps up to GetMaxBytes() of unused buffers (any extra buffers are freed), and tracks how often
+	 * a buffer was reused, which can be used to choose the max bytes.
+	 *
+	 * \code
+	 * BufferPool *pool = BufferPool::Instance();
+	 * pool->SetMaxBytes(1024 * 1024 * 500);
+	 * std::shared_ptr<QImage> image = pool->GetImage(1920, 1080, QImage::Format_RGBA8888_Premultiplied);
+	 * std::cout << pool->Json() << std::endl; // Pool statistics
+	 * \endcode
+	 */
+	class BufferPool {
+	private:
+		std::mutex poolMutex;
+		std::map<int64_t, std::vector<unsigned char*>> image_buffers; ///< Unused image buffers (by size class)
+		std::map<int64_t, std::vector<juce::AudioBuffer<float>*>> audio_buffers; ///< Unused audio buffers (by size class)
+		int64_t max_bytes; ///< The max bytes of unused buffers to keep
+		int64_t bytes; ///< The bytes of unused buffers in the pool
+		int64_t hits; ///< Requests which reused a buffer
+		int64_t misses; ///< Requests which allocated a new buffer
+		int64_t released; ///< Returned buffers which were freed (since the pool was full)
+
+		/// Default constructor
+		BufferPool(); // Don't allow user to create an instance of this singleton
+
+		/// Default copy method
+		BufferPool(BufferPool const&) = delete; // Don't allow the user to assign this instance
+
+		/// Default assignment operator
+		BufferPool & operator=(BufferPool const&) = delete; // Don't allow the user to assign this instance
+
+		/// Private variable to keep track of singleton instance
+		static BufferPool * m_pInstance;
+
+		/// Round a size up to its size class (with at most 1/8 unused bytes)
+		static int64_t size_class(int64_t size);
+
+		/// QImage cleanup function, which returns the image buffer to the pool
+		static void release_image_buffer(void* info);
+
+		/// Return an image buffer to the pool (or free it)
+		void release_image(unsigned char* block);
+
+		/// Return an audio buffer to the pool (or free it)
+		void release_audio(juce::AudioBuffer<float>* buffer, int64_t class_bytes);
+
+		/// Free unused buffers until the pool is under its max bytes (requires poolMutex)
+		void trim(int64_t limit);
+
+	public:
+		/// Buffers smaller than this are not pooled
+		static const int64_t MIN_POOLED_BYTES = 4096;
+
+		/// Create or get an instance of this pool singleton (invoke the class with this method)
+		static BufferPool * Instance();
+
+		/// @brief Get an image (of any color) with a pooled buffer
+		/// @param width The width of the image
+		/// @param height The height of the image
+		/// @param format The QImage format of the image
+		std::shared_ptr<QImage> GetImage(int width, int height, QImage::Format format);
+
+		/// @brief Get an audio buffer (of any samples) from the pool
+		/// @param channels The number of audio channels
+		/// @param samples The number of samples per channel
+		std::shared_ptr<juce::AudioBuffer<float>> GetAudioBuffer(int channels, int samples);
+
+		/// Free all unused buffers
+		void Clear();
+
+		/// Gets the bytes of unused buffers in the pool
+		int64_t GetBytes();
+
+		/// Gets the max bytes of unused buffers to keep
+		int64_t GetMaxBytes();
+
+		/// @brief Set the max bytes of unused buffers to keep (0 disables the pool)
+		/// @param number_of_bytes The max bytes of unused buffers
+		void SetMaxBytes(int64_t number_of_bytes);
+
+		/// Gets the number of requests which reused a buffer
+		int64_t GetHits();
+
+		/// Gets the number of requests which allocated a new buffer
+		int64_t GetMisses();
+
+		/// Gets the number of returned buffers which were freed (since the pool was full)
+		int64_t GetReleased();
+
+		/// Reset the hits, misses and released counters
+		void ResetStatistics();
+
+		// Get JSON methods
+		std::string Json(); ///< Generate JSON string of the pool statistics
+		Json::Value JsonValue(); ///< Generate Json::Value of the pool statistics
+	};
+
+}
+
+#endif
@@ -0,0 +1,342 @@
+/**
+ * @file
+ * @brief Source file for CacheContent class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include "CacheContent.h"
+#include "Exceptions.h"
+#include "Frame.h"
+
+#include <algorithm>
+
+using namespace std;
+using namespace openshot;
+
+// Constructor which stores content in another cache
+CacheContent::CacheContent(CacheBase* content_cache) : CacheBase(content_cache->GetMaxBytes()), cache(content_cache), next_slot(1), prune_size(64) {
+	// Set cache type name
+	cache_type = "CacheContent";
+	range_version = 0;
+	needs_range_processing = false;
+}
+
+// Default destructor
+CacheContent::~CacheContent()
+{
+	frame_slots.clear();
+	key_slots.clear();
+
+	// remove mutex
+	delete cacheMutex;
+}
+
+// Store a frame in a new slot of the content cache
+int64_t CacheContent::AddContent(std::shared_ptr<Frame> frame)
+{
+	// The content cache identifies frames by number, so store a copy numbered by its slot
+	// (the image data is implicitly shared with the original frame)
+	int64_t slot = next_slot++;
+	auto content = std::make_shared<Frame>(*frame);
+	content->number = slot;
+	cache->Add(content);
+
+	// Adding content can evict other slots (to stay under the max bytes), so forget them
+	// once the entries have doubled (since the last time they were pruned)
+	if (frame_slots.size() + key_slots.size() >= prune_size)
+		PruneSlots();
+
+	return slot;
+}
+
+// Forget the frame numbers and keys whose content was evicted from the content cache
+void CacheContent::PruneSlots()
+{
+	for (auto slot = frame_slots.begin(); slot != frame_slots.end();) {
+		if (cache->Contains(slot->second))
+			++slot;
+		else {
+			slot = frame_slots.erase(slot);
+			needs_range_processing = true;
+		}
+	}
+	for (auto slot = key_slots.begin(); slot != key_slots.end();) {
+		if (cache->Contains(slot->second))
+			++slot;
+		else
+			slot = key_slots.erase(slot);
+	}
+
+	prune_size = std::max<size_t>(64, 2 * (frame_slots.size() + key_slots.size()));
+}
+
+// Get a copy of the content in a slot (numbered as a specific frame)
+std::shared_ptr<Frame> CacheContent::GetContent(int64_t slot, int64_t frame_number)
+{
+	std::shared_ptr<Frame> content = cache->GetFrame(slot);
+	if (!content)
+		// Content was removed by the content cache (i.e. to stay under its max bytes)
+		return std::shared_ptr<Frame>();
+
+	auto frame = std::make_shared<Frame>(*content);
+	frame->number = frame_number;
+	return frame;
+}
+
+// Add a Frame to the cache (without a content key)
+void CacheContent::Add(std::shared_ptr<Frame> frame)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// (adding content can prune the slot entries, so add it before assigning the frame number)
+	int64_t slot = AddContent(frame);
+	frame_slots[frame->number] = slot;
+	needs_range_processing = true;
+}
+
+// Add a Frame to the cache, and store its content by key
+void CacheContent::Add(std::shared_ptr<Frame> frame, uint64_t key)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// Reuse existing content (if any)
+	auto existing_slot = key_slots.find(key);
+	int64_t slot;
+	if (existing_slot == key_slots.end() || !cache->Contains(existing_slot->second)) {
+		// (adding content can prune the slot entries, so add it before assigning the key)
+		slot = AddContent(frame);
+		key_slots[key] = slot;
+	} else
+		slot = existing_slot->second;
+
+	frame_slots[frame->number] = slot;
+	needs_range_processing = true;
+}
+
+// Check if frame is already contained in cache
+bool CacheContent::Contains(int64_t frame_number)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	auto slot = frame_slots.find(frame_number);
+	return slot != frame_slots.end() && cache->Contains(slot->second);
+}
+
+// Check if content is already contained in cache
+bool CacheContent::ContainsKey(uint64_t key)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	auto slot = key_slots.find(key);
+	return slot != key_slots.end() && cache->Contains(slot->second);
+}
+
+// Get a frame from the cache (or NULL shared_ptr if no frame is found)
+std::shared_ptr<Frame> CacheContent::GetFrame(int64_t frame_number)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// Does frame exists in cache?
+	auto slot = frame_slots.find(frame_number);
+	if (slot == frame_slots.end())
+		return std::shared_ptr<Frame>();
+
+	std::shared_ptr<Frame> frame = GetContent(slot->second, frame_number);
+	if (!frame) {
+		// Forget frames whose content is gone
+		frame_slots.erase(slot);
+		needs_range_processing = true;
+	}
+	return frame;
+}
+
+// Get a frame from the cache by its content (or NULL shared_ptr if no content is found)
+std::shared_ptr<Frame> CacheContent::GetFrame(int64_t frame_number, uint64_t key)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// Does content exists in cache?
+	auto slot = key_slots.find(key);
+	if (slot == key_slots.end())
+		return std::shared_ptr<Frame>();
+
+	std::shared_ptr<Frame> frame = GetContent(slot->second, frame_number);
+	if (frame) {
+		// Assign content to this frame number
+		frame_slots[frame_number] = slot->second;
+		needs_range_processing = true;
+	} else {
+		// Forget content which is gone
+		key_slots.erase(slot);
+	}
+	return frame;
+}
+
+// @brief Get an array of all Frames
+std::vector<std::shared_ptr<openshot::Frame>> CacheContent::GetFrames()
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	std::vector<std::shared_ptr<openshot::Frame>> all_frames;
+	for (const auto& slot : frame_slots) {
+		std::shared_ptr<Frame> frame = GetContent(slot.second, slot.first);
+		if (frame)
+			all_frames.push_back(frame);
+	}
+
+	return all_frames;
+}
+
+// Get the smallest frame number (or NULL shared_ptr if no frame is found)
+std::shared_ptr<Frame> CacheContent::GetSmallestFrame()
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// Frame numbers are sorted, so return the first frame which still has content
+	for (const auto& slot : frame_slots) {
+		std::shared_ptr<Frame> frame = GetContent(slot.second, slot.first);
+		if (frame)
+			return frame;
+	}
+	return NULL;
+}
+
+// Gets the maximum bytes value
+int64_t CacheContent::GetBytes()
+{
+	// All bytes are stored in the content cache
+	return cache->GetBytes();
+}
+
+// Set maximum bytes of the content cache
+void CacheContent::SetMaxBytes(int64_t number_of_bytes)
+{
+	max_bytes = number_of_bytes;
+	cache->SetMaxBytes(number_of_bytes);
+}
+
+// Remove a specific frame
+void CacheContent::Remove(int64_t frame_number)
+{
+	Remove(frame_number, frame_number);
+}
+
+// Remove range of frames
+void CacheContent::Remove(int64_t start_frame_number, int64_t end_frame_number)
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// Only remove the frame numbers (the content can still be reused by its key)
+	frame_slots.erase(frame_slots.lower_bound(start_frame_number), frame_slots.upper_bound(end_frame_number));
+
+	// Needs range processing (since cache has changed)
+	needs_range_processing = true;
+}
+
+// Clear the cache of all frames
+void CacheContent::Clear()
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	frame_slots.clear();
+	key_slots.clear();
+	cache->Clear();
+	prune_size = 64;
+	needs_range_processing = true;
+}
+
+// Count the frames in the queue
+int64_t CacheContent::Count()
+{
+	// Create a scoped lock, to protect the cache from multiple threads
+	const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+
+	// Only count frames which still have content
+	int64_t count = 0;
+	for (const auto& slot : frame_slots)
+		if (cache->Contains(slot.second))
+			count++;
+	return count;
+}
+
+// Generate JSON string of this object
+std::string CacheContent::Json() {
+
+	// Return formatted string
+	return JsonValue().toStyledString();
+}
+
+// Generate Json::Value for this object
+Json::Value CacheContent::JsonValue() {
+
+	// Process range data (if anything has changed)
+	if (needs_range_processing) {
+		const std::lock_guard<std::recursive_mutex> lock(*cacheMutex);
+		ordered_frame_numbers.clear();
+		for (const auto& slot : frame_slots)
+			ordered_frame_numbers.push_back(slot.first);
+	}
+	CalculateRanges();
+
+	// Create root json object
+	Json::Value root = CacheBase::JsonValue(); // get parent properties
+	root["type"] = cache_type;
+
+	root["version"] = std::to_string(range_version);
+
+	// Parse and append range data (if any)
+	try {
+		const Json::Value ranges = openshot::stringToJson(json_ranges);
+		root["ranges"] = ranges;
+	} catch (...) { }
+
+	// return JsonValue
+	return root;
+}
+
+// Load JSON string into this object
+void CacheContent::SetJson(const std::string value) {
+
+	try
+	{
+		// Parse string to Json::Value
+		const Json::Value root = openshot::stringToJson(value);
+		// Set all values that match
+		SetJsonValue(root);
+	}
+	catch (const std::exception& e)
+	{
+		// Error parsing JSON (or missing keys)
+		throw InvalidJSON("JSON is invalid (missing keys or invalid data types)");
+	}
+}
+
+// Load Json::Value into this object
+void CacheContent::SetJsonValue(const Json::Value root) {
+
+	// Clear all cached frames
+	Clear();
+
+	// Set parent data
+	CacheBase::SetJsonValue(root);
+	cache->SetMaxBytes(max_bytes);
+
+	if (!root["type"].isNull())
+		cache_type = root["type"].asString();
+}
@@ -0,0 +1,128 @@
+/**
+ * @file
+ * @brief Header file for CacheContent class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef OPENSHOT_CACHE_CONTENT_H
+#define OPENSHOT_CACHE_CONTENT_H
+
+#include <unordered_map>
+
+#include "CacheBase.h"
+
+namespace openshot {
+	class Frame;
+
+	/**
+	 * @brief This class is a content-addressed cache manager for Frame objects.
+	 *
+	 * Frames are stored by a key (i.e. a hash of everything which determines how a frame looks and sounds), and
+	 * frame numbers only point to the stored content. Removing a frame number (i.e. when a clip is edited) keeps its
+	 * content, so moving a clip, undo / redo, or repeated content can reuse frames which were already rendered.
+	 *
+	 * The content itself is stored in another cache (such as CacheMemory or CacheDisk), which limits
+	 * the total size (its max bytes are also the max bytes of this cache). That cache should not be shared
+	 * with any other object.
+	 *
+	 * \code
+	 * CacheMemory content(1024 * 1024 * 500);
+	 * CacheContent cache(&content);
+	 * timeline.SetCache(&cache);
+	 * \endcode
+	 */
+	class CacheContent : public CacheBase {
+	private:
+		CacheBase* cache; ///< The cache which stores the content of the frames
+		std::map<int64_t, int64_t> frame_slots; ///< Frame numbers and the slot (in the content cache) of their content
+		std::unordered_map<uint64_t, int64_t> key_slots; ///< Content keys and the slot (in the content cache) of their content
+		int64_t next_slot; ///< The next unused slot in the content cache
+		size_t prune_size; ///< The number of slot entries which triggers pruning the entries of evicted content
+
+		/// Store a frame in a new slot of the content cache
+		int64_t AddContent(std::shared_ptr<openshot::Frame> frame);
+
+		/// Forget the frame numbers and keys whose content was evicted from the content cache
+		void PruneSlots();
+
+		/// Get a copy of the content in a slot (numbered as a specific frame), or NULL shared_ptr if it was removed
+		std::shared_ptr<openshot::Frame> GetContent(int64_t slot, int64_t frame_number);
+
+	public:
+		/// @brief Constructor which stores content in another cache
+		/// @param content_cache The cache which stores the content (i.e. CacheMemory or CacheDisk)
+		CacheContent(CacheBase* content_cache);
+
+		// Default destructor
+		virtual ~CacheContent();
+
+		/// @brief Add a Frame to the cache (without a content key, so it can't be reused by other frame numbers)
+		/// @param frame The openshot::Frame object needing to be cached.
+		void Add(std::shared_ptr<openshot::Frame> frame);
+
+		/// @brief Add a Frame to the cache, and store its content by key
+		/// @param frame The openshot::Frame object needing to be cached.
+		/// @param key The content key (hash) of the frame
+		void Add(std::shared_ptr<openshot::Frame> frame, uint64_t key);
+
+		/// Clear the cache of all frames (and all stored content)
+		void Clear();
+
+		/// @brief Check if frame is already contained in cache
+		/// @param frame_number The frame number to be checked
+		bool Contains(int64_t frame_number);
+
+		/// @brief Check if content is already contained in cache
+		/// @param key The content key (hash) to be checked
+		bool ContainsKey(uint64_t key);
+
+		/// Count the frames in the queue
+		int64_t Count();
+
+		/// @brief Get a frame from the cache
+		/// @param frame_number The frame number of the cached frame
+		std::shared_ptr<openshot::Frame> GetFrame(int64_t frame_number);
+
+		/// @brief Get a frame from the cache by its content, and assign it to a frame number
+		/// @param frame_number The frame number of the requested frame
+		/// @param key The content key (hash) of the requested frame
+		std::shared_ptr<openshot::Frame> GetFrame(int64_t frame_number, uint64_t key);
+
+		/// @brief Get an array of all Frames
+		std::vector<std::shared_ptr<openshot::Frame>> GetFrames();
+
+		/// Gets the maximum bytes value
+		int64_t GetBytes();
+
+		/// @brief Set maximum bytes of the content cache
+		/// @param number_of_bytes The maximum bytes to allow in the content cache. Once exceeded, it will purge the oldest content.
+		void SetMaxBytes(int64_t number_of_bytes);
+
+		/// Get the smallest frame number
+		std::shared_ptr<openshot::Frame> GetSmallestFrame();
+
+		/// @brief Remove a specific frame (its content is kept for reuse)
+		/// @param frame_number The frame number of the cached frame
+		void Remove(int64_t frame_number);
+
+		/// @brief Remove a range of frames (their content is kept for reuse)
+		/// @param start_frame_number The starting frame number of the cached frame
+		/// @param end_frame_number The ending frame number of the cached frame
+		void Remove(int64_t start_frame_number, int64_t end_frame_number);
+
+		// Get and Set JSON methods
+		std::string Json(); ///< Generate JSON string of this object
+		void SetJson(const std::string value); ///< Load JSON string into this object
+		Json::Value JsonValue(); ///< Generate Json::Value for this object
+		void SetJsonValue(const Json::Value root); ///< Load Json::Value into this object
+	};
+
+}
+
+#endif
@@ -16,7 +16,10 @@
 #include "Exceptions.h"
 #include "FFmpegReader.h"
 #include "FrameMapper.h"
+#include "OpenMPUtilities.h"
+#include "Profiler.h"
 #include "QtImageReader.h"
+#include "Settings.h"
 #include "ChunkReader.h"
 #include "DummyReader.h"
 #include "Timeline.h"
@@ -129,14 +132,18 @@ void Clip::init_reader_rotation() {
 }
 
 // Default Constructor for a clip
-Clip::Clip() : resampler(NULL), reader(NULL), allocated_reader(NULL), is_open(false)
+Clip::Clip() : resampler(NULL), reader(NULL), allocated_reader(NULL),
+	proxy_reader(NULL), allocated_proxy_reader(NULL), proxy_mapper(NULL), preroll_reader(NULL),
+	preroll_mapper(NULL), is_open(false)
 {
 	// Init all default settings
 	init_settings();
 }
 
 // Constructor with reader
-Clip::Clip(ReaderBase* new_reader) : resampler(NULL), reader(new_reader), allocated_reader(NULL), is_open(false)
+Clip::Clip(ReaderBase* new_reader) : resampler(NULL), reader(new_reader), allocated_reader(NULL),
+	proxy_reader(NULL), allocated_proxy_reader(NULL), proxy_mapper(NULL), preroll_reader(NULL),
+	preroll_mapper(NULL), is_open(false)
 {
 	// Init all default settings
 	init_settings();
@@ -155,7 +162,9 @@ Clip::Clip(ReaderBase* new_reader) : resampler(NULL), reader(new_reader), alloca
 }
 
 // Constructor with filepath
-Clip::Clip(std::string path) : resampler(NULL), reader(NULL), allocated_reader(NULL), is_open(false)
+Clip::Clip(std::string path) : resampler(NULL), reader(NULL), allocated_reader(NULL),
+	proxy_reader(NULL), allocated_proxy_reader(NULL), proxy_mapper(NULL), preroll_reader(NULL),
+	preroll_mapper(NULL), is_open(false)
 {
 	// Init all default settings
 	init_settings();
@@ -224,6 +233,12 @@ Clip::~Clip()
 		reader = NULL;
 	}
 
+	// Delete the proxy reader (and its mapper) if clip created them
+	Proxy((ReaderBase*) NULL);
+
+	// Delete the pre-roll reader (if any)
+	clear_preroll_reader();
+
 	// Close the resampler
 	if (resampler) {
 		delete resampler;
@@ -291,6 +306,8 @@ void Clip::Reader(ReaderBase* new_reader)
 
 	// set reader pointer
 	reader = new_reader;
+	clear_effect_lanes();
+	clear_preroll_reader();
 
 	// set parent
 	if (reader) {
@@ -311,13 +328,135 @@ ReaderBase* Clip::Reader()
 		throw ReaderClosed("No Reader has been initialized for this Clip.  Call Reader(*reader) before calling this method.");
 }
 
+// Set a low resolution proxy of the reader
+void Clip::Proxy(ReaderBase* new_proxy)
+{
+	if (new_proxy == proxy_reader)
+		return;
+
+	// Close and delete the previous proxy (and its mapper)
+	clear_proxy_mapper();
+	if (allocated_proxy_reader) {
+		allocated_proxy_reader->Close();
+		delete allocated_proxy_reader;
+		allocated_proxy_reader = NULL;
+	} else if (proxy_reader && is_open) {
+		proxy_reader->Close();
+	}
+	proxy_path = "";
+
+	// Set proxy pointer (the proxy is not scaled by the reader, since it's only slightly larger than the preview)
+	proxy_reader = new_proxy;
+	if (proxy_reader && is_open)
+		proxy_reader->Open();
+}
+
+// Set a low resolution proxy file of the reader
+void Clip::Proxy(std::string path)
+{
+	if (path.empty()) {
+		Proxy((ReaderBase*) NULL);
+		return;
+	}
+
+	// Create new proxy reader
+	ReaderBase* new_proxy = new FFmpegReader(path);
+	Proxy(new_proxy);
+	allocated_proxy_reader = new_proxy;
+	proxy_path = path;
+}
+
+// Is the proxy read instead of the reader (at the timeline's current preview size)
+bool Clip::UsingProxy() const
+{
+	// Originals are read outside of a timeline (i.e. no preview)
+	if (!reader || !proxy_reader || !timeline || !Settings::Instance()->USE_PROXY_MEDIA)
+		return false;
+
+	// The largest size this clip's image is displayed at (on the preview window)
+	Timeline* parent_timeline = (Timeline*) timeline;
+	float max_scale = std::max(1.0, std::max(scale_x.GetMaxPoint().co.Y, scale_y.GetMaxPoint().co.Y));
+	QSizeF required_size(reader->info.width, reader->info.height);
+	if (scale == SCALE_NONE) {
+		// Original size (relative to the preview window size)
+		float preview_ratio = parent_timeline->preview_width / float(parent_timeline->info.width);
+		required_size *= preview_ratio * max_scale;
+	} else {
+		required_size.scale(parent_timeline->preview_width * max_scale, parent_timeline->preview_height * max_scale,
+							scale == SCALE_FIT ? Qt::KeepAspectRatio : Qt::KeepAspectRatioByExpanding);
+	}
+
+	// The proxy must be large enough (with 1 pixel for rounding)
+	return proxy_reader->info.width + 1 >= required_size.width() && proxy_reader->info.height + 1 >= required_size.height();
+}
+
+// Get the proxy reader, mapped to the frame rate and audio of the reader
+ReaderBase* Clip::get_proxy_reader()
+{
+	// Proxies usually match the reader (unless the reader is mapped to the timeline's frame rate and audio)
+	const ReaderInfo& target = reader->info;
+	const ReaderInfo& source = proxy_reader->info;
+	if (source.fps.num == target.fps.num && source.fps.den == target.fps.den &&
+		source.sample_rate == target.sample_rate && source.channels == target.channels)
+		return proxy_reader;
+
+	if (!proxy_mapper) {
+		// Map the proxy just like the reader (so each frame, and its audio samples, match the reader)
+		proxy_mapper = new FrameMapper(proxy_reader, target.fps, PULLDOWN_NONE, target.sample_rate, target.channels, target.channel_layout);
+		proxy_mapper->ParentClip(this);
+		proxy_mapper->Open();
+	} else if (proxy_mapper->info.fps.num != target.fps.num || proxy_mapper->info.fps.den != target.fps.den ||
+			   proxy_mapper->info.sample_rate != target.sample_rate || proxy_mapper->info.channels != target.channels) {
+		proxy_mapper->ChangeMapping(target.fps, PULLDOWN_NONE, target.sample_rate, target.channels, target.channel_layout);
+	}
+	return proxy_mapper;
+}
+
+// Close and remove the proxy mapper (if any)
+void Clip::clear_proxy_mapper()
+{
+	if (proxy_mapper) {
+		proxy_mapper->Close();
+		delete proxy_mapper;
+		proxy_mapper = NULL;
+	}
+}
+
+// Determine if a reader's JSON matches the reader already loaded by this clip
+bool Clip::IsSameReader(const Json::Value& reader_json)
+{
+	if (!reader || !reader_json.isObject() || reader_json["type"].isNull())
+		return false;
+
+	try {
+		// Compare against the original reader (and not a FrameMapper wrapping it). FrameMappers are
+		// only kept when the parent timeline is responsible for mapping its clips.
+		ReaderBase* source_reader = reader;
+		if (source_reader->Name() == "FrameMapper") {
+			Timeline* parentTimeline = (Timeline *) ParentTimeline();
+			if (!parentTimeline || !parentTimeline->AutoMapClips())
+				return false;
+			source_reader = ((FrameMapper*) source_reader)->Reader();
+		}
+
+		return source_reader->Name() == reader_json["type"].asString() &&
+			openshot::jsonIsUnchanged(source_reader->JsonValue(), reader_json);
+
+	} catch (const ReaderClosed & e) {
+		// No nested reader
+		return false;
+	}
+}
+
 // Open the internal reader
 void Clip::Open()
 {
 	if (reader)
 	{
-		// Open the reader
+		// Open the reader (and proxy)
 		reader->Open();
+		if (proxy_reader)
+			proxy_reader->Open();
 		is_open = true;
 
 		// Copy Reader info to Clip
@@ -336,11 +475,16 @@ void Clip::Open()
 void Clip::Close()
 {
 	is_open = false;
+	clear_effect_lanes();
 	if (reader) {
 		ZmqLogger::Instance()->AppendDebugMethod("Clip::Close");
 
-		// Close the reader
+		// Close the reader (and proxy)
 		reader->Close();
+		if (proxy_reader)
+			proxy_reader->Close();
+		clear_proxy_mapper();
+		clear_preroll_reader();
 	}
 	else
 		// Throw error if reader not initialized
@@ -425,26 +569,20 @@ std::shared_ptr<Frame> Clip::GetFrame(std::shared_ptr<openshot::Frame> backgroun
 
 	if (reader)
 	{
+		// Time this clip (including its effects and compositing)
+		ProfileScope profile("clip", this);
+
 		// Adjust out of bounds frame number
 		frame_number = adjust_frame_number_minimum(frame_number);
 
-		// Is a time map detected
-		int64_t new_frame_number = frame_number;
-		int64_t time_mapped_number = adjust_frame_number_minimum(time.GetLong(frame_number));
-		if (time.GetLength() > 1)
-			new_frame_number = time_mapped_number;
+		// Get the (time mapped) frame from the reader
+		std::shared_ptr<Frame> original_frame = get_source_frame(frame_number);
 
-		// Now that we have re-mapped what frame number is needed, go and get the frame pointer
-		std::shared_ptr<Frame> original_frame = GetOrCreateFrame(new_frame_number);
-
-		// Get time mapped frame number (used to increase speed, change direction, etc...)
-		// TODO: Handle variable # of samples, since this resamples audio for different speeds (only when time curve is set)
-		get_time_mapped_frame(original_frame, new_frame_number);
-		// Return the frame's number so the correct keyframes are applied.
-		original_frame->number = frame_number;
+		// Is only audio needed (skip video effects and image processing)
+		bool audio_only = options != NULL && options->is_audio_only;
 
 		// Apply local effects to the frame (if any)
-		apply_effects(original_frame);
+		apply_effects(original_frame, audio_only);
 
         // Apply global timeline effects (i.e. transitions & masks... if any)
         if (timeline != NULL && options != NULL) {
@@ -456,7 +594,8 @@ std::shared_ptr<Frame> Clip::GetFrame(std::shared_ptr<openshot::Frame> backgroun
         }
 
 		// Apply keyframe / transforms
-		apply_keyframes(original_frame, background_frame->GetImage());
+		if (!audio_only)
+			apply_keyframes(original_frame, background_frame->GetImage());
 
 		// Return processed 'frame'
 		return original_frame;
@@ -466,6 +605,27 @@ std::shared_ptr<Frame> Clip::GetFrame(std::shared_ptr<openshot::Frame> backgroun
 		throw ReaderClosed("No Reader has been initialized for this Clip.  Call Reader(*reader) before calling this method.");
 }
 
+// Get the time mapped frame of the reader (before any effects or keyframes are applied)
+std::shared_ptr<Frame> Clip::get_source_frame(int64_t frame_number)
+{
+	// Is a time map detected
+	int64_t new_frame_number = frame_number;
+	int64_t time_mapped_number = adjust_frame_number_minimum(time.GetLong(frame_number));
+	if (time.GetLength() > 1)
+		new_frame_number = time_mapped_number;
+
+	// Now that we have re-mapped what frame number is needed, go and get the frame pointer
+	std::shared_ptr<Frame> original_frame = GetOrCreateFrame(new_frame_number);
+
+	// Get time mapped frame number (used to increase speed, change direction, etc...)
+	// TODO: Handle variable # of samples, since this resamples audio for different speeds (only when time curve is set)
+	get_time_mapped_frame(original_frame, new_frame_number);
+	// Return the frame's number so the correct keyframes are applied.
+	original_frame->number = frame_number;
+
+	return original_frame;
+}
+
 // Look up an effect by ID
 openshot::EffectBase* Clip::GetEffect(const std::string& id)
 {
@@ -735,7 +895,8 @@ std::shared_ptr<Frame> Clip::GetOrCreateFrame(int64_t number)
 			"number", number);
 
 		// Attempt to get a frame (but this could fail if a reader has just been closed)
-		auto reader_frame = reader->GetFrame(number);
+		// While previewing, the frame is read from the proxy (if any), which has the same frames as the reader
+		auto reader_frame = UsingProxy() ? get_proxy_reader()->GetFrame(number) : reader->GetFrame(number);
 
 		// Return real frame
 		if (reader_frame) {
@@ -987,6 +1148,7 @@ Json::Value Clip::JsonValue() const {
 		root["reader"] = reader->JsonValue();
 	else
 		root["reader"] = Json::Value(Json::objectValue);
+	root["proxy"] = proxy_path;
 
 	// return JsonValue
 	return root;
@@ -1089,8 +1251,12 @@ void Clip::SetJsonValue(const Json::Value root) {
 		perspective_c4_y.SetJsonValue(root["perspective_c4_y"]);
 	if (!root["effects"].isNull()) {
 
+		// Keep the existing effects (by ID), so they can be updated in place
+		std::list<EffectBase*> previous_effects = effects;
+
 		// Clear existing effects
 		effects.clear();
+		clear_effect_lanes();
 
 		// loop through effects
 		for (const auto existing_effect : root["effects"]) {
@@ -1098,8 +1264,27 @@ void Clip::SetJsonValue(const Json::Value root) {
 			EffectBase *e = NULL;
 			if (!existing_effect["type"].isNull()) {
 
+				// Look for an existing effect of the same type and ID
+				for (auto previous_effect : previous_effects) {
+					if (!previous_effect->Id().empty() &&
+						previous_effect->Id() == existing_effect["id"].asString() &&
+						previous_effect->info.class_name == existing_effect["type"].asString()) {
+						e = previous_effect;
+						previous_effects.remove(previous_effect);
+						break;
+					}
+				}
+
+				if (e) {
+					// Update existing effect (if needed)
+					if (!openshot::jsonIsUnchanged(e->JsonValue(), existing_effect))
+						e->SetJsonValue(existing_effect);
+
+					// Add Effect back to Clip
+					AddEffect(e);
+
 				// Create instance of effect
-				if ( (e = EffectInfo().CreateEffect(existing_effect["type"].asString()))) {
+				} else if ( (e = EffectInfo().CreateEffect(existing_effect["type"].asString()))) {
 
 					// Load Json into Effect
 					e->SetJsonValue(existing_effect);
@@ -1112,7 +1297,8 @@ void Clip::SetJsonValue(const Json::Value root) {
 	}
 	if (!root["reader"].isNull()) // does Json contain a reader?
 	{
-		if (!root["reader"]["type"].isNull()) // does the reader Json contain a 'type'?
+		// Keep the current reader (and its cache) if the JSON describes the same reader
+		if (!root["reader"]["type"].isNull() && !IsSameReader(root["reader"])) // does the reader Json contain a 'type' (and a different reader)?
 		{
 			// Close previous reader (if any)
 			bool already_open = false;
@@ -1185,6 +1371,16 @@ void Clip::SetJsonValue(const Json::Value root) {
 
 		}
 	}
+	if (!root["proxy"].isNull() && root["proxy"].asString() != proxy_path)
+	{
+		try {
+			// Load the proxy file (or remove the proxy)
+			Proxy(root["proxy"].asString());
+		} catch (const std::exception& e) {
+			// Missing proxy files are ignored (the reader is used instead)
+			Proxy((ReaderBase*) NULL);
+		}
+	}
 }
 
 // Sort effects by order
@@ -1202,6 +1398,7 @@ void Clip::AddEffect(EffectBase* effect)
 
 	// Add effect to list
 	effects.push_back(effect);
+	clear_effect_lanes();
 
 	// Sort effects
 	sort_effects();
@@ -1242,18 +1439,199 @@ void Clip::AddEffect(EffectBase* effect)
 void Clip::RemoveEffect(EffectBase* effect)
 {
 	effects.remove(effect);
+	clear_effect_lanes();
 }
 
 // Apply effects to the source frame (if any)
-void Clip::apply_effects(std::shared_ptr<Frame> frame)
+void Clip::apply_effects(std::shared_ptr<Frame> frame, bool audio_only)
 {
+	const int64_t frame_number = frame->number;
+
+	// Add up the look-back of the audio effects (if any effect depends on previous frames), since
+	// each effect only outputs the correct audio once the effects before it have settled
+	int64_t look_back = 0;
+	for (auto effect : effects)
+		if (effect->info.has_audio)
+			look_back += effect->LookBackSamples(frame->SampleRate());
+
+	// Continue the effect states of the previous frame (or pre-roll new states)
+	EffectLane lane;
+	if (look_back > 0)
+		lane = get_effect_lane(frame, look_back, audio_only);
+
 	// Find Effects at this position and layer
 	for (auto effect : effects)
 	{
+		// Skip effects which only modify video (when only rendering audio)
+		if (audio_only && effect->info.has_video && !effect->info.has_audio)
+			continue;
+
 		// Apply the effect to this frame
-		frame = effect->GetFrame(frame, frame->number);
+		ProfileScope profile("effect", effect);
+		if (look_back > 0 && effect->info.has_audio)
+			frame = effect->GetFrame(frame, frame_number, lane.states[effect].get());
+		else
+			frame = effect->GetFrame(frame, frame_number);
 
 	} // end effect loop
+
+	// Keep the effect states for the next frame
+	if (look_back > 0) {
+		lane.next_frame = frame_number + 1;
+		put_effect_lane(std::move(lane));
+	}
+}
+
+// Get the effect lane which continues from the previous frame (or create a new lane)
+Clip::EffectLane Clip::get_effect_lane(std::shared_ptr<Frame> frame, int64_t look_back, bool audio_only)
+{
+	{
+		const std::lock_guard<std::mutex> lock(effect_lanes_mutex);
+
+		// Find an idle lane which ended on the previous frame
+		for (auto lane = effect_lanes.begin(); lane != effect_lanes.end(); ++lane) {
+			if (lane->next_frame == frame->number) {
+				EffectLane continued_lane = std::move(*lane);
+				effect_lanes.erase(lane);
+				return continued_lane;
+			}
+		}
+	}
+
+	// Create new (empty) effect states
+	EffectLane lane;
+	for (auto effect : effects)
+		if (effect->info.has_audio)
+			lane.states[effect] = effect->CreateState();
+
+	// Find the first frame of the pre-roll (which can't start before the clip does)
+	int64_t start_frame = adjust_frame_number_minimum((int64_t)(Start() * reader->info.fps.ToDouble()) + 1);
+	int64_t preroll_frame = frame->number;
+	int64_t preroll_samples = 0;
+	while (preroll_frame > start_frame && preroll_samples < look_back) {
+		preroll_frame--;
+		preroll_samples += Frame::GetSamplesPerFrame(preroll_frame, reader->info.fps, frame->SampleRate(), frame->GetAudioChannelsCount());
+	}
+
+	ZmqLogger::Instance()->AppendDebugMethod(
+		"Clip::get_effect_lane (pre-roll)",
+		"frame->number", frame->number,
+		"look_back", look_back,
+		"preroll_frame", preroll_frame,
+		"preroll_samples", preroll_samples);
+
+	// Pass the audio of the previous frames through the audio effects (to fill their states)
+	for (; preroll_frame < frame->number; preroll_frame++) {
+		std::shared_ptr<Frame> preroll = get_preroll_frame(preroll_frame, audio_only);
+		for (auto effect : effects)
+			if (effect->info.has_audio)
+				preroll = effect->GetFrame(preroll, preroll_frame, lane.states[effect].get());
+	}
+
+	return lane;
+}
+
+// Get the audio of a source frame to pre-roll the audio effects (without decoding its image, if possible)
+std::shared_ptr<Frame> Clip::get_preroll_frame(int64_t frame_number, bool audio_only)
+{
+	// Audio-only renders already skip video decoding, and time mapped frames need the reader's frames
+	ReaderBase* audio_reader = NULL;
+	if (!audio_only && time.GetLength() <= 1)
+		audio_reader = get_preroll_reader();
+	if (!audio_reader)
+		return get_source_frame(frame_number);
+
+	try {
+		// Copy the audio of the frame (just like GetOrCreateFrame)
+		std::shared_ptr<Frame> reader_frame = audio_reader->GetFrame(frame_number);
+		if (reader_frame) {
+			auto reader_copy = std::make_shared<Frame>(*reader_frame.get());
+			if (has_audio.GetInt(frame_number) == 0 || frame_number > reader->info.video_length)
+				reader_copy->AddAudioSilence(reader_copy->GetAudioSamplesCount());
+			return reader_copy;
+		}
+	} catch (const ReaderClosed & e) {
+		// ...
+	} catch (const OutOfBoundsFrame & e) {
+		// ...
+	}
+
+	// Fall back to the source frame
+	return get_source_frame(frame_number);
+}
+
+// Get a reader which only decodes the audio of the reader (or NULL if the reader has no video to skip)
+ReaderBase* Clip::get_preroll_reader()
+{
+	const std::lock_guard<std::mutex> lock(effect_lanes_mutex);
+	if (preroll_mapper)
+		return preroll_mapper;
+	if (preroll_reader)
+		return preroll_reader;
+
+	// Only media files with video need another reader (other readers have no video to decode)
+	ReaderBase* source_reader = reader;
+	if (source_reader->Name() == "FrameMapper")
+		source_reader = ((FrameMapper *) source_reader)->Reader();
+	if (source_reader->Name() != "FFmpegReader" || !source_reader->info.has_video || !source_reader->info.has_audio)
+		return NULL;
+
+	try {
+		// Open the same file again, and discard its video packets (see Timeline::AudioOnly)
+		preroll_reader = new FFmpegReader(source_reader->JsonValue()["path"].asString());
+		preroll_reader->ParentClip(this);
+		preroll_reader->Open();
+		preroll_reader->info.has_video = false;
+	} catch (const std::exception& e) {
+		// Pre-roll with the reader instead
+		delete preroll_reader;
+		preroll_reader = NULL;
+		return NULL;
+	}
+
+	if (reader->Name() == "FrameMapper") {
+		// Map the audio just like the reader (so each frame, and its audio samples, match the reader)
+		const ReaderInfo& target = reader->info;
+		preroll_mapper = new FrameMapper(preroll_reader, target.fps, PULLDOWN_NONE, target.sample_rate, target.channels, target.channel_layout);
+		preroll_mapper->ParentClip(this);
+		preroll_mapper->Open();
+		return preroll_mapper;
+	}
+	return preroll_reader;
+}
+
+// Close and remove the pre-roll reader (and its mapper)
+void Clip::clear_preroll_reader()
+{
+	const std::lock_guard<std::mutex> lock(effect_lanes_mutex);
+	if (preroll_mapper) {
+		preroll_mapper->Close();
+		delete preroll_mapper;
+		preroll_mapper = NULL;
+	}
+	if (preroll_reader) {
+		preroll_reader->Close();
+		delete preroll_reader;
+		preroll_reader = NULL;
+	}
+}
+
+// Store an effect lane, to continue with its next frame
+void Clip::put_effect_lane(EffectLane lane)
+{
+	const std::lock_guard<std::mutex> lock(effect_lanes_mutex);
+	effect_lanes.push_front(std::move(lane));
+
+	// Keep (no more than) one idle lane per render thread
+	while (effect_lanes.size() > (size_t) OPEN_MP_NUM_PROCESSORS)
+		effect_lanes.pop_back();
+}
+
+// Clear all effect lanes
+void Clip::clear_effect_lanes()
+{
+	const std::lock_guard<std::mutex> lock(effect_lanes_mutex);
+	effect_lanes.clear();
 }
 
 // Compare 2 floating point numbers for equality
@@ -1270,6 +1648,9 @@ void Clip::apply_keyframes(std::shared_ptr<Frame> frame, std::shared_ptr<QImage>
         return;
     }
 
+    // Time the compositing of this clip
+    ProfileScope profile("composite", this);
+
     // Get image from clip
     std::shared_ptr<QImage> source_image = frame->GetImage();
 
@@ -1429,7 +1810,13 @@ QTransform Clip::get_transform(std::shared_ptr<Frame> frame, int width, int heig
 		case (SCALE_NONE): {
 			// Image is already the original size (i.e. no scaling mode) relative
 			// to the preview window size (i.e. timeline / preview ratio). No further
-			// scaling is needed here.
+			// scaling is needed here (except for proxy images, which are smaller than the original).
+			if (UsingProxy()) {
+				Timeline* parent_timeline = (Timeline*) timeline;
+				float preview_ratio = parent_timeline->preview_width / float(parent_timeline->info.width);
+				source_size = QSize(round(reader->info.width * preview_ratio), round(reader->info.height * preview_ratio));
+			}
+
 			// Debug output
 			ZmqLogger::Instance()->AppendDebugMethod(
 				"Clip::get_transform (Scale: SCALE_NONE)",
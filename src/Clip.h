@@ -23,7 +23,10 @@
 
 #endif
 
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "ClipBase.h"
@@ -42,6 +45,7 @@ namespace openshot {
 	class AudioResampler;
 	class EffectInfo;
 	class Frame;
+	class FrameMapper;
 
 	/// Comparison method for sorting effect pointers (by Position, Layer, and Order). Effects are sorted
 	/// from lowest layer to top layer (since that is sequence clips are combined), and then by
@@ -109,6 +113,13 @@ namespace openshot {
 		std::shared_ptr<openshot::TrackedObjectBase> parentTrackedObject; ///< Tracked object this clip is attached to
 		openshot::Clip* parentClipObject; ///< Clip object this clip is attached to
 
+		/// The effect states of a sequence of frames (so frames can be requested out of order, or in parallel)
+		struct EffectLane {
+			int64_t next_frame = 0; ///< The frame number which continues this sequence
+			std::map<openshot::EffectBase*, std::shared_ptr<openshot::EffectState>> states; ///< The state of each effect
+		};
+		std::list<EffectLane> effect_lanes; ///< The idle effect lanes (most recently used first)
+		std::mutex effect_lanes_mutex; ///< Mutex for the effect lanes
 
 		// Audio resampler (if time mapping)
 		openshot::AudioResampler *resampler;
@@ -120,11 +131,54 @@ namespace openshot {
 		/// (reader member variable itself may have been replaced)
 		openshot::ReaderBase* allocated_reader;
 
+		/// Low resolution proxy of the reader (if any), which is read instead of the reader while previewing
+		openshot::ReaderBase* proxy_reader;
+
+		/// If we allocated a proxy reader (from a proxy path), we store it here to free it later
+		openshot::ReaderBase* allocated_proxy_reader;
+
+		/// Maps the proxy to the frame rate and audio of the reader (if they are different)
+		openshot::FrameMapper* proxy_mapper;
+
+		/// The path of the proxy file (if the proxy was set by path)
+		std::string proxy_path;
+
+		/// Decodes only the audio of the reader's media file (if any), to pre-roll the audio effects
+		openshot::ReaderBase* preroll_reader;
+
+		/// Maps the pre-roll reader to the frame rate and audio of the reader (if the reader is mapped)
+		openshot::FrameMapper* preroll_mapper;
+
 		/// Adjust frame number minimum value
 		int64_t adjust_frame_number_minimum(int64_t frame_number);
 
-		/// Apply effects to the source frame (if any)
-		void apply_effects(std::shared_ptr<openshot::Frame> frame);
+		/// Get the proxy reader, mapped to the frame rate and audio of the reader (so each frame matches the reader)
+		openshot::ReaderBase* get_proxy_reader();
+
+		/// Close and remove the proxy mapper (if any)
+		void clear_proxy_mapper();
+
+		/// Get a reader which only decodes the audio of the reader (or NULL if the reader has no video to skip)
+		openshot::ReaderBase* get_preroll_reader();
+
+		/// Close and remove the pre-roll reader (and its mapper)
+		void clear_preroll_reader();
+
+		/// Get the audio of a source frame to pre-roll the audio effects (without decoding its image, if possible)
+		std::shared_ptr<openshot::Frame> get_preroll_frame(int64_t frame_number, bool audio_only);
+
+		/// Apply effects to the source frame (if any), skipping video-only effects if only audio is needed
+		void apply_effects(std::shared_ptr<openshot::Frame> frame, bool audio_only=false);
+
+		/// @brief Get the effect lane which continues from the previous frame, or create a new lane
+		/// and pre-roll the frames before this frame through the audio effects (i.e. after a seek)
+		EffectLane get_effect_lane(std::shared_ptr<openshot::Frame> frame, int64_t look_back, bool audio_only);
+
+		/// Store an effect lane, to continue with its next frame
+		void put_effect_lane(EffectLane lane);
+
+		/// Clear all effect lanes (i.e. when effects are added or removed)
+		void clear_effect_lanes();
 
         /// Apply keyframes to an openshot::Frame and use an existing QImage as a background image (if any)
         void apply_keyframes(std::shared_ptr<Frame> frame, std::shared_ptr<QImage> background_canvas);
@@ -141,6 +195,9 @@ namespace openshot {
 		/// Adjust the audio and image of a time mapped frame
 		void get_time_mapped_frame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number);
 
+		/// Get the time mapped frame of the reader (before any effects or keyframes are applied)
+		std::shared_ptr<openshot::Frame> get_source_frame(int64_t frame_number);
+
 		/// Compare 2 floating point numbers
 		bool isEqual(double a, double b);
 
@@ -260,6 +317,28 @@ namespace openshot {
 		/// Get the current reader
 		openshot::ReaderBase* Reader();
 
+		/// @brief Set a low resolution proxy of the reader (i.e. generated by openshot::ProxyGenerator), with the
+		/// same frames and audio as the reader. The proxy is read instead of the reader while the timeline's
+		/// preview size fits in the proxy (and Settings::USE_PROXY_MEDIA is enabled), and the reader is read
+		/// for larger previews and final export.
+		/// @param new_proxy The proxy reader (or NULL to remove the proxy)
+		void Proxy(openshot::ReaderBase* new_proxy);
+
+		/// @brief Set a low resolution proxy file of the reader (see Proxy(openshot::ReaderBase*))
+		/// @param path The path of the proxy file (or an empty string to remove the proxy)
+		void Proxy(std::string path);
+
+		/// Get the proxy reader (or NULL)
+		openshot::ReaderBase* Proxy() { return proxy_reader; };
+
+		/// Is the proxy read instead of the reader (at the timeline's current preview size)
+		bool UsingProxy() const;
+
+		/// @brief Determine if a reader's JSON matches the reader already loaded by this clip. Matching readers
+		/// are kept (along with their open file handles and caches) when SetJsonValue() is called.
+		/// @param reader_json The "reader" JSON object of a clip
+		bool IsSameReader(const Json::Value& reader_json);
+
 		// Override End() position (in seconds) of clip (trim end of video)
 		float End() const override; ///< Get end position (in seconds) of clip (trim end of video), which can be affected by the time curve.
 		void End(float value) override; ///< Set end position (in seconds) of clip (trim end of video)
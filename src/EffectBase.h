@@ -42,6 +42,18 @@ namespace openshot
 		bool has_tracked_object; ///< Determines if this effect track objects through the clip
 	};
 
+	/**
+	 * @brief This struct is the base class of an effect's state, which depends on previous frames (such as an echo).
+	 *
+	 * Effects which carry audio from one frame into the next derive from this struct, and return a new (empty)
+	 * instance from EffectBase::CreateState(). Each sequence of frames (i.e. each render lane) uses its own
+	 * instance, so frames can be rendered out of order (or in parallel) without sharing any state.
+	 */
+	struct EffectState
+	{
+		virtual ~EffectState() = default;
+	};
+
 	/**
 	 * @brief This abstract class is the base class, used by all effects in libopenshot.
 	 *
@@ -108,6 +120,26 @@ namespace openshot
 
 		Json::Value JsonInfo() const; ///< Generate JSON object of meta data / info
 
+		/// @brief Get the number of previous samples this effect needs to process, before a frame can be
+		/// rendered correctly (i.e. after a seek). Effects without an EffectState return 0.
+		/// @param sample_rate The sample rate of the audio
+		virtual int64_t LookBackSamples(int sample_rate) const { return 0; }
+
+		/// Create a new (empty) state for this effect, or NULL if this effect has no state
+		virtual std::shared_ptr<openshot::EffectState> CreateState() { return nullptr; }
+
+		using ClipBase::GetFrame;
+
+		/// @brief Apply this effect to a frame, using a specific state (instead of the effect's own state)
+		///
+		/// @returns The modified openshot::Frame object
+		/// @param frame The frame object that needs the effect applied to it
+		/// @param frame_number The frame number (starting at 1) of the effect on the timeline.
+		/// @param state The state (created by CreateState()) of the frames before this one
+		virtual std::shared_ptr<openshot::Frame> GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* state) {
+			return GetFrame(frame, frame_number);
+		}
+
 		/// Get the order that this effect should be executed.
 		int Order() const { return order; }
 
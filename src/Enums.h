@@ -133,6 +133,14 @@ enum ChromaKeyMethod
     CHROMAKEY_LAST_METHOD = CHROMAKEY_YCBCR
 };
 
+/// This enumeration determines the algorithm used by the Blur effect
+enum BlurMethod
+{
+    BLUR_BOX,               ///< Iterated box blur (3 iterations approximate a Gaussian blur)
+    BLUR_GAUSSIAN,          ///< Recursive Gaussian blur (Young / van Vliet), its speed does not depend on sigma
+    BLUR_LAST_METHOD = BLUR_GAUSSIAN
+};
+
 }  // namespace openshot
 
 #endif
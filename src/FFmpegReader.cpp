@@ -15,15 +15,20 @@
 
 #include <thread>	// for std::this_thread::sleep_for
 #include <chrono>	// for std::chrono::milliseconds
+#include <sstream>	// for std::stringstream
 #include <unistd.h>
 
 #include "FFmpegUtilities.h"
 
 #include "FFmpegReader.h"
 #include "Exceptions.h"
+#include "Profiler.h"
 #include "Timeline.h"
 #include "ZmqLogger.h"
 
+#include <AppConfig.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
 #define ENABLE_VAAPI 0
 
 #if USE_HW_ACCEL
@@ -62,6 +67,11 @@ typedef struct VAAPIDecodeContext {
 
 using namespace openshot;
 
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+// The RGBA buffer of an image belongs to the openshot::Frame (so FFmpeg never frees it)
+static void keep_buffer(void *opaque, uint8_t *data) { }
+#endif
+
 int hw_de_on = 0;
 #if USE_HW_ACCEL
 	AVPixelFormat hw_de_av_pix_fmt_global = AV_PIX_FMT_NONE;
@@ -74,7 +84,10 @@ FFmpegReader::FFmpegReader(const std::string &path, bool inspect_reader)
 		  seek_audio_frame_found(0), seek_video_frame_found(0),is_duration_known(false), largest_frame_processed(0),
 		  current_video_frame(0), packet(NULL), max_concurrent_frames(OPEN_MP_NUM_PROCESSORS), audio_pts(0),
 		  video_pts(0), pFormatCtx(NULL), videoStream(-1), audioStream(-1), pCodecCtx(NULL), aCodecCtx(NULL),
-		  pStream(NULL), aStream(NULL), pFrame(NULL), previous_packet_location{-1,0},
+		  pStream(NULL), aStream(NULL), pFrame(NULL), avr(NULL), avr_sample_fmt(-1), avr_channel_layout(0),
+		  img_convert_ctx(NULL), last_keyframe(0), keyframe_distance(0),
+		  is_reverse_cache(false), is_requested_frame_skipped(false),
+		  previous_packet_location{-1,0},
 		  hold_packet(false) {
 
 	// Initialize FFMpeg, and register all formats and codecs
@@ -86,6 +99,13 @@ FFmpegReader::FFmpegReader(const std::string &path, bool inspect_reader)
 	video_pts_seconds = NO_PTS_OFFSET;
 	audio_pts_seconds = NO_PTS_OFFSET;
 
+#if USE_AVFILTER
+	// Init scale filter graph (created when the first image is processed)
+	scale_graph = NULL;
+	scale_source = NULL;
+	scale_sink = NULL;
+#endif
+
 	// Init cache
 	working_cache.SetMaxBytesFromInfo(max_concurrent_frames * info.fps.ToDouble() * 2, info.width, info.height, info.sample_rate, info.channels);
 	final_cache.SetMaxBytesFromInfo(max_concurrent_frames * 2, info.width, info.height, info.sample_rate, info.channels);
@@ -561,6 +581,7 @@ void FFmpegReader::Open() {
 		// Adjust cache size based on size of frame and audio
 		working_cache.SetMaxBytesFromInfo(max_concurrent_frames * info.fps.ToDouble() * 2, info.width, info.height, info.sample_rate, info.channels);
 		final_cache.SetMaxBytesFromInfo(max_concurrent_frames * 2, info.width, info.height, info.sample_rate, info.channels);
+		is_reverse_cache = false;
 
 		// Scan PTS for any offsets (i.e. non-zero starting streams). At least 1 stream must start at zero timestamp.
 		// This method allows us to shift timestamps to ensure at least 1 stream is starting at zero.
@@ -618,8 +639,8 @@ void FFmpegReader::Close() {
 			RemoveAVPacket(recent_packet);
 		}
 
-		// Close the video codec
-		if (info.has_video) {
+		// Close the video codec (even if has_video was overridden after opening)
+		if (videoStream != -1) {
 			if(avcodec_is_open(pCodecCtx)) {
 				avcodec_flush_buffers(pCodecCtx);
 			}
@@ -634,14 +655,33 @@ void FFmpegReader::Close() {
 #endif // USE_HW_ACCEL
 		}
 
-		// Close the audio codec
-		if (info.has_audio) {
+		// Close the audio codec (even if has_audio was overridden after opening)
+		if (audioStream != -1) {
 			if(avcodec_is_open(aCodecCtx)) {
 				avcodec_flush_buffers(aCodecCtx);
 			}
 			AV_FREE_CONTEXT(aCodecCtx);
 		}
 
+		// Close the audio resampler
+		if (avr) {
+			SWR_CLOSE(avr);
+			SWR_FREE(&avr);
+			avr = NULL;
+		}
+		avr_sample_fmt = -1;
+		avr_channel_layout = 0;
+
+		// Free the image converter (and the scale filter graph)
+		if (img_convert_ctx) {
+			sws_freeContext(img_convert_ctx);
+			img_convert_ctx = NULL;
+		}
+		img_convert_key.clear();
+#if USE_AVFILTER
+		RemoveScaleGraph();
+#endif
+
 		// Clear final cache
 		final_cache.Clear();
 		working_cache.Clear();
@@ -913,9 +953,33 @@ std::shared_ptr<Frame> FFmpegReader::GetFrame(int64_t requested_frame) {
 
 			// Are we within X frames of the requested frame?
 			int64_t diff = requested_frame - last_frame;
+
+			// Skip decoding non-reference frames (i.e. B-frames), when the preview is playing fast (i.e. shuttling),
+			// and frames are requested far apart. Skipped frames are never cached (see CheckWorkingFrames).
+			bool skip_nonref = diff > 1 && diff <= 20 && IsPreviewSkipping();
+			if (info.has_video && pCodecCtx)
+				pCodecCtx->skip_frame = skip_nonref ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+			is_requested_frame_skipped = false;
+
+			int64_t reverse_span = GetReverseSpan();
+			bool is_reverse = enable_seek && info.has_video && diff < 0 && diff >= -2 * reverse_span;
+			if (is_reverse_cache && !is_reverse) {
+				// Done playing backwards, so restore the normal size of the final cache
+				final_cache.SetMaxBytesFromInfo(max_concurrent_frames * 2, info.width, info.height, info.sample_rate, info.channels);
+				is_reverse_cache = false;
+			}
+
 			if (diff >= 1 && diff <= 20) {
 				// Continue walking the stream
 				frame = ReadStream(requested_frame);
+			} else if (is_reverse) {
+				// Requested a little backwards (i.e. reverse playback), so seek once and decode a whole span
+				// forward (from a key frame), which caches the next frames requested backwards
+				ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::GetFrame (reverse)", "requested_frame", requested_frame, "reverse_span", reverse_span, "keyframe_distance", keyframe_distance);
+				final_cache.SetMaxBytesFromInfo(std::max(int64_t(max_concurrent_frames * 2), reverse_span + max_concurrent_frames), info.width, info.height, info.sample_rate, info.channels);
+				is_reverse_cache = true;
+				Seek(requested_frame - reverse_span + 1);
+				frame = ReadStream(requested_frame);
 			} else {
 				// Greater than 30 frames away, or backwards, we need to seek to the nearest key frame
 				if (enable_seek) {
@@ -931,6 +995,18 @@ std::shared_ptr<Frame> FFmpegReader::GetFrame(int64_t requested_frame) {
 				// Then continue walking the stream
 				frame = ReadStream(requested_frame);
 			}
+
+			if (is_requested_frame_skipped) {
+				// The requested frame is a non-reference frame (which was skipped), so decode it again
+				// (without skipping), instead of returning the image of a previous frame
+				ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::GetFrame (decode skipped frame)", "requested_frame", requested_frame);
+				final_cache.Remove(requested_frame);
+				if (pCodecCtx)
+					pCodecCtx->skip_frame = AVDISCARD_DEFAULT;
+				is_requested_frame_skipped = false;
+				Seek(requested_frame);
+				frame = ReadStream(requested_frame);
+			}
 		}
 		return frame;
 	}
@@ -938,6 +1014,9 @@ std::shared_ptr<Frame> FFmpegReader::GetFrame(int64_t requested_frame) {
 
 // Read the stream until we find the requested Frame
 std::shared_ptr<Frame> FFmpegReader::ReadStream(int64_t requested_frame) {
+	// Time the decoding (named by the file path)
+	ProfileScope profile("decode", path);
+
 	// Allocate video frame
 	bool check_seek = false;
 	int packet_error = -1;
@@ -1087,6 +1166,23 @@ std::shared_ptr<Frame> FFmpegReader::ReadStream(int64_t requested_frame) {
 
 }
 
+// Get the number of frames to decode forward (after one seek), when frames are requested backwards
+int64_t FFmpegReader::GetReverseSpan() {
+	// A whole GOP (if known), limited by the max number of frames to buffer
+	int64_t max_span = std::max(Settings::Instance()->REVERSE_PLAYBACK_MAX_FRAMES, 1);
+	int64_t span = keyframe_distance > 0 ? keyframe_distance : max_span;
+	return std::min(std::max(span, int64_t(std::max(max_concurrent_frames, 8))), max_span);
+}
+
+// Is the preview of the parent timeline playing fast enough to skip decoding non-reference frames
+bool FFmpegReader::IsPreviewSkipping() {
+	int skip_step = Settings::Instance()->SKIP_NONREF_FRAMES_STEP;
+	Clip *parent = (Clip *) ParentClip();
+	if (skip_step <= 0 || !parent || !parent->ParentTimeline())
+		return false;
+	return std::abs(parent->ParentTimeline()->preview_speed) >= skip_step;
+}
+
 // Get the next packet (if any)
 int FFmpegReader::GetNextPacket() {
 	int found_packet = 0;
@@ -1106,6 +1202,15 @@ int FFmpegReader::GetNextPacket() {
 		// Keep track of packet stats
 		if (packet->stream_index == videoStream) {
 			packet_status.video_read++;
+
+			// Track the distance between key frames (used to decode whole GOPs when playing backwards)
+			if ((packet->flags & AV_PKT_FLAG_KEY) && packet->pts != AV_NOPTS_VALUE) {
+				double keyframe_seconds = (double(packet->pts) * info.video_timebase.ToDouble()) + pts_offset_seconds;
+				int64_t keyframe = round(keyframe_seconds * info.fps.ToDouble()) + 1;
+				if (last_keyframe > 0 && keyframe > last_keyframe)
+					keyframe_distance = keyframe - last_keyframe;
+				last_keyframe = keyframe;
+			}
 		} else if (packet->stream_index == audioStream) {
 			packet_status.audio_read++;
 		}
@@ -1205,16 +1310,9 @@ bool FFmpegReader::GetAVFrame() {
 
 #if USE_HW_ACCEL
 			if (hw_de_on && hw_de_supported) {
-				int err;
-				if (next_frame2->format == hw_de_av_pix_fmt) {
-					next_frame->format = AV_PIX_FMT_YUV420P;
-					if ((err = av_hwframe_transfer_data(next_frame,next_frame2,0)) < 0) {
-						ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::GetAVFrame (Failed to transfer data to output frame)", "hw_de_on", hw_de_on);
-					}
-					if ((err = av_frame_copy_props(next_frame,next_frame2)) < 0) {
-						ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::GetAVFrame (Failed to copy props to output frame)", "hw_de_on", hw_de_on);
-					}
-				}
+				// Keep the hardware surface (if any), which is scaled (on the GPU) and
+				// transferred to system memory when the image is processed (see ProcessVideoPacket)
+				av_frame_move_ref(next_frame, next_frame2);
 			}
 			else
 #endif // USE_HW_ACCEL
@@ -1227,10 +1325,6 @@ bool FFmpegReader::GetAVFrame() {
 			frameFinished = 1;
 			packet_status.video_decoded++;
 
-			av_image_alloc(pFrame->data, pFrame->linesize, info.width, info.height, (AVPixelFormat)(pStream->codecpar->format), 1);
-			av_image_copy(pFrame->data, pFrame->linesize, (const uint8_t**)next_frame->data, next_frame->linesize,
-										(AVPixelFormat)(pStream->codecpar->format), info.width, info.height);
-
 			// Get display PTS from video frame, often different than packet->pts.
 			// Sending packets to the decoder (i.e. packet->pts) is async,
 			// and retrieving packets from the decoder (frame->pts) is async. In most decoders
@@ -1244,6 +1338,11 @@ bool FFmpegReader::GetAVFrame() {
 				video_pts = next_frame->pkt_dts;
 			}
 
+			// Take a reference to the decoded image (instead of copying it). The decoder
+			// allocates a new buffer (from its pool) for each frame, and reuses this
+			// buffer once the reference is released (see RemoveAVFrame).
+			av_frame_move_ref(pFrame, next_frame);
+
 			ZmqLogger::Instance()->AppendDebugMethod(
 					"FFmpegReader::GetAVFrame (Successful frame received)", "video_pts", video_pts, "send_packet_pts", send_packet_pts);
 
@@ -1337,6 +1436,8 @@ void FFmpegReader::ProcessVideoPacket(int64_t requested_frame) {
 	// Check if the AVFrame is finished and set it
 	if (!frame_finished) {
 		// No AVFrame decoded yet, bail out
+		RemoveAVFrame(pFrame);
+		pFrame = NULL;
 		return;
 	}
 
@@ -1357,21 +1458,139 @@ void FFmpegReader::ProcessVideoPacket(int64_t requested_frame) {
 	ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessVideoPacket (Before)", "requested_frame", requested_frame, "current_frame", current_frame);
 
 	// Init some things local (for OpenMP)
-	PixelFormat pix_fmt = AV_GET_CODEC_PIXEL_FORMAT(pStream, pCodecCtx);
 	int height = info.height;
 	int width = info.width;
-	int64_t video_length = info.video_length;
 	AVFrame *my_frame = pFrame;
 	pFrame = NULL;
 
-	// Create variables for a RGB Frame (since most videos are not in RGB, we must convert it)
-	AVFrame *pFrameRGB = nullptr;
-	uint8_t *buffer = nullptr;
+	// Determine the size of the image (before transferring or converting it)
+	GetTargetSize(width, height);
 
-	// Allocate an AVFrame structure
-	pFrameRGB = AV_ALLOCATE_FRAME();
-	if (pFrameRGB == nullptr)
-		throw OutOfMemory("Failed to allocate frame buffer", path);
+	// Determine required buffer size and allocate buffer
+	const int bytes_per_pixel = 4;
+	int buffer_size = (width * height * bytes_per_pixel) + 128;
+	uint8_t *buffer = new unsigned char[buffer_size]();
+
+	// Scale (and convert) hardware surfaces with a filter graph, which scales them on the GPU, before they
+	// are downloaded to system memory (so only the scaled image is transferred)
+	AVFrame *scaled_frame = NULL;
+#if USE_AVFILTER && USE_HW_ACCEL
+	if (my_frame->hw_frames_ctx)
+		scaled_frame = ScaleAVFrame(my_frame, width, height);
+#endif
+	if (scaled_frame) {
+		av_image_copy_to_buffer(buffer, buffer_size, (const uint8_t * const *) scaled_frame->data, scaled_frame->linesize,
+								AV_PIX_FMT_RGBA, width, height, 1);
+		AV_FREE_FRAME(&scaled_frame);
+	} else {
+#if USE_HW_ACCEL
+		if (my_frame->hw_frames_ctx) {
+			// Transfer the hardware surface to system memory (at full size)
+			AVFrame *sw_frame = AV_ALLOCATE_FRAME();
+			if (av_hwframe_transfer_data(sw_frame, my_frame, 0) < 0 || av_frame_copy_props(sw_frame, my_frame) < 0) {
+				ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessVideoPacket (Failed to transfer data to output frame)", "hw_de_on", hw_de_on);
+			}
+			RemoveAVFrame(my_frame);
+			my_frame = sw_frame;
+		}
+#endif // USE_HW_ACCEL
+
+		// Create variables for a RGB Frame (since most videos are not in RGB, we must convert it)
+		AVFrame *pFrameRGB = AV_ALLOCATE_FRAME();
+		if (pFrameRGB == nullptr)
+			throw OutOfMemory("Failed to allocate frame buffer", path);
+
+		// Copy picture data from one AVFrame (or AVPicture) to another one.
+		AV_COPY_PICTURE_DATA(pFrameRGB, buffer, PIX_FMT_RGBA, width, height);
+
+		int scale_mode = SWS_FAST_BILINEAR;
+		if (openshot::Settings::Instance()->HIGH_QUALITY_SCALING) {
+			scale_mode = SWS_BICUBIC;
+		}
+		PixelFormat source_pix_fmt = my_frame->format >= 0 ? (PixelFormat) my_frame->format : AV_GET_CODEC_PIXEL_FORMAT(pStream, pCodecCtx);
+		int source_width = my_frame->width > 0 ? my_frame->width : info.width;
+		int source_height = my_frame->height > 0 ? my_frame->height : info.height;
+
+		// Create the converter again, when the input or target size (or format) changes. The RGBA image
+		// is written directly into the buffer, using threads (when supported).
+		std::vector<int64_t> key = {source_width, source_height, source_pix_fmt, width, height, scale_mode};
+		if (!img_convert_ctx || key != img_convert_key) {
+			if (img_convert_ctx)
+				sws_freeContext(img_convert_ctx);
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+			img_convert_ctx = sws_alloc_context();
+			if (img_convert_ctx) {
+				av_opt_set_int(img_convert_ctx, "srcw", source_width, 0);
+				av_opt_set_int(img_convert_ctx, "srch", source_height, 0);
+				av_opt_set_int(img_convert_ctx, "src_format", source_pix_fmt, 0);
+				av_opt_set_int(img_convert_ctx, "dstw", width, 0);
+				av_opt_set_int(img_convert_ctx, "dsth", height, 0);
+				av_opt_set_int(img_convert_ctx, "dst_format", PIX_FMT_RGBA, 0);
+				av_opt_set_int(img_convert_ctx, "sws_flags", scale_mode, 0);
+				av_opt_set_int(img_convert_ctx, "threads", std::max(1, openshot::Settings::Instance()->FF_THREADS), 0);
+				if (sws_init_context(img_convert_ctx, NULL, NULL) < 0) {
+					sws_freeContext(img_convert_ctx);
+					img_convert_ctx = NULL;
+				}
+			}
+#else
+			img_convert_ctx = sws_getContext(source_width, source_height, source_pix_fmt, width,
+											 height, PIX_FMT_RGBA, scale_mode, NULL, NULL, NULL);
+#endif
+			img_convert_key = key;
+		}
+
+		// Resize / Convert to RGB
+#if LIBSWSCALE_VERSION_MAJOR >= 6
+		// Only frames are scaled in slices (by threads), so the buffer is wrapped in the RGB frame
+		pFrameRGB->width = width;
+		pFrameRGB->height = height;
+		pFrameRGB->format = PIX_FMT_RGBA;
+		pFrameRGB->buf[0] = av_buffer_create(buffer, buffer_size, keep_buffer, NULL, 0);
+		if (img_convert_ctx && my_frame->buf[0] && pFrameRGB->buf[0])
+			sws_scale_frame(img_convert_ctx, pFrameRGB, my_frame);
+		else
+#endif
+		if (img_convert_ctx)
+			sws_scale(img_convert_ctx, my_frame->data, my_frame->linesize, 0,
+					  source_height, pFrameRGB->data, pFrameRGB->linesize);
+
+		// Free the RGB image
+		AV_FREE_FRAME(&pFrameRGB);
+	}
+
+	// Create or get the existing frame object
+	std::shared_ptr<Frame> f = CreateFrame(current_frame);
+
+	// Add Image data to frame
+	if (!ffmpeg_has_alpha(AV_GET_CODEC_PIXEL_FORMAT(pStream, pCodecCtx))) {
+		// Add image with no alpha channel, Speed optimization
+		f->AddImage(width, height, bytes_per_pixel, QImage::Format_RGBA8888_Premultiplied, buffer);
+	} else {
+		// Add image with alpha channel (this will be converted to premultipled when needed, but is slower)
+		f->AddImage(width, height, bytes_per_pixel, QImage::Format_RGBA8888, buffer);
+	}
+
+	// Update working cache
+	working_cache.Add(f);
+
+	// Keep track of last last_video_frame
+	last_video_frame = f;
+
+	// Remove frame and packet
+	RemoveAVFrame(my_frame);
+
+	// Get video PTS in seconds
+	video_pts_seconds = (double(video_pts) * info.video_timebase.ToDouble()) + pts_offset_seconds;
+
+	// Debug output
+	ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessVideoPacket (After)", "requested_frame", requested_frame, "current_frame", current_frame, "f->number", f->number, "video_pts_seconds", video_pts_seconds);
+}
+
+// Get the size of decoded images (based on the preview size, and the scaling of the parent clip)
+void FFmpegReader::GetTargetSize(int &width, int &height) {
+	width = info.width;
+	height = info.height;
 
 	// Determine the max size of this source image (based on the timeline's size, the scaling mode,
 	// and the scaling keyframes). This is a performance improvement, to keep the images as small as possible,
@@ -1429,7 +1648,6 @@ void FFmpegReader::ProcessVideoPacket(int64_t requested_frame) {
 	}
 
 	// Determine if image needs to be scaled (for performance reasons)
-	int original_height = height;
 	if (max_width != 0 && max_height != 0 && max_width < width && max_height < height) {
 		// Override width and height (but maintain aspect ratio)
 		float ratio = float(width) / float(height);
@@ -1446,56 +1664,6 @@ void FFmpegReader::ProcessVideoPacket(int64_t requested_frame) {
 			height = possible_height;
 		}
 	}
-
-	// Determine required buffer size and allocate buffer
-	const int bytes_per_pixel = 4;
-	int buffer_size = (width * height * bytes_per_pixel) + 128;
-	buffer = new unsigned char[buffer_size]();
-
-	// Copy picture data from one AVFrame (or AVPicture) to another one.
-	AV_COPY_PICTURE_DATA(pFrameRGB, buffer, PIX_FMT_RGBA, width, height);
-
-	int scale_mode = SWS_FAST_BILINEAR;
-	if (openshot::Settings::Instance()->HIGH_QUALITY_SCALING) {
-		scale_mode = SWS_BICUBIC;
-	}
-	SwsContext *img_convert_ctx = sws_getContext(info.width, info.height, AV_GET_CODEC_PIXEL_FORMAT(pStream, pCodecCtx), width,
-												 height, PIX_FMT_RGBA, scale_mode, NULL, NULL, NULL);
-
-	// Resize / Convert to RGB
-	sws_scale(img_convert_ctx, my_frame->data, my_frame->linesize, 0,
-			  original_height, pFrameRGB->data, pFrameRGB->linesize);
-
-	// Create or get the existing frame object
-	std::shared_ptr<Frame> f = CreateFrame(current_frame);
-
-	// Add Image data to frame
-	if (!ffmpeg_has_alpha(AV_GET_CODEC_PIXEL_FORMAT(pStream, pCodecCtx))) {
-		// Add image with no alpha channel, Speed optimization
-		f->AddImage(width, height, bytes_per_pixel, QImage::Format_RGBA8888_Premultiplied, buffer);
-	} else {
-		// Add image with alpha channel (this will be converted to premultipled when needed, but is slower)
-		f->AddImage(width, height, bytes_per_pixel, QImage::Format_RGBA8888, buffer);
-	}
-
-	// Update working cache
-	working_cache.Add(f);
-
-	// Keep track of last last_video_frame
-	last_video_frame = f;
-
-	// Free the RGB image
-	AV_FREE_FRAME(&pFrameRGB);
-
-	// Remove frame and packet
-	RemoveAVFrame(my_frame);
-	sws_freeContext(img_convert_ctx);
-
-	// Get video PTS in seconds
-	video_pts_seconds = (double(video_pts) * info.video_timebase.ToDouble()) + pts_offset_seconds;
-
-	// Debug output
-	ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessVideoPacket (After)", "requested_frame", requested_frame, "current_frame", current_frame, "f->number", f->number, "video_pts_seconds", video_pts_seconds);
 }
 
 // Process an audio packet
@@ -1613,160 +1781,105 @@ void FFmpegReader::ProcessAudioPacket(int64_t requested_frame) {
 		}
 	}
 
-	// Allocate audio buffer
-	int16_t *audio_buf = new int16_t[AVCODEC_MAX_AUDIO_FRAME_SIZE + MY_INPUT_BUFFER_PADDING_SIZE];
-
 	ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessAudioPacket (ReSample)",
 										  "packet_samples", packet_samples,
 										  "info.channels", info.channels,
 										  "info.sample_rate", info.sample_rate,
-										  "aCodecCtx->sample_fmt", AV_GET_SAMPLE_FORMAT(aStream, aCodecCtx),
-										  "AV_SAMPLE_FMT_S16", AV_SAMPLE_FMT_S16);
-
-	// Create output frame
-	AVFrame *audio_converted = AV_ALLOCATE_FRAME();
-	AV_RESET_FRAME(audio_converted);
-	audio_converted->nb_samples = audio_frame->nb_samples;
-	av_samples_alloc(audio_converted->data, audio_converted->linesize, info.channels, audio_frame->nb_samples, AV_SAMPLE_FMT_S16, 0);
-
-	SWRCONTEXT *avr = NULL;
-	int nb_samples = 0;
-
-	// setup resample context
-	avr = SWR_ALLOC();
-	av_opt_set_int(avr, "in_channel_layout", AV_GET_CODEC_ATTRIBUTES(aStream, aCodecCtx)->channel_layout, 0);
-	av_opt_set_int(avr, "out_channel_layout", AV_GET_CODEC_ATTRIBUTES(aStream, aCodecCtx)->channel_layout, 0);
-	av_opt_set_int(avr, "in_sample_fmt", AV_GET_SAMPLE_FORMAT(aStream, aCodecCtx), 0);
-	av_opt_set_int(avr, "out_sample_fmt", AV_SAMPLE_FMT_S16, 0);
-	av_opt_set_int(avr, "in_sample_rate", info.sample_rate, 0);
-	av_opt_set_int(avr, "out_sample_rate", info.sample_rate, 0);
-	av_opt_set_int(avr, "in_channels", info.channels, 0);
-	av_opt_set_int(avr, "out_channels", info.channels, 0);
-	SWR_INIT(avr);
-
-	// Convert audio samples
-	nb_samples = SWR_CONVERT(avr,	// audio resample context
-							 audio_converted->data,		  // output data pointers
-							 audio_converted->linesize[0],   // output plane size, in bytes. (0 if unknown)
-							 audio_converted->nb_samples,	// maximum number of samples that the output buffer can hold
-							 audio_frame->data,			  // input data pointers
-							 audio_frame->linesize[0],	   // input plane size, in bytes (0 if unknown)
-							 audio_frame->nb_samples);	   // number of input samples to convert
-
-	// Copy audio samples over original samples
-	memcpy(audio_buf,
-		audio_converted->data[0],
-		static_cast<size_t>(audio_converted->nb_samples)
-		* av_get_bytes_per_sample(AV_SAMPLE_FMT_S16)
-		* info.channels);
-
-	// Deallocate resample buffer
-	SWR_CLOSE(avr);
-	SWR_FREE(&avr);
-	avr = NULL;
-
-	// Free AVFrames
-	av_free(audio_converted->data[0]);
-	AV_FREE_FRAME(&audio_converted);
-
-	int64_t starting_frame_number = -1;
-	bool partial_frame = true;
-	for (int channel_filter = 0; channel_filter < info.channels; channel_filter++) {
-		// Array of floats (to hold samples for each channel)
-		starting_frame_number = location.frame;
-		int channel_buffer_size = packet_samples / info.channels;
-		float *channel_buffer = new float[channel_buffer_size];
-
-		// Init buffer array
-		for (int z = 0; z < channel_buffer_size; z++)
-			channel_buffer[z] = 0.0f;
-
-		// Loop through all samples and add them to our Frame based on channel.
-		// Toggle through each channel number, since channel data is stored like (left right left right)
-		int channel = 0;
-		int position = 0;
-		for (int sample = 0; sample < packet_samples; sample++) {
-			// Only add samples for current channel
-			if (channel_filter == channel) {
-				// Add sample (convert from (-32768 to 32768)  to (-1.0 to 1.0))
-				channel_buffer[position] = audio_buf[sample] * (1.0f / (1 << 15));
-
-				// Increment audio position
-				position++;
-			}
-
-			// increment channel (if needed)
-			if ((channel + 1) < info.channels)
-				// move to next channel
-				channel++;
-			else
-				// reset channel
-				channel = 0;
+										  "audio_frame->format", audio_frame->format,
+										  "AV_SAMPLE_FMT_FLTP", AV_SAMPLE_FMT_FLTP);
+
+	// Setup the resample context once (and again only if the decoded format changes)
+	int64_t channel_layout = AV_GET_CODEC_ATTRIBUTES(aStream, aCodecCtx)->channel_layout;
+	if (!avr || avr_sample_fmt != audio_frame->format || avr_channel_layout != channel_layout) {
+		if (avr) {
+			SWR_CLOSE(avr);
+			SWR_FREE(&avr);
 		}
+		avr = SWR_ALLOC();
+		av_opt_set_int(avr, "in_channel_layout", channel_layout, 0);
+		av_opt_set_int(avr, "out_channel_layout", channel_layout, 0);
+		av_opt_set_int(avr, "in_sample_fmt", audio_frame->format, 0);
+		av_opt_set_int(avr, "out_sample_fmt", AV_SAMPLE_FMT_FLTP, 0);
+		av_opt_set_int(avr, "in_sample_rate", info.sample_rate, 0);
+		av_opt_set_int(avr, "out_sample_rate", info.sample_rate, 0);
+		av_opt_set_int(avr, "in_channels", info.channels, 0);
+		av_opt_set_int(avr, "out_channels", info.channels, 0);
+		SWR_INIT(avr);
+		avr_sample_fmt = audio_frame->format;
+		avr_channel_layout = channel_layout;
+	}
 
-		// Loop through samples, and add them to the correct frames
-		int start = location.sample_start;
-		int remaining_samples = channel_buffer_size;
-		float *iterate_channel_buffer = channel_buffer;	// pointer to channel buffer
-		while (remaining_samples > 0) {
-			// Get Samples per frame (for this frame number)
-			int samples_per_frame = Frame::GetSamplesPerFrame(starting_frame_number,
-													 info.fps, info.sample_rate, info.channels);
-
-			// Calculate # of samples to add to this frame
-			int samples = samples_per_frame - start;
-			if (samples > remaining_samples)
-				samples = remaining_samples;
-
-			// Create or get the existing frame object
-			std::shared_ptr<Frame> f = CreateFrame(starting_frame_number);
-
-			// Determine if this frame was "partially" filled in
-			if (samples_per_frame == start + samples)
-				partial_frame = false;
-			else
-				partial_frame = true;
+	// Convert audio samples (to planar floats, -1.0 to 1.0) directly into the audio of each frame
+	int channel_buffer_size = packet_samples / info.channels;
+	std::vector<uint8_t *> frame_channels(info.channels);
+	int64_t starting_frame_number = location.frame;
+	int start = location.sample_start;
+	int remaining_samples = channel_buffer_size;
+	bool partial_frame = true;
+	bool has_converted = false;
+	while (remaining_samples > 0) {
+		// Get Samples per frame (for this frame number)
+		int samples_per_frame = Frame::GetSamplesPerFrame(starting_frame_number,
+												 info.fps, info.sample_rate, info.channels);
 
-			// Add samples for current channel to the frame.
-			f->AddAudio(true, channel_filter, start, iterate_channel_buffer,
-			   samples, 1.0f);
+		// Calculate # of samples to add to this frame
+		int samples = samples_per_frame - start;
+		if (samples > remaining_samples)
+			samples = remaining_samples;
 
-			// Debug output
-			ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessAudioPacket (f->AddAudio)",
-											"frame", starting_frame_number,
-											"start", start,
-											"samples", samples,
-											"channel", channel_filter,
-											"partial_frame", partial_frame,
-											"samples_per_frame", samples_per_frame);
+		// Create or get the existing frame object
+		std::shared_ptr<Frame> f = CreateFrame(starting_frame_number);
 
-			// Add or update cache
-			working_cache.Add(f);
+		// Determine if this frame was "partially" filled in
+		if (samples_per_frame == start + samples)
+			partial_frame = false;
+		else
+			partial_frame = true;
+
+		// Point the output of the resampler at the samples of each channel of the frame
+		f->ReserveAudio(info.channels, start, samples);
+		for (int channel = 0; channel < info.channels; channel++)
+			frame_channels[channel] = (uint8_t *) f->audio->getWritePointer(channel, start);
+
+		// The first call converts the whole packet, and the resampler keeps the samples
+		// which don't fit in this frame (which the next calls output into the next frames)
+		int nb_samples = SWR_CONVERT(avr,	// audio resample context
+								 frame_channels.data(),	// output data pointers
+								 samples * sizeof(float),	// output plane size, in bytes. (0 if unknown)
+								 samples,	// maximum number of samples that the output buffer can hold
+								 has_converted ? NULL : audio_frame->data,	// input data pointers
+								 has_converted ? 0 : audio_frame->linesize[0],	// input plane size, in bytes (0 if unknown)
+								 has_converted ? 0 : audio_frame->nb_samples);	// number of input samples to convert
+		has_converted = true;
+
+		// Samples which failed to convert are silent
+		if (nb_samples < samples) {
+			for (int channel = 0; channel < info.channels; channel++)
+				f->audio->clear(channel, start + std::max(nb_samples, 0), samples - std::max(nb_samples, 0));
+		}
 
-			// Decrement remaining samples
-			remaining_samples -= samples;
+		// Debug output
+		ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::ProcessAudioPacket (convert into frame)",
+										"frame", starting_frame_number,
+										"start", start,
+										"samples", samples,
+										"nb_samples", nb_samples,
+										"partial_frame", partial_frame,
+										"samples_per_frame", samples_per_frame);
 
-			// Increment buffer (to next set of samples)
-			if (remaining_samples > 0)
-				iterate_channel_buffer += samples;
+		// Add or update cache
+		working_cache.Add(f);
 
-			// Increment frame number
-			starting_frame_number++;
+		// Decrement remaining samples
+		remaining_samples -= samples;
 
-			// Reset starting sample #
-			start = 0;
-		}
+		// Increment frame number
+		starting_frame_number++;
 
-		// clear channel buffer
-		delete[] channel_buffer;
-		channel_buffer = NULL;
-		iterate_channel_buffer = NULL;
+		// Reset starting sample #
+		start = 0;
 	}
 
-	// Clean up some arrays
-	delete[] audio_buf;
-	audio_buf = NULL;
-
 	// Free audio frame
 	AV_FREE_FRAME(&audio_frame);
 
@@ -1813,6 +1926,7 @@ void FFmpegReader::Seek(int64_t requested_frame) {
 	last_frame = 0;
 	current_video_frame = 0;
 	largest_frame_processed = 0;
+	last_keyframe = 0;
 	bool has_audio_override = info.has_audio;
 	bool has_video_override = info.has_video;
 
@@ -2191,6 +2305,7 @@ void FFmpegReader::CheckWorkingFrames(int64_t requested_frame) {
 		// Determine if video and audio are ready (based on timestamps)
 		bool is_video_ready = false;
 		bool is_audio_ready = false;
+		bool is_skipped = false;
 		double recent_pts_diff = recent_pts_seconds - frame_pts_seconds;
 		if ((frame_pts_seconds <= video_pts_seconds)
 			|| (recent_pts_diff > 1.5)
@@ -2203,21 +2318,30 @@ void FFmpegReader::CheckWorkingFrames(int64_t requested_frame) {
 											"frame_pts_seconds", frame_pts_seconds, 
 											"video_pts_seconds", video_pts_seconds, 
 											"recent_pts_diff", recent_pts_diff);
+			if (info.has_video && !f->has_image_data && pCodecCtx && pCodecCtx->skip_frame == AVDISCARD_NONREF
+				&& !packet_status.video_eof && !packet_status.end_of_file) {
+				// The image was skipped (non-reference frame), so never cache the image of a previous frame
+				is_skipped = true;
+				if (f->number == requested_frame)
+					is_requested_frame_skipped = true;
+			}
 			if (info.has_video && !f->has_image_data) {
-				// Frame has no image data (copy from previous frame)
+				// Frame has no image data (copy from previous frame). QImage copies share the
+				// pixels of the previous image (until either image is modified), so repeated
+				// frames (i.e. variable frame rate videos) don't copy their images.
 				// Loop backwards through final frames (looking for the nearest, previous frame image)
 				for (int64_t previous_frame = requested_frame - 1; previous_frame > 0; previous_frame--) {
 					std::shared_ptr<Frame> previous_frame_instance = final_cache.GetFrame(previous_frame);
 					if (previous_frame_instance && previous_frame_instance->has_image_data) {
 						// Copy image from last decoded frame
-						f->AddImage(std::make_shared<QImage>(previous_frame_instance->GetImage()->copy()));
+						f->AddImage(std::make_shared<QImage>(*previous_frame_instance->GetImage()));
 						break;
 					}
 				}
 				
 				if (last_video_frame && !f->has_image_data) {
 					// Copy image from last decoded frame
-					f->AddImage(std::make_shared<QImage>(last_video_frame->GetImage()->copy()));
+					f->AddImage(std::make_shared<QImage>(*last_video_frame->GetImage()));
 				} else if (!f->has_image_data) {
 					f->AddColor("#000000");
 				}
@@ -2265,7 +2389,10 @@ void FFmpegReader::CheckWorkingFrames(int64_t requested_frame) {
 											"Final Cache Count", final_cache.Count(), 
 											"end_of_file", packet_status.end_of_file);
 
-			if (!is_seek_trash) {
+			if (is_skipped && f->number != requested_frame) {
+				// Skipped image, so delete the frame from the working cache (it's decoded again if requested)
+				working_cache.Remove(f->number);
+			} else if (!is_seek_trash) {
 				// Move frame to final cache
 				final_cache.Add(f);
 
@@ -2361,14 +2488,176 @@ void FFmpegReader::CheckFPS() {
 void FFmpegReader::RemoveAVFrame(AVFrame *remove_frame) {
 	// Remove pFrame (if exists)
 	if (remove_frame) {
+#if IS_FFMPEG_3_2
+		// Release the reference to the decoded image (returning its buffer to the decoder's pool)
+		av_frame_unref(remove_frame);
+#else
 		// Free memory
 		av_freep(&remove_frame->data[0]);
+#endif
 #ifndef WIN32
 		AV_FREE_FRAME(&remove_frame);
 #endif
 	}
 }
 
+#if USE_AVFILTER
+// Create the filter graph which scales a hardware surface to an RGBA image
+bool FFmpegReader::InitScaleGraph(AVFrame *frame, int width, int height) {
+	scale_graph = avfilter_graph_alloc();
+	if (!scale_graph)
+		return false;
+
+	// Scale slices of the image in parallel (when scaling on the CPU)
+	scale_graph->nb_threads = std::max(1, openshot::Settings::Instance()->FF_THREADS);
+	scale_graph->thread_type = AVFILTER_THREAD_SLICE;
+
+	// Input of the graph (the decoded frames)
+	AVRational pixel_aspect = frame->sample_aspect_ratio;
+	if (pixel_aspect.num <= 0 || pixel_aspect.den <= 0)
+		pixel_aspect = AVRational{1, 1};
+	std::stringstream source_args;
+	source_args << "video_size=" << frame->width << "x" << frame->height
+				<< ":pix_fmt=" << frame->format
+				<< ":time_base=" << info.video_timebase.num << "/" << info.video_timebase.den
+				<< ":pixel_aspect=" << pixel_aspect.num << "/" << pixel_aspect.den;
+	if (avfilter_graph_create_filter(&scale_source, avfilter_get_by_name("buffer"), "in",
+									 source_args.str().c_str(), NULL, scale_graph) < 0) {
+		RemoveScaleGraph();
+		return false;
+	}
+
+	// Output of the graph (the RGBA images)
+	if (avfilter_graph_create_filter(&scale_sink, avfilter_get_by_name("buffersink"), "out",
+									 NULL, NULL, scale_graph) < 0) {
+		RemoveScaleGraph();
+		return false;
+	}
+
+	const char *scale_flags = openshot::Settings::Instance()->HIGH_QUALITY_SCALING ? "bicubic" : "fast_bilinear";
+	std::stringstream filters;
+#if USE_HW_ACCEL
+	if (frame->hw_frames_ctx) {
+		// Pass the frames context of the hardware surfaces to the graph
+		AVBufferSrcParameters *source_params = av_buffersrc_parameters_alloc();
+		if (!source_params) {
+			RemoveScaleGraph();
+			return false;
+		}
+		source_params->hw_frames_ctx = frame->hw_frames_ctx;
+		int err = av_buffersrc_parameters_set(scale_source, source_params);
+		av_free(source_params);
+		if (err < 0) {
+			RemoveScaleGraph();
+			return false;
+		}
+
+		// Scale the surface on the GPU (if smaller, and the scaler of this device is available), so
+		// only the scaled image is downloaded to system memory
+		AVHWFramesContext *frames_ctx = (AVHWFramesContext *) frame->hw_frames_ctx->data;
+		const char *hw_scaler = NULL;
+		switch (frames_ctx->device_ctx->type) {
+			case AV_HWDEVICE_TYPE_VAAPI:
+				hw_scaler = "scale_vaapi";
+				break;
+			case AV_HWDEVICE_TYPE_CUDA:
+				hw_scaler = avfilter_get_by_name("scale_cuda") ? "scale_cuda" : "scale_npp";
+				break;
+			case AV_HWDEVICE_TYPE_QSV:
+				hw_scaler = "scale_qsv";
+				break;
+			case AV_HWDEVICE_TYPE_VIDEOTOOLBOX:
+				hw_scaler = "scale_vt";
+				break;
+			default:
+				break;
+		}
+		if (hw_scaler && avfilter_get_by_name(hw_scaler) && (width < frame->width || height < frame->height))
+			filters << hw_scaler << "=w=" << width << ":h=" << height << ",";
+		filters << "hwdownload,format=" << av_get_pix_fmt_name(frames_ctx->sw_format) << ",";
+	}
+#endif // USE_HW_ACCEL
+
+	// Scale (if not already scaled on the GPU) and convert to RGBA on the CPU, with the same (BT.601, limited
+	// range) colors as the converter of software decoded frames (see ProcessVideoPacket)
+	filters << "scale=w=" << width << ":h=" << height << ":flags=" << scale_flags
+			<< ":in_color_matrix=bt601:in_range=tv,format=rgba";
+
+	// Connect the filters to the input and output of the graph
+	AVFilterInOut *outputs = avfilter_inout_alloc();
+	AVFilterInOut *inputs = avfilter_inout_alloc();
+	if (!outputs || !inputs) {
+		avfilter_inout_free(&outputs);
+		avfilter_inout_free(&inputs);
+		RemoveScaleGraph();
+		return false;
+	}
+	outputs->name = av_strdup("in");
+	outputs->filter_ctx = scale_source;
+	outputs->pad_idx = 0;
+	outputs->next = NULL;
+	inputs->name = av_strdup("out");
+	inputs->filter_ctx = scale_sink;
+	inputs->pad_idx = 0;
+	inputs->next = NULL;
+
+	int err = avfilter_graph_parse_ptr(scale_graph, filters.str().c_str(), &inputs, &outputs, NULL);
+	avfilter_inout_free(&outputs);
+	avfilter_inout_free(&inputs);
+	if (err < 0 || avfilter_graph_config(scale_graph, NULL) < 0) {
+		ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::InitScaleGraph (Failed to create filter graph)", "width", width, "height", height, "frame->format", frame->format);
+		RemoveScaleGraph();
+		return false;
+	}
+
+	ZmqLogger::Instance()->AppendDebugMethod("FFmpegReader::InitScaleGraph", "frame->width", frame->width, "frame->height", frame->height, "frame->format", frame->format, "width", width, "height", height);
+	return true;
+}
+
+// Remove the filter graph (and deallocate its memory)
+void FFmpegReader::RemoveScaleGraph() {
+	if (scale_graph)
+		avfilter_graph_free(&scale_graph);
+	scale_graph = NULL;
+	scale_source = NULL;
+	scale_sink = NULL;
+	scale_graph_key.clear();
+}
+
+// Scale a hardware surface to an RGBA image of the target size (NULL if it fails)
+AVFrame *FFmpegReader::ScaleAVFrame(AVFrame *frame, int width, int height) {
+	if (!frame || frame->width <= 0 || frame->height <= 0 || frame->format < 0)
+		return NULL;
+
+	// Create the graph again, when the input or target size (or format) changes
+	int64_t hw_frames = frame->hw_frames_ctx ? (int64_t) (intptr_t) frame->hw_frames_ctx->data : 0;
+	std::vector<int64_t> key = {frame->width, frame->height, frame->format, hw_frames, width, height,
+								openshot::Settings::Instance()->HIGH_QUALITY_SCALING};
+	if (key != scale_graph_key) {
+		RemoveScaleGraph();
+		InitScaleGraph(frame, width, height);
+
+		// Remember the key (even if the graph failed, so it's not created again for each frame)
+		scale_graph_key = key;
+	}
+	if (!scale_graph)
+		return NULL;
+
+	// Send the frame (keeping our reference), and receive the scaled image
+	AVFrame *scaled_frame = AV_ALLOCATE_FRAME();
+	if (av_buffersrc_add_frame_flags(scale_source, frame, AV_BUFFERSRC_FLAG_KEEP_REF) < 0 ||
+		av_buffersink_get_frame(scale_sink, scaled_frame) < 0) {
+		AV_FREE_FRAME(&scaled_frame);
+		return NULL;
+	}
+	if (scaled_frame->width != width || scaled_frame->height != height) {
+		AV_FREE_FRAME(&scaled_frame);
+		return NULL;
+	}
+	return scaled_frame;
+}
+#endif // USE_AVFILTER
+
 // Remove AVPacket from cache (and deallocate its memory)
 void FFmpegReader::RemoveAVPacket(AVPacket *remove_packet) {
 	// deallocate memory for packet
@@ -123,6 +123,17 @@ namespace openshot {
 		AVStream *pStream, *aStream;
 		AVPacket *packet;
 		AVFrame *pFrame;
+		SWRCONTEXT *avr; ///< Audio resampler (converts decoded samples to planar floats)
+		int avr_sample_fmt; ///< Sample format the resampler was initialized for
+		int64_t avr_channel_layout; ///< Channel layout the resampler was initialized for
+		SwsContext *img_convert_ctx; ///< Converts (and scales) decoded frames to RGBA images (reused)
+		std::vector<int64_t> img_convert_key; ///< The input and target sizes (and formats) of the image converter
+#if USE_AVFILTER
+		AVFilterGraph *scale_graph; ///< Scales (and downloads) hardware surfaces to RGBA images of the target size
+		AVFilterContext *scale_source; ///< Input of the scale graph
+		AVFilterContext *scale_sink; ///< Output of the scale graph
+		std::vector<int64_t> scale_graph_key; ///< The input and target sizes (and formats) of the scale graph
+#endif
 		bool is_open;
 		bool is_duration_known;
 		bool check_interlace;
@@ -150,6 +161,10 @@ namespace openshot {
 		int64_t last_frame;
 		int64_t largest_frame_processed;
 		int64_t current_video_frame;
+		int64_t last_keyframe; ///< Frame # of the last key frame packet read (0 after a seek)
+		int64_t keyframe_distance; ///< Frames between the last 2 key frame packets (the GOP size, 0 if unknown)
+		bool is_reverse_cache; ///< Is the final cache enlarged (to hold a reverse span)
+		bool is_requested_frame_skipped; ///< Was the image of the requested frame skipped (while skipping non-reference frames)
 
 		int64_t audio_pts;
 		int64_t video_pts;
@@ -200,6 +215,15 @@ namespace openshot {
 		/// Get the PTS for the current packet
 		int64_t GetPacketPTS();
 
+		/// Get the number of frames to decode forward (after one seek), when frames are requested backwards
+		int64_t GetReverseSpan();
+
+		/// Is the preview of the parent timeline playing fast enough to skip decoding non-reference frames
+		bool IsPreviewSkipping();
+
+		/// Get the size of decoded images (based on the preview size, and the scaling of the parent clip)
+		void GetTargetSize(int &width, int &height);
+
 		/// Check if there's an album art
 		bool HasAlbumArt();
 
@@ -221,6 +245,17 @@ namespace openshot {
 		/// Remove AVPacket from cache (and deallocate its memory)
 		void RemoveAVPacket(AVPacket *);
 
+#if USE_AVFILTER
+		/// Create the filter graph which scales a hardware surface to an RGBA image
+		bool InitScaleGraph(AVFrame *frame, int width, int height);
+
+		/// Remove the filter graph (and deallocate its memory)
+		void RemoveScaleGraph();
+
+		/// Scale a hardware surface to an RGBA image of the target size (NULL if it fails)
+		AVFrame *ScaleAVFrame(AVFrame *frame, int width, int height);
+#endif
+
 		/// Seek to a specific Frame.  This is not always frame accurate, it's more of an estimation on many codecs.
 		void Seek(int64_t requested_frame);
 
@@ -68,6 +68,12 @@ extern "C" {
 #if IS_FFMPEG_3_2
     #include "libavutil/imgutils.h"
 #endif
+
+#if USE_AVFILTER
+    #include <libavfilter/avfilter.h>
+    #include <libavfilter/buffersink.h>
+    #include <libavfilter/buffersrc.h>
+#endif
 }
 
 // This was removed from newer versions of FFmpeg (but still used in libopenshot)
@@ -17,6 +17,7 @@
 #include <iostream>
 #include <cmath>
 #include <ctime>
+#include <exception>
 #include <unistd.h>
 
 #include "FFmpegUtilities.h"
@@ -76,7 +77,7 @@ FFmpegWriter::FFmpegWriter(const std::string& path) :
 		path(path), oc(NULL), audio_st(NULL), video_st(NULL), samples(NULL),
 		audio_outbuf(NULL), audio_outbuf_size(0), audio_input_frame_size(0), audio_input_position(0),
 		initial_audio_input_frame_size(0), img_convert_ctx(NULL), cache_size(8), num_of_rescalers(32),
-		rescaler_position(0), video_codec_ctx(NULL), audio_codec_ctx(NULL), is_writing(false), video_timestamp(0), audio_timestamp(0),
+		video_codec_ctx(NULL), audio_codec_ctx(NULL), is_writing(false), video_timestamp(0), audio_timestamp(0),
 		original_sample_rate(0), original_channels(0), avr(NULL), avr_planar(NULL), is_open(false), prepare_streams(false),
 		write_header(false), write_trailer(false), audio_encoder_buffer_size(0), audio_encoder_buffer(NULL) {
 
@@ -730,67 +731,48 @@ void FFmpegWriter::write_queued_frames() {
     if (info.has_audio && audio_st && !queued_audio_frames.empty())
         write_audio_packets(false);
 
-    // Loop through each queued image frame
-    while (!queued_video_frames.empty()) {
-        // Get front frame (from the queue)
-        std::shared_ptr<Frame> frame = queued_video_frames.front();
-
-        // Add to processed queue
-        processed_frames.push_back(frame);
-
-        // Encode and add the frame to the output file
-        if (info.has_video && video_st)
-            process_video_packet(frame);
-
-        // Remove front item
-        queued_video_frames.pop_front();
-
-    } // end while
-
-
-    // Loop back through the frames (in order), and write them to the video file
-    while (!processed_frames.empty()) {
-        // Get front frame (from the queue)
-        std::shared_ptr<Frame> frame = processed_frames.front();
-
-        if (info.has_video && video_st) {
-            // Add to deallocate queue (so we can remove the AVFrames when we are done)
-            deallocate_frames.push_back(frame);
-
-            // Does this frame's AVFrame still exist
-            if (av_frames.count(frame)) {
-                // Get AVFrame
-                AVFrame *frame_final = av_frames[frame];
-
-                // Write frame to video file
-                bool success = write_video_packet(frame, frame_final);
-                if (!success)
-                    has_error_encoding_video = true;
+    // Convert the queued images (in parallel), each with its own rescaler and (pooled) AVFrame
+    std::vector<std::shared_ptr<Frame>> video_frames(queued_video_frames.begin(), queued_video_frames.end());
+    std::vector<char> converted(video_frames.size(), false);
+    queued_video_frames.clear();
+    if (info.has_video && video_st && !video_frames.empty()) {
+        // Init rescalers (if not initialized yet), sized for the first image
+        for (const auto& frame : video_frames) {
+            if (image_rescalers.size() > 0)
+                break;
+            if (!(frame->GetWidth() == 1 && frame->GetHeight() == 1))
+                InitScalers(frame->GetWidth(), frame->GetHeight());
+        }
+        allocate_avframe_pool(video_frames.size());
+
+        std::vector<std::exception_ptr> errors(video_frames.size());
+        #pragma omp parallel for schedule(dynamic) num_threads(std::min(OPEN_MP_NUM_PROCESSORS, num_of_rescalers))
+        for (int index = 0; index < (int)video_frames.size(); index++) {
+            try {
+                SwsContext *scaler = image_rescalers.empty() ? NULL : image_rescalers[omp_get_thread_num()];
+                converted[index] = scaler && process_video_packet(video_frames[index], scaler, av_frame_pool[index]);
+            } catch (...) {
+                errors[index] = std::current_exception();
             }
         }
 
-        // Remove front item
-        processed_frames.pop_front();
+        // Raise the first exception (from the main thread)
+        for (const auto& error : errors) {
+            if (error) {
+                is_writing = false;
+                std::rethrow_exception(error);
+            }
+        }
     }
 
-    // Loop through, and deallocate AVFrames
-    while (!deallocate_frames.empty()) {
-        // Get front frame (from the queue)
-        std::shared_ptr<Frame> frame = deallocate_frames.front();
-
-        // Does this frame's AVFrame still exist
-        if (av_frames.count(frame)) {
-            // Get AVFrame
-            AVFrame *av_frame = av_frames[frame];
-
-            // Deallocate buffer and AVFrame
-            av_freep(&(av_frame->data[0]));
-            AV_FREE_FRAME(&av_frame);
-            av_frames.erase(frame);
+    // Loop through the frames (in order), and write them to the video file
+    for (size_t index = 0; index < video_frames.size(); index++) {
+        if (converted[index]) {
+            // Write frame to video file
+            bool success = write_video_packet(video_frames[index], av_frame_pool[index]);
+            if (!success)
+                has_error_encoding_video = true;
         }
-
-        // Remove front item
-        deallocate_frames.pop_front();
     }
 
     // Done writing
@@ -1035,7 +1017,7 @@ void FFmpegWriter::Close() {
 		close_audio(oc, audio_st);
 
 	// Deallocate image scalers
-	if (image_rescalers.size() > 0)
+	if (image_rescalers.size() > 0 || av_frame_pool.size() > 0)
 		RemoveScalers();
 
 	if (!(oc->oformat->flags & AVFMT_NOFILE)) {
@@ -1060,15 +1042,25 @@ void FFmpegWriter::Close() {
 	ZmqLogger::Instance()->AppendDebugMethod("FFmpegWriter::Close");
 }
 
-// Add an AVFrame to the cache
-void FFmpegWriter::add_avframe(std::shared_ptr<Frame> frame, AVFrame *av_frame) {
-	// Add AVFrame to map (if it does not already exist)
-	if (!av_frames.count(frame)) {
-		// Add av_frame
-		av_frames[frame] = av_frame;
-	} else {
-		// Do not add, and deallocate this AVFrame
-		AV_FREE_FRAME(&av_frame);
+// Allocate (converted) AVFrames, until the pool has this many
+void FFmpegWriter::allocate_avframe_pool(size_t size) {
+	int bytes_final = 0;
+	while (av_frame_pool.size() < size) {
+#if IS_FFMPEG_3_2
+#if USE_HW_ACCEL
+		if (hw_en_on && hw_en_supported) {
+			av_frame_pool.push_back(allocate_avframe(AV_PIX_FMT_NV12, info.width, info.height, &bytes_final, NULL));
+		} else
+#endif // USE_HW_ACCEL
+		{
+			av_frame_pool.push_back(allocate_avframe(
+				(AVPixelFormat)(video_st->codecpar->format),
+				info.width, info.height, &bytes_final, NULL
+			));
+		}
+#else
+		av_frame_pool.push_back(allocate_avframe(video_codec_ctx->pix_fmt, info.width, info.height, &bytes_final, NULL));
+#endif // IS_FFMPEG_3_2
 	}
 }
 
@@ -2055,71 +2047,31 @@ AVFrame *FFmpegWriter::allocate_avframe(PixelFormat pix_fmt, int width, int heig
 	return new_av_frame;
 }
 
-// process video frame
-void FFmpegWriter::process_video_packet(std::shared_ptr<Frame> frame) {
+// Convert (and resize) the image of a frame (thread safe)
+bool FFmpegWriter::process_video_packet(std::shared_ptr<Frame> frame, SwsContext *scaler, AVFrame *frame_final) {
     // Determine the height & width of the source image
     int source_image_width = frame->GetWidth();
     int source_image_height = frame->GetHeight();
 
     // Do nothing if size is 1x1 (i.e. no image in this frame)
     if (source_image_height == 1 && source_image_width == 1)
-        return;
-
-    // Init rescalers (if not initialized yet)
-    if (image_rescalers.size() == 0)
-        InitScalers(source_image_width, source_image_height);
-
-    // Get a unique rescaler (for this thread)
-    SwsContext *scaler = image_rescalers[rescaler_position];
-    rescaler_position++;
-    if (rescaler_position == num_of_rescalers)
-        rescaler_position = 0;
+        return false;
 
-    // Allocate an RGB frame & final output frame
-    int bytes_source = 0;
-    int bytes_final = 0;
-    AVFrame *frame_source = NULL;
-    const uchar *pixels = NULL;
+    // Point at the pixels of the source image (no copy needed)
+    std::shared_ptr<QImage> source_image = frame->GetImage();
+    const uint8_t *source_data[4] = { (const uint8_t *) source_image->constBits(), NULL, NULL, NULL };
+    const int source_linesize[4] = { (int) source_image->bytesPerLine(), 0, 0, 0 };
 
-    // Get a list of pixels from source image
-    pixels = frame->GetPixels();
-
-    // Init AVFrame for source image & final (converted image)
-    frame_source = allocate_avframe(PIX_FMT_RGBA, source_image_width, source_image_height, &bytes_source, (uint8_t *) pixels);
-#if IS_FFMPEG_3_2
-    AVFrame *frame_final;
-#if USE_HW_ACCEL
-    if (hw_en_on && hw_en_supported) {
-        frame_final = allocate_avframe(AV_PIX_FMT_NV12, info.width, info.height, &bytes_final, NULL);
-    } else
-#endif // USE_HW_ACCEL
-    {
-        frame_final = allocate_avframe(
-            (AVPixelFormat)(video_st->codecpar->format),
-            info.width, info.height, &bytes_final, NULL
-        );
-    }
-#else
-    AVFrame *frame_final = allocate_avframe(video_codec_ctx->pix_fmt, info.width, info.height, &bytes_final, NULL);
-#endif // IS_FFMPEG_3_2
-
-    // Fill with data
-    AV_COPY_PICTURE_DATA(frame_source, (uint8_t *) pixels, PIX_FMT_RGBA, source_image_width, source_image_height);
     ZmqLogger::Instance()->AppendDebugMethod(
         "FFmpegWriter::process_video_packet",
         "frame->number", frame->number,
-        "bytes_source", bytes_source,
-        "bytes_final", bytes_final);
+        "source_image_width", source_image_width,
+        "source_image_height", source_image_height);
 
     // Resize & convert pixel format
-    sws_scale(scaler, frame_source->data, frame_source->linesize, 0,
+    sws_scale(scaler, source_data, source_linesize, 0,
               source_image_height, frame_final->data, frame_final->linesize);
-
-    // Add resized AVFrame to av_frames map
-    add_avframe(frame, frame_final);
-
-    // Deallocate memory
-    AV_FREE_FRAME(&frame_source);
+    return true;
 }
 
 // write video frame
@@ -2151,9 +2103,11 @@ bool FFmpegWriter::write_video_packet(std::shared_ptr<Frame> frame, AVFrame *fra
 		av_init_packet(pkt);
 #endif
 
-    av_packet_from_data(
-			pkt, frame_final->data[0],
-			frame_final->linesize[0] * frame_final->height);
+		// Copy the image (the AVFrame is reused for later frames)
+		int raw_size = frame_final->linesize[0] * frame_final->height;
+		if (av_new_packet(pkt, raw_size) < 0)
+			return false;
+		memcpy(pkt->data, frame_final->data[0], raw_size);
 
 		pkt->flags |= AV_PKT_FLAG_KEY;
 		pkt->stream_index = video_st->index;
@@ -2339,12 +2293,19 @@ void FFmpegWriter::ResampleAudio(int sample_rate, int channels) {
 	original_channels = channels;
 }
 
-// Remove & deallocate all software scalers
+// Remove & deallocate all software scalers (and converted AVFrames)
 void FFmpegWriter::RemoveScalers() {
 	// Close all rescalers
-	for (int x = 0; x < num_of_rescalers; x++)
-		sws_freeContext(image_rescalers[x]);
+	for (SwsContext *rescaler : image_rescalers)
+		sws_freeContext(rescaler);
 
 	// Clear vector
 	image_rescalers.clear();
+
+	// Deallocate buffers and AVFrames
+	for (AVFrame *av_frame : av_frame_pool) {
+		av_freep(&(av_frame->data[0]));
+		AV_FREE_FRAME(&av_frame);
+	}
+	av_frame_pool.clear();
 }
@@ -136,7 +136,6 @@ namespace openshot {
 		uint8_t *audio_encoder_buffer;
 
 		int num_of_rescalers;
-		int rescaler_position;
 		std::vector<SwsContext *> image_rescalers;
 
 		int audio_outbuf_size;
@@ -158,13 +157,10 @@ namespace openshot {
 		std::deque<std::shared_ptr<openshot::Frame> > queued_audio_frames;
 		std::deque<std::shared_ptr<openshot::Frame> > queued_video_frames;
 
-		std::deque<std::shared_ptr<openshot::Frame> > processed_frames;
-		std::deque<std::shared_ptr<openshot::Frame> > deallocate_frames;
+		std::vector<AVFrame *> av_frame_pool; ///< Converted (final) images, reused for each queue of frames
 
-		std::map<std::shared_ptr<openshot::Frame>, AVFrame *> av_frames;
-
-		/// Add an AVFrame to the cache
-		void add_avframe(std::shared_ptr<openshot::Frame> frame, AVFrame *av_frame);
+		/// Allocate (converted) AVFrames, until the pool has this many
+		void allocate_avframe_pool(size_t size);
 
 		/// Add an audio output stream
 		AVStream *add_audio_stream();
@@ -201,8 +197,12 @@ namespace openshot {
 		/// open video codec
 		void open_video(AVFormatContext *oc, AVStream *st);
 
-		/// process video frame
-		void process_video_packet(std::shared_ptr<openshot::Frame> frame);
+		/// @brief Convert (and resize) the image of a frame (thread safe)
+		/// @param frame The frame to convert
+		/// @param scaler The software scaler to use (one per thread)
+		/// @param frame_final The AVFrame for the converted image (from the pool)
+		/// @returns False if the frame has no image (i.e. 1x1)
+		bool process_video_packet(std::shared_ptr<openshot::Frame> frame, SwsContext *scaler, AVFrame *frame_final);
 
 		/// write all queued frames' audio to the video file
 		void write_audio_packets(bool is_final);
@@ -243,7 +243,7 @@ namespace openshot {
 		/// by the Open() method if this method has not yet been called.
 		void PrepareStreams();
 
-		/// Remove & deallocate all software scalers
+		/// Remove & deallocate all software scalers (and converted AVFrames)
 		void RemoveScalers();
 
 		/// @brief Set audio resample options
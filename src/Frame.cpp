@@ -18,6 +18,7 @@
 #include "Frame.h"
 #include "AudioBufferSource.h"
 #include "AudioResampler.h"
+#include "BufferPool.h"
 #include "QtUtilities.h"
 
 #include <AppConfig.h>
@@ -43,7 +44,7 @@ using namespace openshot;
 
 // Constructor - image & audio
 Frame::Frame(int64_t number, int width, int height, std::string color, int samples, int channels)
-	: audio(std::make_shared<juce::AudioBuffer<float>>(channels, samples)),
+	: audio(BufferPool::Instance()->GetAudioBuffer(channels, samples)),
 	  number(number), width(width), height(height),
 	  pixel_ratio(1,1), color(color),
 	  channels(channels), channel_layout(LAYOUT_STEREO),
@@ -737,9 +738,9 @@ void Frame::AddColor(int new_width, int new_height, std::string new_color)
 // Add (or replace) pixel data to the frame (based on a solid color)
 void Frame::AddColor(const QColor& new_color)
 {
-	// Create new image object, and fill with pixel data
+	// Create new image object (reusing a pooled buffer), and fill with pixel data
 	const std::lock_guard<std::recursive_mutex> lock(addingImageMutex);
-	image = std::make_shared<QImage>(width, height, QImage::Format_RGBA8888_Premultiplied);
+	image = BufferPool::Instance()->GetImage(width, height, QImage::Format_RGBA8888_Premultiplied);
 
 	// Fill with solid color
 	image->fill(new_color);
@@ -880,13 +881,79 @@ void Frame::AddAudio(bool replaceSamples, int destChannel, int destStartSample,
 		max_audio_sample = new_length;
 }
 
+// Make room for audio samples (of each channel), which are written directly into the audio buffer
+void Frame::ReserveAudio(int channels, int destStartSample, int numSamples)
+{
+	const std::lock_guard<std::recursive_mutex> lock(addingAudioMutex);
+
+	// Clamp starting sample to 0
+	int destStartSampleAdjusted = max(destStartSample, 0);
+
+	// Extend audio container to hold more samples and channels.. if needed
+	int new_length = destStartSampleAdjusted + numSamples;
+	int new_channel_length = std::max(channels, audio->getNumChannels());
+	if (new_length > audio->getNumSamples() || new_channel_length > audio->getNumChannels())
+		audio->setSize(new_channel_length, new_length, true, true, false);
+	has_audio_data = true;
+
+	// Calculate max audio sample added
+	if (new_length > max_audio_sample)
+		max_audio_sample = new_length;
+}
+
+// Add (mix) audio samples to a specific channel, with a gain ramp (i.e. fading volume)
+void Frame::AddAudioWithRamp(int destChannel, int destStartSample, const float* source, int numSamples, float initial_gain, float final_gain)
+{
+	const std::lock_guard<std::recursive_mutex> lock(addingAudioMutex);
+
+	// Clamp starting sample to 0
+	int destStartSampleAdjusted = max(destStartSample, 0);
+
+	// Extend audio container to hold more samples and channels.. if needed
+	int new_length = destStartSampleAdjusted + numSamples;
+	int new_channel_length = audio->getNumChannels();
+	if (destChannel >= new_channel_length)
+		new_channel_length = destChannel + 1;
+	if (new_length > audio->getNumSamples() || new_channel_length > audio->getNumChannels())
+		audio->setSize(new_channel_length, new_length, true, true, false);
+
+	float* dest = audio->getWritePointer(destChannel, destStartSampleAdjusted);
+	if (initial_gain == final_gain) {
+		// Constant gain (already vectorized by JUCE)
+		juce::FloatVectorOperations::addWithMultiply(dest, source, initial_gain, numSamples);
+	} else {
+		// Mix and ramp in a single pass (the same ramp as juce::AudioBuffer::applyGainRamp)
+		const float increment = (final_gain - initial_gain) / numSamples;
+		#pragma omp simd
+		for (int sample = 0; sample < numSamples; ++sample)
+			dest[sample] += source[sample] * (initial_gain + increment * sample);
+	}
+	has_audio_data = true;
+
+	// Calculate max audio sample added
+	if (new_length > max_audio_sample)
+		max_audio_sample = new_length;
+}
+
 // Apply gain ramp (i.e. fading volume)
 void Frame::ApplyGainRamp(int destChannel, int destStartSample, int numSamples, float initial_gain = 0.0f, float final_gain = 1.0f)
 {
     const std::lock_guard<std::recursive_mutex> lock(addingAudioMutex);
 
-    // Apply gain ramp
-	audio->applyGainRamp(destChannel, destStartSample, numSamples, initial_gain, final_gain);
+	if (numSamples <= 0)
+		return;
+
+	float* samples = audio->getWritePointer(destChannel, destStartSample);
+	if (initial_gain == final_gain) {
+		// Constant gain (already vectorized by JUCE)
+		juce::FloatVectorOperations::multiply(samples, initial_gain, numSamples);
+	} else {
+		// Apply gain ramp (the same ramp as juce::AudioBuffer::applyGainRamp, in a vectorized loop)
+		const float increment = (final_gain - initial_gain) / numSamples;
+		#pragma omp simd
+		for (int sample = 0; sample < numSamples; ++sample)
+			samples[sample] *= initial_gain + increment * sample;
+	}
 }
 
 // Get pointer to Magick++ image object
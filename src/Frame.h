@@ -158,6 +158,25 @@ namespace openshot
 		/// Add audio samples to a specific channel
 		void AddAudio(bool replaceSamples, int destChannel, int destStartSample, const float* source, int numSamples, float gainToApplyToSource);
 
+		/// @brief Make room for audio samples (of each channel), which are written directly into the audio buffer
+		/// (i.e. by a decoder, without copying them from another buffer). The samples are replaced, not mixed.
+		/// @param channels The number of channels
+		/// @param destStartSample The first sample
+		/// @param numSamples The number of samples
+		void ReserveAudio(int channels, int destStartSample, int numSamples);
+
+		/// @brief Add (mix) audio samples to a specific channel, with a gain ramp (i.e. fading volume)
+		///
+		/// The source samples are not changed, so this replaces calling ApplyGainRamp() on a source frame
+		/// and then AddAudio() with its samples.
+		/// @param destChannel The channel to mix the samples into
+		/// @param destStartSample The first sample (in this frame) to mix the samples into
+		/// @param source The samples to mix into this frame
+		/// @param numSamples The number of samples to mix
+		/// @param initial_gain The gain of the first sample
+		/// @param final_gain The gain after the last sample
+		void AddAudioWithRamp(int destChannel, int destStartSample, const float* source, int numSamples, float initial_gain, float final_gain);
+
 		/// Add audio silence
 		void AddAudioSilence(int numSamples);
 
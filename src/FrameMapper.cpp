@@ -498,19 +498,21 @@ std::shared_ptr<Frame> FrameMapper::GetFrame(int64_t requested_frame)
 		frame->ChannelsLayout(mapped_frame->ChannelsLayout());
 
 
-		// Copy the image from the odd field
-		std::shared_ptr<Frame> odd_frame;
-		odd_frame = GetOrCreateFrame(mapped.Odd.Frame);
-
-		if (odd_frame)
-			frame->AddImage(std::make_shared<QImage>(*odd_frame->GetImage()), true);
-		if (mapped.Odd.Frame != mapped.Even.Frame) {
-			// Add even lines (if different than the previous image)
-			std::shared_ptr<Frame> even_frame;
-			even_frame = GetOrCreateFrame(mapped.Even.Frame);
-			if (even_frame)
-				frame->AddImage(
-					std::make_shared<QImage>(*even_frame->GetImage()), false);
+		// Copy the image from the odd field (unless the reader has no video, or is not decoding it)
+		if (reader->info.has_video) {
+			std::shared_ptr<Frame> odd_frame;
+			odd_frame = GetOrCreateFrame(mapped.Odd.Frame);
+
+			if (odd_frame)
+				frame->AddImage(std::make_shared<QImage>(*odd_frame->GetImage()), true);
+			if (mapped.Odd.Frame != mapped.Even.Frame) {
+				// Add even lines (if different than the previous image)
+				std::shared_ptr<Frame> even_frame;
+				even_frame = GetOrCreateFrame(mapped.Even.Frame);
+				if (even_frame)
+					frame->AddImage(
+						std::make_shared<QImage>(*even_frame->GetImage()), false);
+			}
 		}
 
 		// Resample audio on frame (if needed)
@@ -13,6 +13,13 @@
 //Require ImageMagick support
 #ifdef USE_IMAGEMAGICK
 
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <regex>
+
 #include "MagickUtilities.h"
 #include "QtUtilities.h"
 
@@ -24,6 +31,9 @@
 
 using namespace openshot;
 
+// A "%d" (such as "%04d") in the path of an image sequence, which is formatted with the index of each image
+static const std::regex sequence_index_format("%[0-9]*d");
+
 ImageWriter::ImageWriter(std::string path) :
 		path(path), cache_size(8), write_video_count(0), image_quality(75), number_of_loops(1),
 		combine_frames(true), is_open(false)
@@ -91,30 +101,224 @@ void ImageWriter::WriteFrame(std::shared_ptr<Frame> frame)
 			"Call Open() before calling this method.", path);
 	}
 
-	// Copy and resize image
-	auto qimage = frame->GetImage();
-	auto frame_image = openshot::QImage2Magick(qimage);
-	frame_image->magick( info.vcodec );
-	frame_image->backgroundColor(Magick::Color("none"));
-	MAGICK_IMAGE_ALPHA(frame_image, true);
-	frame_image->quality(image_quality);
-	frame_image->animationDelay(info.video_timebase.ToFloat() * 100);
-	frame_image->animationIterations(number_of_loops);
+	// Queue frame (waiting to be written)
+	queued_frames.push_back(frame);
+
+	// Keep track of the last frame added
+	last_frame = frame;
+
+	// Write the queue (once it is full)
+	if ((int)queued_frames.size() >= std::max(1, cache_size))
+		write_queued_frames();
+}
+
+// Convert and resize the queued frames (in parallel), and write them (if not combining frames)
+void ImageWriter::write_queued_frames()
+{
+	if (queued_frames.empty())
+		return;
 
-	// Calculate correct DAR (display aspect ratio)
-	int new_height = info.height * frame->GetPixelRatio().Reciprocal().ToDouble();
+	ZmqLogger::Instance()->AppendDebugMethod(
+		"ImageWriter::write_queued_frames",
+		"queued_frames.size()", queued_frames.size(),
+		"write_video_count", write_video_count,
+		"combine_frames", combine_frames);
 
-	// Resize image
-	Magick::Geometry new_size(info.width, new_height);
-	new_size.aspect(true);
-	frame_image->resize(new_size);
+	bool write_gif = is_gif();
+	std::vector<Magick::Image> images(queued_frames.size());
+	std::vector<Magick::Blob> gif_images(write_gif ? queued_frames.size() : 0);
+	std::vector<std::exception_ptr> errors(queued_frames.size());
 
+	#pragma omp parallel for schedule(dynamic)
+	for (int index = 0; index < (int)queued_frames.size(); index++) {
+		try {
+			std::shared_ptr<Frame> frame = queued_frames[index];
 
-	// Put resized frame in vector (waiting to be written)
-	frames.push_back(*frame_image.get());
+			// Copy and resize image
+			auto qimage = frame->GetImage();
+			auto frame_image = openshot::QImage2Magick(qimage);
+			frame_image->magick( info.vcodec );
+			frame_image->backgroundColor(Magick::Color("none"));
+			MAGICK_IMAGE_ALPHA(frame_image, true);
+			frame_image->quality(image_quality);
+			frame_image->animationDelay(info.video_timebase.ToFloat() * 100);
+			frame_image->animationIterations(number_of_loops);
 
-	// Keep track of the last frame added
-	last_frame = frame;
+			// Calculate correct DAR (display aspect ratio)
+			int new_height = info.height * frame->GetPixelRatio().Reciprocal().ToDouble();
+
+			// Resize image
+			Magick::Geometry new_size(info.width, new_height);
+			new_size.aspect(true);
+			frame_image->resize(new_size);
+
+			if (write_gif)
+				// Encode each image of an animated GIF (appended to the file in order)
+				frame_image->write(&gif_images[index]);
+			else if (combine_frames)
+				// Keep resized frame (waiting to be written on close)
+				images[index] = *frame_image.get();
+			else
+				// Write each image of a sequence
+				frame_image->write(get_sequence_path(write_video_count + index));
+
+		} catch (...) {
+			// Exceptions can't leave the parallel loop
+			errors[index] = std::current_exception();
+		}
+	}
+
+	write_video_count += queued_frames.size();
+	queued_frames.clear();
+
+	// Throw the first error (if any)
+	for (const auto& error : errors)
+		if (error)
+			std::rethrow_exception(error);
+
+	// Append the images to the animated GIF, or put resized frames in vector (in order)
+	if (write_gif) {
+		for (const auto& gif_image : gif_images)
+			write_gif_frame(gif_image);
+	} else if (combine_frames) {
+		frames.insert(frames.end(), images.begin(), images.end());
+	}
+}
+
+// Are combined frames written as an animated GIF (one batch at a time)
+bool ImageWriter::is_gif()
+{
+	std::string format = info.vcodec;
+	std::transform(format.begin(), format.end(), format.begin(), ::toupper);
+	return combine_frames && format == "GIF";
+}
+
+// Append an image (encoded as a single-frame GIF) to the animated GIF
+void ImageWriter::write_gif_frame(const Magick::Blob& blob)
+{
+	const unsigned char* data = (const unsigned char*) blob.data();
+	size_t size = blob.length();
+	size_t position = 0;
+	auto need = [&](size_t bytes) {
+		if (position + bytes > size)
+			throw InvalidFile("Could not encode the GIF image.", path);
+	};
+	auto skip_sub_blocks = [&]() {
+		while (true) {
+			need(1);
+			unsigned char length = data[position++];
+			if (length == 0)
+				break;
+			need(length);
+			position += length;
+		}
+	};
+
+	// Header and logical screen descriptor (and global color table)
+	need(13);
+	if (memcmp(data, "GIF", 3) != 0)
+		throw InvalidFile("Could not encode the GIF image.", path);
+	unsigned char screen_flags = data[10];
+	position = 13;
+	const unsigned char* global_colors = NULL;
+	size_t global_colors_size = 0;
+	if (screen_flags & 0x80) {
+		global_colors_size = 3 << ((screen_flags & 0x07) + 1);
+		need(global_colors_size);
+		global_colors = data + position;
+		position += global_colors_size;
+	}
+
+	if (!gif_file.is_open()) {
+		gif_file.open(path, std::ios::binary | std::ios::trunc);
+		if (!gif_file)
+			throw InvalidFile("Could not open or write file.", path);
+
+		// Header and logical screen (of the first image), without a global color table (since each image
+		// has its own color table)
+		gif_file.write("GIF89a", 6);
+		gif_file.write((const char*) data + 6, 4);
+		const char screen[3] = {char(screen_flags & 0x70), 0, 0};
+		gif_file.write(screen, 3);
+
+		// Number of loops (NETSCAPE2.0 application extension)
+		int loops = std::min(std::max(number_of_loops, 0), 65535);
+		const char loop_extension[19] = {'\x21', '\xFF', 11, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0',
+										 3, 1, char(loops & 0xFF), char((loops >> 8) & 0xFF), 0};
+		gif_file.write(loop_extension, 19);
+	}
+
+	// Copy the graphic control extension (delay and transparency) and the image, with the global
+	// color table as its local color table
+	while (position < size) {
+		size_t start = position;
+		unsigned char block = data[position];
+		if (block == 0x21) {
+			// Extension (only the graphic control extension is kept)
+			need(2);
+			bool is_control = data[position + 1] == 0xF9;
+			position += 2;
+			skip_sub_blocks();
+			if (is_control)
+				gif_file.write((const char*) data + start, position - start);
+
+		} else if (block == 0x2C) {
+			// Image descriptor (and local color table)
+			need(10);
+			char descriptor[10];
+			memcpy(descriptor, data + position, 10);
+			position += 10;
+			unsigned char image_flags = data[start + 9];
+			if (image_flags & 0x80) {
+				size_t local_colors_size = 3 << ((image_flags & 0x07) + 1);
+				need(local_colors_size);
+				position += local_colors_size;
+				gif_file.write((const char*) data + start, position - start);
+			} else {
+				if (global_colors)
+					descriptor[9] = char((image_flags & 0x40) | 0x80 | (screen_flags & 0x07));
+				gif_file.write(descriptor, 10);
+				if (global_colors)
+					gif_file.write((const char*) global_colors, global_colors_size);
+			}
+
+			// Image data (LZW code size, and data sub-blocks)
+			start = position;
+			need(1);
+			position++;
+			skip_sub_blocks();
+			gif_file.write((const char*) data + start, position - start);
+
+		} else if (block == 0x3B) {
+			// Trailer (written on close)
+			break;
+		} else {
+			throw InvalidFile("Could not encode the GIF image.", path);
+		}
+	}
+
+	if (!gif_file)
+		throw InvalidFile("Could not write the GIF image.", path);
+}
+
+// Get the path of an image in an image sequence
+std::string ImageWriter::get_sequence_path(int64_t index)
+{
+	// Format a "%d" (such as "%04d") in the path with the index
+	std::smatch match;
+	if (std::regex_search(path, match, sequence_index_format)) {
+		char formatted_index[32];
+		snprintf(formatted_index, sizeof(formatted_index), match.str().c_str(), (int)index);
+		return match.prefix().str() + formatted_index + match.suffix().str();
+	}
+
+	// Otherwise append the index to the file name (before the extension)
+	size_t extension_position = path.find_last_of('.');
+	size_t separator_position = path.find_last_of("/\\");
+	if (extension_position == std::string::npos ||
+		(separator_position != std::string::npos && extension_position < separator_position))
+		return path + "-" + std::to_string(index);
+	return path.substr(0, extension_position) + "-" + std::to_string(index) + path.substr(extension_position);
 }
 
 // Write a block of frames from a reader
@@ -139,11 +343,24 @@ void ImageWriter::WriteFrame(ReaderBase* reader, int64_t start, int64_t length)
 // Close the writer and encode/output final image to the disk.
 void ImageWriter::Close()
 {
-	// Write frame images to file
-	Magick::writeImages(frames.begin(), frames.end(), path, combine_frames);
+	// Write the remaining queued frames
+	write_queued_frames();
+
+	if (gif_file.is_open()) {
+		// End the animated GIF (trailer)
+		gif_file.put('\x3B');
+		gif_file.close();
+	} else if (combine_frames && !is_gif()) {
+		// Write frame images to file
+		Magick::writeImages(frames.begin(), frames.end(), path, combine_frames);
+	} else if (write_video_count == 1 && !std::regex_search(path, sequence_index_format)) {
+		// A single image is not numbered (just like ImageMagick names it)
+		std::rename(get_sequence_path(0).c_str(), path.c_str());
+	}
 
 	// Clear frames vector & counters, close writer
 	frames.clear();
+	queued_frames.clear();
 	write_video_count = 0;
 	is_open = false;
 
@@ -15,6 +15,8 @@
 
 #ifdef USE_IMAGEMAGICK
 
+#include <fstream>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -34,6 +36,17 @@ namespace openshot
 	 *
 	 * All image formats supported by ImageMagick are supported by this class.
 	 *
+	 * Frames are queued (see SetCacheSize()) and each batch is converted and resized in parallel. When
+	 * frames are not combined, each batch is written to disk right away (as an image sequence), so the
+	 * memory used does not depend on the number of frames. Image sequences are named like ImageMagick
+	 * names them: a path with a "%d" (such as "frame-%04d.png") is formatted with the frame index (starting
+	 * at 0), otherwise the index is appended to the file name (such as "frame-0.png").
+	 *
+	 * Animated GIFs are also written one batch at a time: each frame is encoded (in parallel) as a single
+	 * GIF image, which is appended to the file (with its own color table). Other combined formats (such as
+	 * a multi-page TIFF) are written by ImageMagick when the writer is closed, so their frames are kept in
+	 * memory until then.
+	 *
 	 * @code
 	 * // Create a reader for a video
 	 * FFmpegReader r("MyAwesomeVideo.webm");
@@ -64,20 +77,35 @@ namespace openshot
 		bool is_open;
 		int64_t write_video_count;
 		std::vector<Magick::Image> frames;
+		std::ofstream gif_file; ///< The animated GIF (written incrementally)
+		std::vector<std::shared_ptr<Frame>> queued_frames;
 		int image_quality;
 		int number_of_loops;
 		bool combine_frames;
 
 		std::shared_ptr<Frame> last_frame;
 
+		/// Convert and resize the queued frames (in parallel), and write them (if not combining frames)
+		void write_queued_frames();
+
+		/// Get the path of an image in an image sequence
+		std::string get_sequence_path(int64_t index);
+
+		/// Are combined frames written as an animated GIF (one batch at a time)
+		bool is_gif();
+
+		/// Append an image (encoded as a single-frame GIF) to the animated GIF
+		void write_gif_frame(const Magick::Blob& blob);
+
 	public:
 
 		/// @brief Constructor for ImageWriter. Throws one of the following exceptions.
 		/// @param path The path of the file you want to create
 		ImageWriter(std::string path);
 
-		/// @brief Close the writer and encode/output final image to the disk. This is a requirement of ImageMagick,
-		/// which writes all frames of a multi-frame image at one time.
+		/// @brief Close the writer and encode/output final image to the disk. Combined frames (except animated
+		/// GIFs) are written here, which is a requirement of ImageMagick (which writes all frames of a multi-frame
+		/// image at one time).
 		void Close();
 
 		/// @brief Get the cache size
@@ -105,7 +133,7 @@ namespace openshot
 			std::string format, Fraction fps, int width, int height,
 			int quality, int loops, bool combine);
 
-		/// @brief Add a frame to the stack waiting to be encoded.
+		/// @brief Add a frame to the queue waiting to be encoded (which is encoded once the queue is full).
 		/// @param frame The openshot::Frame object to write to this image
 		void WriteFrame(std::shared_ptr<Frame> frame);
 
@@ -13,6 +13,9 @@
 #include "Json.h"
 #include "Exceptions.h"
 
+#include <algorithm>
+#include <cmath>
+
 const Json::Value openshot::stringToJson(const std::string value) {
 
 	// Parse JSON string into JSON objects
@@ -31,3 +34,42 @@ const Json::Value openshot::stringToJson(const std::string value) {
 
 	return root;
 }
+
+bool openshot::jsonIsUnchanged(const Json::Value& current, const Json::Value& incoming) {
+
+	// Compare objects key by key (ignoring keys which are not part of the current state)
+	if (current.isObject()) {
+		if (!incoming.isObject())
+			return false;
+		for (const auto& name : current.getMemberNames()) {
+			if (incoming.isMember(name) && !jsonIsUnchanged(current[name], incoming[name]))
+				return false;
+		}
+		return true;
+	}
+
+	// Compare arrays item by item
+	if (current.isArray()) {
+		if (!incoming.isArray() || current.size() != incoming.size())
+			return false;
+		for (Json::ArrayIndex index = 0; index < current.size(); index++) {
+			if (!jsonIsUnchanged(current[index], incoming[index]))
+				return false;
+		}
+		return true;
+	}
+
+	// Compare numbers with a relative tolerance (float properties round-trip through double)
+	if (current.isNumeric() && incoming.isNumeric() && !current.isBool() && !incoming.isBool()) {
+		double a = current.asDouble();
+		double b = incoming.asDouble();
+		double scale = std::max(1.0, std::max(std::fabs(a), std::fabs(b)));
+		return std::fabs(a - b) <= 0.000001 * scale;
+	}
+
+	// Compare remaining values by their string representation (i.e. "1" == 1, true == true)
+	if (current.isConvertibleTo(Json::stringValue) && incoming.isConvertibleTo(Json::stringValue))
+		return current.asString() == incoming.asString();
+
+	return current == incoming;
+}
@@ -19,6 +19,11 @@
 
 namespace openshot {
     const Json::Value stringToJson(const std::string value);
+
+    /// Determine if applying an incoming Json::Value would leave an object's current Json::Value unchanged.
+    /// Only keys present in both values are compared (keys the object does not serialize are ignored), and
+    /// numbers are compared with a small tolerance, since most properties are stored as float.
+    bool jsonIsUnchanged(const Json::Value& current, const Json::Value& incoming);
 }
 
 #endif
@@ -32,6 +32,14 @@ namespace openshot{
 		return p.co.X < x;
 	}
 
+	// Check if two Points would result in the same curve (coordinate, handles, and interpolation)
+	bool IsSamePoint(Point const & a, Point const & b) {
+		return a.co.X == b.co.X && a.co.Y == b.co.Y &&
+			a.handle_left.X == b.handle_left.X && a.handle_left.Y == b.handle_left.Y &&
+			a.handle_right.X == b.handle_right.X && a.handle_right.Y == b.handle_right.Y &&
+			a.interpolation == b.interpolation;
+	}
+
 	// Linear interpolation between two points
 	double InterpolateLinearCurve(Point const & left, Point const & right, double const target) {
 		double const diff_Y = right.co.Y - left.co.Y;
@@ -278,6 +286,43 @@ double Keyframe::GetValue(int64_t index) const {
 	return InterpolateBetween(*predecessor, *candidate, index, 0.01);
 }
 
+// Get the range of indexes (between min_index and max_index) where the value differs from another Keyframe
+bool Keyframe::GetChangedRange(const Keyframe& other, int64_t min_index, int64_t max_index, int64_t& first_index, int64_t& last_index) const {
+	// Skip the leading and trailing points which are identical in both curves
+	size_t const count = std::min(Points.size(), other.Points.size());
+	size_t leading = 0;
+	while (leading < count && IsSamePoint(Points[leading], other.Points[leading]))
+		leading++;
+	if (leading == count && Points.size() == other.Points.size())
+		return false; // Identical curves
+
+	size_t trailing = 0;
+	while (trailing < count - leading &&
+		   IsSamePoint(Points[Points.size() - 1 - trailing], other.Points[other.Points.size() - 1 - trailing]))
+		trailing++;
+
+	// Only the segments between the last identical leading point and the first
+	// identical trailing point can be different (the rest is interpolated from identical points)
+	int64_t start = min_index;
+	int64_t end = max_index;
+	if (leading > 0)
+		start = std::max(start, static_cast<int64_t>(std::floor(Points[leading - 1].co.X)));
+	if (trailing > 0)
+		end = std::min(end, static_cast<int64_t>(std::ceil(Points[Points.size() - trailing].co.X)));
+
+	// Narrow the range down to the indexes whose value actually changed
+	while (start <= end && GetValue(start) == other.GetValue(start))
+		start++;
+	while (end >= start && GetValue(end) == other.GetValue(end))
+		end--;
+	if (start > end)
+		return false;
+
+	first_index = start;
+	last_index = end;
+	return true;
+}
+
 // Get the rounded INT value at a specific index
 int Keyframe::GetInt(int64_t index) const {
 	return int(round(GetValue(index)));
@@ -88,6 +88,10 @@ namespace openshot {
 		/// Get the value at a specific index
 		double GetValue(int64_t index) const;
 
+		/// Get the range of indexes (between min_index and max_index) where the value differs from another Keyframe.
+		/// Returns false if no index in that range has a different value.
+		bool GetChangedRange(const Keyframe& other, int64_t min_index, int64_t max_index, int64_t& first_index, int64_t& last_index) const;
+
 		/// Get the rounded INT value at a specific index
 		int GetInt(int64_t index) const;
 
@@ -106,6 +106,7 @@
 #include "AudioBufferSource.h"
 #include "AudioReaderSource.h"
 #include "AudioResampler.h"
+#include "CacheContent.h"
 #include "CacheDisk.h"
 #include "CacheMemory.h"
 #include "ChunkReader.h"
@@ -0,0 +1,232 @@
+/**
+ * @file
+ * @brief Source file for Profiler class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <chrono>
+#include <cstdlib>        // For std::getenv
+#include <fstream>
+#include <sstream>
+
+#include "Profiler.h"
+#include "ClipBase.h"
+#include "Exceptions.h"
+
+using namespace openshot;
+
+// Global reference to the profiler
+Profiler *Profiler::m_pInstance = nullptr;
+
+// Create or Get an instance of the profiler singleton
+Profiler *Profiler::Instance()
+{
+	if (!m_pInstance) {
+		// Create the actual instance of the profiler only once
+		m_pInstance = new Profiler;
+		auto env_profile = std::getenv("LIBOPENSHOT_PROFILE");
+		if (env_profile != nullptr)
+			m_pInstance->Enable(true, std::string(env_profile) == "trace");
+	}
+
+	return m_pInstance;
+}
+
+// Default constructor
+Profiler::Profiler() : enabled(false), tracing(false) { }
+
+// Enable or disable profiling
+void Profiler::Enable(bool enable, bool trace)
+{
+	enabled = enable;
+	tracing = enable && trace;
+}
+
+// Current time (in microseconds, from a steady clock)
+int64_t Profiler::Now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Add a timing
+void Profiler::AddTiming(const char* category, const std::string& name, int64_t start, int64_t duration)
+{
+	if (!IsEnabled())
+		return;
+
+	// Histogram bucket (bucket N counts timings below 2^N microseconds)
+	int bucket = 0;
+	while (bucket < HISTOGRAM_BUCKETS - 1 && (int64_t(1) << bucket) <= duration)
+		bucket++;
+
+	const std::lock_guard<std::mutex> lock(profilerMutex);
+
+	Timer& timer = timers[std::make_pair(std::string(category), name)];
+	if (timer.count == 0 || duration < timer.min)
+		timer.min = duration;
+	if (duration > timer.max)
+		timer.max = duration;
+	timer.count++;
+	timer.total += duration;
+	if (timer.histogram.empty())
+		timer.histogram.resize(HISTOGRAM_BUCKETS, 0);
+	timer.histogram[bucket]++;
+
+	if (tracing && events.size() < MAX_TRACE_EVENTS) {
+		// Number threads in the order they are first seen
+		auto thread = threads.emplace(std::this_thread::get_id(), int(threads.size()) + 1).first;
+		events.push_back({category, name, start, duration, thread->second});
+	}
+}
+
+// Increment a counter
+void Profiler::Count(const char* category, const std::string& name)
+{
+	if (!IsEnabled())
+		return;
+
+	const std::lock_guard<std::mutex> lock(profilerMutex);
+	counters[std::make_pair(std::string(category), name)]++;
+}
+
+// Increment a counter (without building a name string when profiling is disabled)
+void Profiler::Count(const char* category, const char* name)
+{
+	if (!IsEnabled())
+		return;
+
+	Count(category, std::string(name));
+}
+
+// Remove all timings, counters and trace events
+void Profiler::Reset()
+{
+	const std::lock_guard<std::mutex> lock(profilerMutex);
+	timers.clear();
+	counters.clear();
+	events.clear();
+	threads.clear();
+}
+
+// Generate JSON string of the aggregated timings and counters
+std::string Profiler::Json() {
+
+	// Return formatted string
+	return JsonValue().toStyledString();
+}
+
+// Generate Json::Value of the aggregated timings and counters
+Json::Value Profiler::JsonValue() {
+	const std::lock_guard<std::mutex> lock(profilerMutex);
+
+	// Create root json object
+	Json::Value root;
+	root["enabled"] = IsEnabled();
+	root["tracing"] = IsTracing();
+
+	root["timers"] = Json::Value(Json::arrayValue);
+	for (const auto& timer : timers) {
+		Json::Value timer_json;
+		timer_json["category"] = timer.first.first;
+		timer_json["name"] = timer.first.second;
+		timer_json["count"] = Json::Int64(timer.second.count);
+		timer_json["total_ms"] = timer.second.total / 1000.0;
+		timer_json["mean_ms"] = timer.second.total / 1000.0 / timer.second.count;
+		timer_json["min_ms"] = timer.second.min / 1000.0;
+		timer_json["max_ms"] = timer.second.max / 1000.0;
+
+		// Counts by power of 2 microseconds (without the empty buckets at the end)
+		size_t buckets = timer.second.histogram.size();
+		while (buckets > 0 && timer.second.histogram[buckets - 1] == 0)
+			buckets--;
+		timer_json["histogram"] = Json::Value(Json::arrayValue);
+		for (size_t bucket = 0; bucket < buckets; bucket++)
+			timer_json["histogram"].append(Json::Int64(timer.second.histogram[bucket]));
+
+		root["timers"].append(timer_json);
+	}
+
+	root["counters"] = Json::Value(Json::arrayValue);
+	for (const auto& counter : counters) {
+		Json::Value counter_json;
+		counter_json["category"] = counter.first.first;
+		counter_json["name"] = counter.first.second;
+		counter_json["count"] = Json::Int64(counter.second);
+		root["counters"].append(counter_json);
+	}
+
+	// return JsonValue
+	return root;
+}
+
+// Generate JSON string of the trace events (in Chrome trace-event format)
+std::string Profiler::TraceJson() {
+	const std::lock_guard<std::mutex> lock(profilerMutex);
+
+	// Complete ("X") events, with timestamps and durations in microseconds
+	std::ostringstream trace;
+	trace << "{\"traceEvents\":[";
+	for (size_t index = 0; index < events.size(); index++) {
+		const TraceEvent& event = events[index];
+		if (index > 0)
+			trace << ",";
+		trace << "\n{\"name\":" << Json::valueToQuotedString(event.name.c_str())
+			  << ",\"cat\":" << Json::valueToQuotedString(event.category)
+			  << ",\"ph\":\"X\",\"ts\":" << event.start
+			  << ",\"dur\":" << event.duration
+			  << ",\"pid\":1,\"tid\":" << event.thread << "}";
+	}
+	trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	return trace.str();
+}
+
+// Write the trace events to a file (in Chrome trace-event format)
+void Profiler::WriteTrace(std::string path) {
+	std::ofstream trace_file(path, std::ios::out | std::ios::trunc);
+	if (!trace_file)
+		throw InvalidFile("Could not open the trace file.", path);
+
+	trace_file << TraceJson();
+}
+
+// Time a scope
+ProfileScope::ProfileScope(const char* category, const std::string& name) : category(category), start(0)
+{
+	if (Profiler::Instance()->IsEnabled()) {
+		this->name = name;
+		start = Profiler::Now();
+	}
+}
+
+// Time a scope (without building a name string when profiling is disabled)
+ProfileScope::ProfileScope(const char* category, const char* name) : category(category), start(0)
+{
+	if (Profiler::Instance()->IsEnabled()) {
+		this->name = name;
+		start = Profiler::Now();
+	}
+}
+
+// Time a scope of a clip or effect (named by its Id)
+ProfileScope::ProfileScope(const char* category, const openshot::ClipBase* object) : category(category), start(0)
+{
+	if (Profiler::Instance()->IsEnabled()) {
+		name = object->Id();
+		start = Profiler::Now();
+	}
+}
+
+// Add the timing
+ProfileScope::~ProfileScope()
+{
+	if (start > 0)
+		Profiler::Instance()->AddTiming(category, name, start, Profiler::Now() - start);
+}
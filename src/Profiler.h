@@ -0,0 +1,184 @@
+/**
+ * @file
+ * @brief Header file for Profiler class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef OPENSHOT_PROFILER_H
+#define OPENSHOT_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "Json.h"
+
+namespace openshot {
+	class ClipBase;
+
+	/**
+	 * @brief This class collects render-time profiling data (i.e. how long each clip and effect takes)
+	 *
+	 * When enabled, libopenshot times each Timeline::GetFrame, Clip::GetFrame, reader decode, effect,
+	 * and clip composite, and counts cache hits and misses. Timings are aggregated by category and name
+	 * (i.e. the Id of a clip or effect) into histograms, which can be exported as JSON (see Timeline::ProfileJson),
+	 * and (optionally) recorded as trace events, which can be opened with chrome://tracing or Perfetto.
+	 *
+	 * Profiling is disabled by default (and then costs almost nothing). It can also be enabled with
+	 * the LIBOPENSHOT_PROFILE environment variable.
+	 *
+	 * \code
+	 * Profiler::Instance()->Enable(true, true);
+	 * timeline.GetFrame(1);
+	 * std::cout << timeline.ProfileJson() << std::endl;
+	 * Profiler::Instance()->WriteTrace("trace.json");
+	 * \endcode
+	 */
+	class Profiler {
+	private:
+		/// Aggregated timings of a category and name
+		struct Timer {
+			int64_t count = 0;
+			int64_t total = 0; ///< Total microseconds
+			int64_t min = 0; ///< Smallest microseconds
+			int64_t max = 0; ///< Largest microseconds
+			std::vector<int64_t> histogram; ///< Counts by power of 2 microseconds
+		};
+
+		/// A trace event (in microseconds)
+		struct TraceEvent {
+			const char* category;
+			std::string name;
+			int64_t start;
+			int64_t duration;
+			int thread;
+		};
+
+		std::mutex profilerMutex;
+		std::atomic<bool> enabled;
+		std::atomic<bool> tracing;
+		std::map<std::pair<std::string, std::string>, Timer> timers;
+		std::map<std::pair<std::string, std::string>, int64_t> counters;
+		std::vector<TraceEvent> events;
+		std::map<std::thread::id, int> threads; ///< Small thread numbers (for trace events)
+
+		/// Default constructor
+		Profiler(); // Don't allow user to create an instance of this singleton
+
+		/// Default copy method
+		Profiler(Profiler const&) = delete; // Don't allow the user to assign this instance
+
+		/// Default assignment operator
+		Profiler & operator=(Profiler const&) = delete; // Don't allow the user to assign this instance
+
+		/// Private variable to keep track of singleton instance
+		static Profiler * m_pInstance;
+
+	public:
+		/// Number of histogram buckets (bucket N counts timings below 2^N microseconds)
+		static const int HISTOGRAM_BUCKETS = 32;
+
+		/// Max number of trace events to keep (later events are dropped)
+		static const size_t MAX_TRACE_EVENTS = 1000000;
+
+		/// Create or get an instance of this profiler singleton (invoke the class with this method)
+		static Profiler * Instance();
+
+		/// @brief Enable or disable profiling
+		/// @param enable Aggregate timings and counters
+		/// @param trace Also record each timing as a trace event
+		void Enable(bool enable, bool trace=false);
+
+		/// Is profiling enabled
+		bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+		/// Is tracing enabled
+		bool IsTracing() const { return tracing.load(std::memory_order_relaxed); }
+
+		/// Current time (in microseconds, from a steady clock)
+		static int64_t Now();
+
+		/// @brief Add a timing
+		/// @param category The category of the timing (i.e. "clip" or "effect")
+		/// @param name The name of the timing (i.e. the Id of a clip)
+		/// @param start The start time (in microseconds, see Now())
+		/// @param duration The duration (in microseconds)
+		void AddTiming(const char* category, const std::string& name, int64_t start, int64_t duration);
+
+		/// @brief Increment a counter
+		/// @param category The category of the counter (i.e. "cache")
+		/// @param name The name of the counter (i.e. "hit")
+		void Count(const char* category, const std::string& name);
+
+		/// @brief Increment a counter (without building a name string when profiling is disabled)
+		/// @param category The category of the counter (i.e. "cache")
+		/// @param name The name of the counter (i.e. "hit")
+		void Count(const char* category, const char* name);
+
+		/// Remove all timings, counters and trace events
+		void Reset();
+
+		/// Generate JSON string of the aggregated timings and counters
+		std::string Json();
+
+		/// Generate Json::Value of the aggregated timings and counters
+		Json::Value JsonValue();
+
+		/// Generate JSON string of the trace events (in Chrome trace-event format)
+		std::string TraceJson();
+
+		/// @brief Write the trace events to a file (in Chrome trace-event format)
+		/// @param path The path of the trace file
+		void WriteTrace(std::string path);
+	};
+
+	/**
+	 * @brief This class times a scope (and adds the timing to the Profiler, if enabled)
+	 *
+	 * \code
+	 * {
+	 *     ProfileScope profile("effect", effect);
+	 *     frame = effect->GetFrame(frame, frame_number);
+	 * }
+	 * \endcode
+	 */
+	class ProfileScope {
+	private:
+		const char* category;
+		std::string name;
+		int64_t start;
+
+	public:
+		/// @brief Time a scope
+		/// @param category The category of the timing (must be a string literal)
+		/// @param name The name of the timing
+		ProfileScope(const char* category, const std::string& name);
+
+		/// @brief Time a scope (without building a name string when profiling is disabled)
+		/// @param category The category of the timing (must be a string literal)
+		/// @param name The name of the timing
+		ProfileScope(const char* category, const char* name);
+
+		/// @brief Time a scope of a clip or effect (named by its Id)
+		/// @param category The category of the timing (must be a string literal)
+		/// @param object The clip or effect
+		ProfileScope(const char* category, const openshot::ClipBase* object);
+
+		/// Add the timing
+		~ProfileScope();
+	};
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+/**
+ * @file
+ * @brief Source file for ProxyGenerator class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include "ProxyGenerator.h"
+#include "Exceptions.h"
+#include "FFmpegReader.h"
+#include "FFmpegWriter.h"
+#include "ZmqLogger.h"
+
+using namespace openshot;
+
+// Constructor for ProxyGenerator
+ProxyGenerator::ProxyGenerator(std::string path, std::string proxy_path, int proxy_height) :
+	path(path), proxy_path(proxy_path), proxy_height(proxy_height),
+	is_running(false), is_done(false), is_cancelled(false), progress(0.0) { }
+
+// Destructor (cancels a running generation)
+ProxyGenerator::~ProxyGenerator()
+{
+	Cancel();
+	Wait();
+}
+
+// Start generating the proxy in a background thread
+void ProxyGenerator::Start()
+{
+	// Only one generation at a time
+	if (is_running)
+		return;
+	Wait();
+
+	is_running = true;
+	is_cancelled = false;
+	generate_thread = std::thread([this]() {
+		try {
+			Generate();
+		} catch (const std::exception& e) {
+			const std::lock_guard<std::mutex> lock(errorMutex);
+			error = e.what();
+		}
+		is_running = false;
+	});
+}
+
+// Cancel the generation (the partial proxy is removed)
+void ProxyGenerator::Cancel()
+{
+	is_cancelled = true;
+}
+
+// Wait for the background thread to finish
+void ProxyGenerator::Wait()
+{
+	if (generate_thread.joinable())
+		generate_thread.join();
+}
+
+// The error of a failed generation (if any)
+std::string ProxyGenerator::Error()
+{
+	const std::lock_guard<std::mutex> lock(errorMutex);
+	return error;
+}
+
+// Generate the proxy in the current thread
+void ProxyGenerator::Generate()
+{
+	is_done = false;
+	progress = 0.0;
+	{
+		const std::lock_guard<std::mutex> lock(errorMutex);
+		error = "";
+	}
+
+	FFmpegReader reader(path);
+	reader.Open();
+	if (!reader.info.has_video) {
+		reader.Close();
+		throw InvalidOptions("Proxies can only be generated for video files.", path);
+	}
+
+	// Proxy size (smaller than the original, with the same aspect ratio, and even for the YUV encoder)
+	int height = std::min(proxy_height, reader.info.height);
+	int width = round(height * reader.info.width / double(reader.info.height));
+	width += width % 2;
+	height += height % 2;
+
+	ZmqLogger::Instance()->AppendDebugMethod(
+		"ProxyGenerator::Generate",
+		"width", width,
+		"height", height,
+		"video_length", reader.info.video_length);
+
+	// Write to a temporary file (FFmpeg detects the format by the last extension)
+	std::string extension = proxy_path.substr(proxy_path.find_last_of('.') + 1);
+	std::string partial_path = proxy_path + ".partial." + extension;
+
+	// Intra-frame video (so each frame is decoded on its own, even when seeking), and uncompressed
+	// audio (at the same frame rate and sample rate, so every frame matches the original)
+	FFmpegWriter writer(partial_path);
+	if (reader.info.has_audio)
+		writer.SetAudioOptions(true, "pcm_s16le", reader.info.sample_rate, reader.info.channels,
+							   reader.info.channel_layout, 0);
+	writer.SetVideoOptions(true, "mjpeg", reader.info.fps, width, height, reader.info.pixel_ratio,
+						   false, false, width * height * reader.info.fps.ToDouble());
+	writer.PrepareStreams();
+	writer.SetOption(VIDEO_STREAM, "g", "1");
+	writer.Open();
+
+	try {
+		for (int64_t number = 1; number <= reader.info.video_length && !is_cancelled; number++) {
+			writer.WriteFrame(reader.GetFrame(number));
+			progress = float(number) / reader.info.video_length;
+		}
+		writer.Close();
+		reader.Close();
+	} catch (...) {
+		try {
+			writer.Close();
+		} catch (...) { }
+		reader.Close();
+		std::remove(partial_path.c_str());
+		throw;
+	}
+
+	if (is_cancelled) {
+		// Remove the partial proxy
+		std::remove(partial_path.c_str());
+		return;
+	}
+
+	// Replace the proxy (only when complete)
+	std::remove(proxy_path.c_str());
+	if (std::rename(partial_path.c_str(), proxy_path.c_str()) != 0)
+		throw InvalidFile("Could not create the proxy file.", proxy_path);
+
+	progress = 1.0;
+	is_done = true;
+}
@@ -0,0 +1,96 @@
+/**
+ * @file
+ * @brief Header file for ProxyGenerator class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef OPENSHOT_PROXY_GENERATOR_H
+#define OPENSHOT_PROXY_GENERATOR_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace openshot
+{
+	/**
+	 * @brief This class generates a low resolution proxy of a video file (in a background thread)
+	 *
+	 * Decoding large (i.e. 4K) camera originals is slow, so a Clip can read a smaller proxy instead, while
+	 * previewing (see Clip::Proxy). A proxy is an intra-frame (MJPEG) video with uncompressed (PCM) audio,
+	 * with the same frame rate, sample rate and number of frames as the original, so each of its frames
+	 * matches the same frame of the original.
+	 *
+	 * The proxy is written to a temporary file, which is renamed when it is complete (so a partial
+	 * proxy is never used).
+	 *
+	 * @code
+	 * ProxyGenerator generator("/home/jonathan/Videos/4k.mp4", "/home/jonathan/Videos/4k.proxy.mov");
+	 * generator.Start();
+	 *
+	 * // Later (i.e. when generator.IsDone())
+	 * clip.Proxy("/home/jonathan/Videos/4k.proxy.mov");
+	 * @endcode
+	 */
+	class ProxyGenerator
+	{
+	private:
+		std::string path;
+		std::string proxy_path;
+		int proxy_height;
+		std::thread generate_thread;
+		std::atomic<bool> is_running;
+		std::atomic<bool> is_done;
+		std::atomic<bool> is_cancelled;
+		std::atomic<float> progress;
+		std::mutex errorMutex;
+		std::string error;
+
+	public:
+		/// @brief Constructor for ProxyGenerator
+		/// @param path The path of the original video file
+		/// @param proxy_path The path of the proxy file to create (i.e. "video.proxy.mov")
+		/// @param proxy_height The max height of the proxy (the aspect ratio of the original is kept)
+		ProxyGenerator(std::string path, std::string proxy_path, int proxy_height=540);
+
+		/// Destructor (cancels a running generation)
+		virtual ~ProxyGenerator();
+
+		/// Cancel the generation (the partial proxy is removed)
+		void Cancel();
+
+		/// The error of a failed generation (if any)
+		std::string Error();
+
+		/// Generate the proxy in the current thread (throws an exception if it fails)
+		void Generate();
+
+		/// Is the proxy complete
+		bool IsDone() { return is_done; }
+
+		/// Is the proxy being generated (in a background thread)
+		bool IsRunning() { return is_running; }
+
+		/// The progress of the generation (from 0.0 to 1.0)
+		float Progress() { return progress; }
+
+		/// The path of the proxy file
+		std::string ProxyPath() const { return proxy_path; }
+
+		/// Start generating the proxy in a background thread
+		void Start();
+
+		/// Wait for the background thread to finish
+		void Wait();
+	};
+
+}
+
+#endif
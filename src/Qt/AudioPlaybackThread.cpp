@@ -200,6 +200,14 @@ namespace openshot
 		return std::shared_ptr<openshot::Frame>();
 	}
 
+	// Get the frame number being played (the audio clock), or 0 if no audio is playing
+	int64_t AudioPlaybackThread::getClockPosition()
+	{
+		if (source && transport.isPlaying())
+			return source->getClockPosition();
+		return 0;
+	}
+
 	// Seek the audio thread
 	void AudioPlaybackThread::Seek(int64_t new_position)
 	{
@@ -253,8 +261,11 @@ namespace openshot
 				// Start the transport
 				transport.start();
 
-				while (!threadShouldExit() && transport.isPlaying() && is_playing)
-					std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				// Feed the audio source (so the audio callback never waits on the reader)
+				while (!threadShouldExit() && transport.isPlaying() && is_playing) {
+					if (!source->fillBuffer())
+						std::this_thread::sleep_for(std::chrono::milliseconds(2));
+				}
 
 				// Stop audio and shutdown transport
 				Stop();
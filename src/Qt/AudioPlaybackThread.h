@@ -98,6 +98,9 @@ public:
 		/// Get the current frame object (which is filling the buffer)
 		std::shared_ptr<openshot::Frame> getFrame();
 
+		/// Get the frame number being played (the audio clock), or 0 if no audio is playing
+		int64_t getClockPosition();
+
 		/// Play the audio
 		void Play();
 
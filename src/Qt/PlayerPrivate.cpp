@@ -13,6 +13,7 @@
 
 #include "PlayerPrivate.h"
 #include "Exceptions.h"
+#include "Timeline.h"
 
 #include <queue>
 #include <thread>    // for std::this_thread::sleep_for
@@ -24,7 +25,8 @@ namespace openshot
     // Constructor
     PlayerPrivate::PlayerPrivate(openshot::RendererBase *rb)
     : renderer(rb), Thread("player"), video_position(1), audio_position(0),
-      speed(1), reader(NULL), last_video_position(1), max_sleep_ms(125000), playback_frames(0), is_dirty(true)
+      speed(1), reader(NULL), last_video_position(1), max_sleep_ms(125000), playback_frames(0), is_dirty(true),
+      preview_width(0), preview_height(0)
     {
         videoCache = new openshot::VideoCacheThread();
         audioPlayback = new openshot::AudioPlaybackThread(videoCache);
@@ -92,24 +94,48 @@ namespace openshot
                 continue;
             }
 
+            // Follow the audio clock (when audio is playing at normal speed)
+            audio_position = (speed == 1 && !is_dirty) ? audioPlayback->getClockPosition() : 0;
+            bool skipped_frames = false;
+            if (audio_position > 0) {
+                if (video_position >= audio_position) {
+                    // Video is ahead of the audio (wait for the audio clock)
+                    std::this_thread::sleep_for(frame_duration / 4);
+                    continue;
+                } else if (video_position + 1 < audio_position) {
+                    // Video is behind the audio, i.e. a slow frame (skip frames, instead of delaying the audio)
+                    playback_frames += audio_position - video_position - 1;
+                    video_position = audio_position - 1;
+                    skipped_frames = true;
+                }
+            }
+
+            // Render at the size of the display
+            updatePreviewSize();
+
             // Get the current video frame
             frame = getFrame();
 
-            // Set the video frame on the video thread and render frame
+            // Calculate the diff between 'now' and the predicted frame end time
+            const auto current_time = std::chrono::system_clock::now();
+            const auto remaining_time = double_micro_sec(start_time +
+                    (frame_duration * playback_frames) - current_time);
+
+            // Set the video frame on the video thread and render frame (which is late, if more
+            // than a frame duration behind)
             videoPlayback->frame = frame;
+            if (audio_position > 0)
+                videoPlayback->late = skipped_frames;
+            else
+                videoPlayback->late = speed != 0 && remaining_time < -frame_duration;
             videoPlayback->render.signal();
 
             // Keep track of the last displayed frame
             last_video_position = video_position;
             last_speed = speed;
 
-            // Calculate the diff between 'now' and the predicted frame end time
-            const auto current_time = std::chrono::system_clock::now();
-            const auto remaining_time = double_micro_sec(start_time +
-                    (frame_duration * playback_frames) - current_time);
-
-            // Sleep to display video image on screen
-            if (remaining_time > remaining_time.zero() ) {
+            // Sleep to display video image on screen (unless the audio clock is followed)
+            if (audio_position == 0 && remaining_time > remaining_time.zero() ) {
                 if (remaining_time < max_sleep) {
                     std::this_thread::sleep_for(remaining_time);
                 } else {
@@ -165,6 +191,26 @@ namespace openshot
     return std::shared_ptr<openshot::Frame>();
     }
 
+    // Render a timeline at the preferred size of the renderer
+    void PlayerPrivate::updatePreviewSize()
+    {
+        int width = 0;
+        int height = 0;
+        renderer->GetPreferredSize(width, height);
+        if (width <= 0 || height <= 0 || (width == preview_width && height == preview_height))
+            return;
+
+        Timeline *timeline = dynamic_cast<Timeline*>(reader);
+        if (timeline) {
+            // Cached frames are the wrong size (and refresh the current frame, even when paused)
+            timeline->SetMaxSize(width, height);
+            timeline->ClearAllCache();
+            Seek(video_position);
+        }
+        preview_width = width;
+        preview_height = height;
+    }
+
     // Seek to a new position
     void PlayerPrivate::Seek(int64_t new_position)
     {
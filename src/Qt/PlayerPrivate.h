@@ -32,7 +32,7 @@ namespace openshot
     std::shared_ptr<openshot::Frame> frame; /// The current frame
     int64_t playback_frames; /// The # of frames since playback started
 	int64_t video_position; /// The current frame position.
-	int64_t audio_position; /// The current frame position.
+	int64_t audio_position; /// The frame position of the audio clock (0 if no audio is playing)
 	openshot::ReaderBase *reader; /// The reader which powers this player
 	openshot::AudioPlaybackThread *audioPlayback; /// The audio thread
 	openshot::VideoPlaybackThread *videoPlayback; /// The video thread
@@ -43,6 +43,8 @@ namespace openshot
 	int64_t last_video_position; /// The last frame actually displayed
 	int max_sleep_ms; /// The max milliseconds to sleep (when syncing audio and video)
 	bool is_dirty; /// Detect if a frame needs to be refreshed (calls to Seek() set this to true)
+	int preview_width; /// The width of frames requested from a timeline (the preferred size of the renderer)
+	int preview_height; /// The height of frames requested from a timeline (the preferred size of the renderer)
 
 	/// Constructor
 	PlayerPrivate(openshot::RendererBase *rb);
@@ -64,6 +66,9 @@ namespace openshot
 	/// Get the next frame (based on speed and direction)
 	std::shared_ptr<openshot::Frame> getFrame();
 
+	/// Render a timeline at the preferred size of the renderer (i.e. the size of the display)
+	void updatePreviewSize();
+
 	/// The parent class of PlayerPrivate
 	friend class QtPlayer;
     };
@@ -54,15 +54,8 @@ namespace openshot
         // Calculate last frame # on timeline (to prevent caching past this point)
         timeline_max_frame = t->GetMaxFrame();
 
-        // Determine previous frame number (depending on last non-zero/non-paused speed)
-        int64_t previous_frame = new_position;
-        if (last_speed < 0) {
-            // backwards
-            previous_frame++;
-        } else if (last_speed > 0) {
-            // forward
-            previous_frame--;
-        }
+        // Determine previous frame number (depending on last non-zero/non-paused speed and direction)
+        int64_t previous_frame = new_position - last_speed;
         if (previous_frame <= 0) {
             // min frame is 1
             previous_frame = 1;
@@ -104,6 +97,11 @@ namespace openshot
             last_speed = new_speed;
         }
         speed = new_speed;
+
+        // Let the readers of a timeline skip decoding images which are not displayed (i.e. when fast forwarding)
+        Timeline *t = dynamic_cast<Timeline*>(reader);
+        if (t)
+            t->preview_speed = new_speed;
     }
 
     // Get the size in bytes of a frame (rough estimate)
@@ -155,8 +153,8 @@ namespace openshot
             const auto frame_duration = double_micro_sec(1000000.0 / reader->info.fps.ToDouble());
             int current_speed = speed;
             
-            // Increment and direction for cache loop
-            int64_t increment = 1;
+            // Increment and direction for cache loop (the frames displayed at the current speed)
+            int64_t increment = current_speed != 0 ? current_speed : 1;
 
             // Check for empty cache (and re-trigger preroll)
             // This can happen when the user manually empties the timeline cache
@@ -218,30 +216,22 @@ namespace openshot
             // Always cache frames from the current display position to our maximum (based on the cache size).
             // Frames which are already cached are basically free. Only uncached frames have a big CPU cost.
             // By always looping through the expected frame range, we can fill-in missing frames caused by a
-            // fragmented cache object (i.e. the user clicking all over the timeline). The -1 is to always
-            // cache 1 frame previous to our current frame (to avoid our Seek method from clearing the cache).
-            int64_t starting_frame = std::min(current_display_frame, timeline_max_frame) - 1;
-            int64_t ending_frame = std::min(starting_frame + max_frames_ahead, timeline_max_frame);
-
-            // Adjust ending frame for cache loop
-            if (increment < 0) {
-                // Reverse loop (if we are going backwards)
-                ending_frame = starting_frame - max_frames_ahead;
-            }
-            if (starting_frame < 1) {
-                // Don't allow negative frame number caching
-                starting_frame = 1;
-            }
-            if (ending_frame < 1) {
-                // Don't allow negative frame number caching
-                ending_frame = 1;
-            }
+            // fragmented cache object (i.e. the user clicking all over the timeline). The previous frame
+            // (in the playback direction) is always cached (to avoid our Seek method from clearing the cache).
+            // At faster speeds, only the frames which will be displayed are cached (i.e. every 4th frame).
+            int64_t max_frame = timeline_max_frame > 0 ? timeline_max_frame : reader->info.video_length;
+            int64_t starting_frame = std::max(int64_t(1), std::min(current_display_frame, max_frame) - increment);
 
             // Reset cache break-loop flag
             should_break = false;
 
             // Loop through range of frames (and cache them)
-            for (int64_t cache_frame = starting_frame; cache_frame != (ending_frame + increment); cache_frame += increment) {
+            for (int64_t cache_count = 0; cache_count <= max_frames_ahead; cache_count++) {
+                int64_t cache_frame = starting_frame + (cache_count * increment);
+                if (cache_frame < 1 || cache_frame > max_frame) {
+                    // Don't cache past the start or end of the timeline
+                    break;
+                }
                 cached_frame_count++;
                 if (reader && reader->GetCache() && !reader->GetCache()->Contains(cache_frame)) {
                     try
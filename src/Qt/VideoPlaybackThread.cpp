@@ -23,7 +23,7 @@ namespace openshot
 	// Constructor
     VideoPlaybackThread::VideoPlaybackThread(RendererBase *rb)
 	: Thread("video-playback"), renderer(rb)
-	, render(), reset(false)
+	, render(), reset(false), late(false)
     {
     }
 
@@ -54,10 +54,11 @@ namespace openshot
 			ZmqLogger::Instance()->AppendDebugMethod(
 				"VideoPlaybackThread::run (before render)",
 				"frame->number", frame->number,
-				"need_render", need_render);
+				"need_render", need_render,
+				"late", late);
 
 			// Render the frame to the screen
-			renderer->paint(frame);
+			renderer->paint(frame, late);
 		}
 
 		// Signal to other threads that the rendered event has completed
@@ -34,6 +34,7 @@ namespace openshot
 	WaitableEvent render;
 	WaitableEvent rendered;
 	bool reset;
+	bool late; ///< Is the frame late (i.e. it missed its scheduled time)
 
 	/// Constructor
 	VideoPlaybackThread(RendererBase *rb);
@@ -11,6 +11,7 @@
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
 #include "VideoRenderWidget.h"
+#include <cmath>
 #include <QWidget>
 #include <QImage>
 #include <QPainter>
@@ -34,7 +35,7 @@ VideoRenderWidget::VideoRenderWidget(QWidget *parent)
     pixel_ratio.num = 1;
     pixel_ratio.den = 1;
 
-    connect(renderer, SIGNAL(present(const QImage &)), this, SLOT(present(const QImage &)));
+    connect(renderer, SIGNAL(frameReady()), this, SLOT(frameReady()));
 }
 
 VideoRenderWidget::~VideoRenderWidget()
@@ -50,6 +51,14 @@ void VideoRenderWidget::SetAspectRatio(openshot::Fraction new_aspect_ratio, open
 {
 	aspect_ratio = new_aspect_ratio;
 	pixel_ratio = new_pixel_ratio;
+	updatePreferredSize();
+}
+
+void VideoRenderWidget::updatePreferredSize()
+{
+	QRect viewport = centeredViewport(width(), height());
+	qreal device_ratio = devicePixelRatioF();
+	renderer->SetPreferredSize(round(viewport.width() * device_ratio), round(viewport.height() * device_ratio));
 }
 
 QRect VideoRenderWidget::centeredViewport(int width, int height)
@@ -70,15 +79,33 @@ void VideoRenderWidget::paintEvent(QPaintEvent *event)
 {
     QPainter painter(this);
 
-    // maintain aspect ratio
+    // maintain aspect ratio (the image is already scaled to the viewport, so it's drawn 1:1 in device pixels)
     painter.fillRect(event->rect(), palette().window());
-    painter.setViewport(centeredViewport(width(), height()));
-    painter.drawImage(QRect(0, 0, width(), height()), image);
+    painter.drawImage(centeredViewport(width(), height()), image);
+
+}
 
+void VideoRenderWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updatePreferredSize();
 }
 
-void VideoRenderWidget::present(const QImage &m)
+void VideoRenderWidget::frameReady()
 {
-    image = m;
-    repaint();
+    std::shared_ptr<QImage> next_image = renderer->TakeImage();
+    if (!next_image)
+        return;
+
+    // Scale once (instead of on every paint), only if the image doesn't match the viewport
+    QRect viewport = centeredViewport(width(), height());
+    qreal device_ratio = devicePixelRatioF();
+    QSize device_size(round(viewport.width() * device_ratio), round(viewport.height() * device_ratio));
+    if (next_image->size() == device_size)
+        image = *next_image;
+    else
+        image = next_image->scaled(device_size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+
+    // Paint with the next repaint of the widget (instead of blocking the GUI thread)
+    update(viewport);
 }
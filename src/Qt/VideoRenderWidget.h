@@ -20,6 +20,7 @@
 #include <QImage>
 #include <QPaintEvent>
 #include <QRect>
+#include <QResizeEvent>
 
 class VideoRenderWidget : public QWidget
 {
@@ -27,7 +28,7 @@ class VideoRenderWidget : public QWidget
 
 private:
     VideoRenderer *renderer;
-    QImage image;
+    QImage image; ///< The current image (scaled to the viewport, in device pixels)
     openshot::Fraction aspect_ratio;
     openshot::Fraction pixel_ratio;
 
@@ -40,11 +41,15 @@ public:
 
 protected:
     void paintEvent(QPaintEvent *event);
+    void resizeEvent(QResizeEvent *event);
 
     QRect centeredViewport(int width, int height);
 
+    /// Update the preferred size of the renderer (the viewport in device pixels)
+    void updatePreferredSize();
+
 private slots:
-    void present(const QImage &image);
+    void frameReady();
 
 };
 
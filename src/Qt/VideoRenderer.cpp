@@ -12,9 +12,14 @@
 
 #include "VideoRenderer.h"
 
+#include <QtCore/QMetaMethod>
+
+// Flag of the ready buffer index (set when the ready buffer has a new image)
+static const int NEW_IMAGE = 4;
 
 VideoRenderer::VideoRenderer(QObject *parent)
-    : QObject(parent)
+    : QObject(parent), override_widget(NULL), ready_state(1), back_index(0), front_index(2),
+      preferred_width(0), preferred_height(0)
 {
 }
 
@@ -30,8 +35,47 @@ void VideoRenderer::OverrideWidget(int64_t qwidget_address)
 
 }
 
+// Get the preferred size of images
+void VideoRenderer::GetPreferredSize(int &width, int &height)
+{
+	width = preferred_width;
+	height = preferred_height;
+}
+
+// Set the preferred size of images (i.e. the size of the widget in device pixels)
+void VideoRenderer::SetPreferredSize(int width, int height)
+{
+	preferred_width = width;
+	preferred_height = height;
+}
+
+// Take the newest image (from the GUI thread)
+std::shared_ptr<QImage> VideoRenderer::TakeImage()
+{
+	if (ready_state & NEW_IMAGE)
+		front_index = ready_state.exchange(front_index) & ~NEW_IMAGE;
+	return buffers[front_index];
+}
+
 void VideoRenderer::render(std::shared_ptr<QImage> image)
 {
-    if (image)
-        emit present(*image);
+    if (!image)
+        return;
+
+	// Swap the back buffer with the ready buffer
+	buffers[back_index] = image;
+	int previous_state = ready_state.exchange(back_index | NEW_IMAGE);
+	back_index = previous_state & ~NEW_IMAGE;
+
+	if (previous_state & NEW_IMAGE) {
+		// The previous image was never taken (and the GUI thread was already notified)
+		dropped_frames++;
+	} else {
+		emit frameReady();
+	}
+
+	// Widgets which only connect to the present() signal (i.e. overridden widgets)
+	static const QMetaMethod present_signal = QMetaMethod::fromSignal(&VideoRenderer::present);
+	if (isSignalConnected(present_signal))
+		emit present(*image);
 }
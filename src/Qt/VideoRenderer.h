@@ -16,11 +16,21 @@
 #include "../RendererBase.h"
 #include <QtCore/QObject>
 #include <QtGui/QImage>
+#include <atomic>
 #include <memory>
 
 
 class QPainter;
 
+/**
+ * @brief This class hands off rendered images to the GUI thread (without copying them)
+ *
+ * Images are passed through a lock-free triple buffer: the playback thread writes the back buffer, and
+ * swaps it with the ready buffer, and the GUI thread swaps the ready buffer with the front (displayed)
+ * buffer when it paints (see TakeImage). A ready image which is replaced before being taken is dropped.
+ * The frameReady() signal is only emitted once per taken image, so a slow GUI thread is not flooded
+ * with queued events.
+ */
 class VideoRenderer : public QObject, public openshot::RendererBase
 {
     Q_OBJECT
@@ -32,8 +42,18 @@ public:
     /// Override QWidget which needs to be painted
     void OverrideWidget(int64_t qwidget_address);
 
+    /// Get the preferred size of images (set by the widget displaying them)
+    void GetPreferredSize(int &width, int &height);
+
+    /// Set the preferred size of images (i.e. the size of the widget in device pixels)
+    void SetPreferredSize(int width, int height);
+
+    /// Take the newest image (from the GUI thread), or the current image if no new image is ready
+    std::shared_ptr<QImage> TakeImage();
+
 signals:
 	void present(const QImage &image);
+	void frameReady();
 
 protected:
     //void render(openshot::OSPixelFormat format, int width, int height, int bytesPerLine, unsigned char *data);
@@ -43,6 +63,12 @@ private slots:
 
 private:
 	QWidget* override_widget;
+	std::shared_ptr<QImage> buffers[3];
+	std::atomic<int> ready_state; ///< Index of the ready buffer (and the NEW_IMAGE flag)
+	int back_index; ///< Index of the buffer written by the playback thread
+	int front_index; ///< Index of the buffer displayed by the GUI thread
+	std::atomic<int> preferred_width;
+	std::atomic<int> preferred_height;
 };
 
 #endif //OPENSHOT_VIDEO_RENDERER_H
@@ -62,6 +62,16 @@ namespace openshot
     	}
     }
 
+    // Get the number of frames which were replaced by a newer frame, before being displayed
+    int64_t QtPlayer::DroppedFrames() {
+    	return p->renderer->DroppedFrames();
+    }
+
+    // Get the number of frames which were displayed after their scheduled time
+    int64_t QtPlayer::LateFrames() {
+    	return p->renderer->LateFrames();
+    }
+
     // Return the default audio sample rate (from the system)
     double QtPlayer::GetDefaultSampleRate() {
         if (reader && threads_started) {
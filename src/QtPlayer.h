@@ -48,6 +48,12 @@ namespace openshot
 	/// Get Error (if any)
 	std::string GetError();
 
+	/// Get the number of frames which were replaced by a newer frame, before being displayed
+	int64_t DroppedFrames();
+
+	/// Get the number of frames which were displayed after their scheduled time
+	int64_t LateFrames();
+
 	/// Return the default audio sample rate (from the system)
 	double GetDefaultSampleRate();
 
@@ -13,7 +13,7 @@
 #include "RendererBase.h"
 using namespace openshot;
 
-RendererBase::RendererBase()
+RendererBase::RendererBase() : dropped_frames(0), late_frames(0)
 {
 }
 
@@ -21,8 +21,10 @@ RendererBase::~RendererBase()
 {
 }
 
-void RendererBase::paint(const std::shared_ptr<Frame> & frame)
+void RendererBase::paint(const std::shared_ptr<Frame> & frame, bool late)
 {
+	if (late)
+		late_frames++;
 	if (frame)
 		this->render(frame->GetImage());
 }
@@ -14,6 +14,7 @@
 #define OPENSHOT_RENDERER_BASE_H
 
 #include "Frame.h"
+#include <atomic>
 #include <cstdlib> // for realloc
 #include <memory>
 
@@ -31,13 +32,25 @@ namespace openshot
     {
     public:
 
-	/// Paint(render) a video Frame.
-	void paint(const std::shared_ptr<openshot::Frame> & frame);
+	/// Paint(render) a video Frame (which is late, if it missed its scheduled time)
+	void paint(const std::shared_ptr<openshot::Frame> & frame, bool late=false);
 
 	/// Allow manual override of the QWidget that is used to display
 	virtual void OverrideWidget(int64_t qwidget_address) = 0;
 
+	/// Get the preferred size of images (i.e. the size of the display in device pixels), or 0x0 for any size
+	virtual void GetPreferredSize(int &width, int &height) { width = 0; height = 0; }
+
+	/// Get the number of frames which were replaced by a newer frame, before being displayed
+	int64_t DroppedFrames() const { return dropped_frames; }
+
+	/// Get the number of frames which were painted after their scheduled time
+	int64_t LateFrames() const { return late_frames; }
+
     protected:
+	std::atomic<int64_t> dropped_frames;
+	std::atomic<int64_t> late_frames;
+
 	RendererBase();
 	virtual ~RendererBase();
 
@@ -0,0 +1,705 @@
+/**
+ * @file
+ * @brief Source file for SegmentExporter class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+
+#include "FFmpegUtilities.h"
+
+#include "SegmentExporter.h"
+#include "Exceptions.h"
+#include "FFmpegReader.h"
+#include "FFmpegWriter.h"
+#include "Frame.h"
+#include "FrameMapper.h"
+#include "OpenMPUtilities.h"
+#include "Timeline.h"
+#include "ZmqLogger.h"
+
+using namespace openshot;
+
+// Constructor for SegmentExporter
+SegmentExporter::SegmentExporter(Timeline* timeline, std::string path) :
+	timeline(timeline), path(path), segments(OPEN_MP_NUM_PROCESSORS), gop_size(0), passthrough(false),
+	frames_written(0), frames_total(0), has_video(false), video_codec(""), fps(timeline->info.fps),
+	width(timeline->info.width), height(timeline->info.height), pixel_ratio(1, 1), interlaced(false),
+	top_field_first(false), video_bit_rate(0), has_audio(false), audio_codec(""),
+	sample_rate(timeline->info.sample_rate), channels(timeline->info.channels),
+	channel_layout(timeline->info.channel_layout), audio_bit_rate(0), encoded_parameters{false, "", 0, 0, 0} { }
+
+// Set video export options
+void SegmentExporter::SetVideoOptions(bool has_video, std::string codec, Fraction fps, int width, int height,
+									  Fraction pixel_ratio, bool interlaced, bool top_field_first, int bit_rate) {
+	this->has_video = has_video;
+	video_codec = codec;
+	this->fps = fps;
+	this->width = width;
+	this->height = height;
+	this->pixel_ratio = pixel_ratio;
+	this->interlaced = interlaced;
+	this->top_field_first = top_field_first;
+	video_bit_rate = bit_rate;
+}
+
+// Set audio export options
+void SegmentExporter::SetAudioOptions(bool has_audio, std::string codec, int sample_rate, int channels,
+									  ChannelLayout channel_layout, int bit_rate) {
+	this->has_audio = has_audio;
+	audio_codec = codec;
+	this->sample_rate = sample_rate;
+	this->channels = channels;
+	this->channel_layout = channel_layout;
+	audio_bit_rate = bit_rate;
+}
+
+// Set a video codec option
+void SegmentExporter::SetOption(std::string name, std::string value) {
+	// The GOP size is also the segment alignment
+	if (name == "g")
+		SetGopSize(std::stoi(value));
+	else
+		video_options[name] = value;
+}
+
+// Set the number of frames in each GOP
+void SegmentExporter::SetGopSize(int frames) {
+	if (frames < 1)
+		throw InvalidOptions("The GOP size must be at least 1 frame.", path);
+	gop_size = frames;
+}
+
+// Set the max number of segments (encoded in parallel)
+void SegmentExporter::SetSegments(int new_segments) {
+	if (new_segments < 1)
+		throw InvalidOptions("At least 1 segment is needed.", path);
+	segments = new_segments;
+}
+
+// The progress of the export (from 0.0 to 1.0)
+float SegmentExporter::Progress() const {
+	if (frames_total == 0)
+		return 0.0;
+	return float(frames_written) / frames_total;
+}
+
+// Export frames of the timeline
+void SegmentExporter::Export(int64_t start, int64_t end) {
+	if (!has_video)
+		throw InvalidOptions("Segmented exports need a video stream (see SetVideoOptions).", path);
+	if (start < 1 || end < start)
+		throw InvalidOptions("Invalid range of frames to export.", path);
+
+	// GOPs of 1 second (by default)
+	int gop = gop_size > 0 ? gop_size : std::max(1, int(round(fps.ToDouble())));
+
+	// Copied parts must match the codec parameters of the encoded parts
+	encoded_parameters.found = false;
+	if (passthrough)
+		probe_encoder(gop);
+
+	// Split the frames into segments (of whole GOPs), and the segments into parts (which are copied or encoded)
+	int64_t length = end - start + 1;
+	int64_t gops = (length + gop - 1) / gop;
+	int64_t segment_count = std::min(int64_t(segments), gops);
+	std::vector<Part> parts;
+	for (int64_t segment = 0; segment < segment_count; segment++) {
+		int64_t segment_start = start + (gops * segment / segment_count) * gop;
+		int64_t segment_end = std::min(end, start + (gops * (segment + 1) / segment_count) * gop - 1);
+		if (passthrough)
+			split_segment(segment_start, segment_end, parts);
+		else
+			parts.push_back({segment_start, segment_end, "", 0});
+	}
+
+	// Temporary files (FFmpeg detects the format by the last extension)
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::vector<std::string> part_paths;
+	std::vector<int64_t> part_starts;
+	for (size_t part = 0; part < parts.size(); part++) {
+		part_paths.push_back(path + ".segment" + std::to_string(part) + "." + extension);
+		part_starts.push_back(parts[part].start);
+	}
+	std::string audio_path = has_audio ? path + ".audio." + extension : "";
+
+	ZmqLogger::Instance()->AppendDebugMethod(
+		"SegmentExporter::Export",
+		"start", start,
+		"end", end,
+		"gop", gop,
+		"segment_count", segment_count,
+		"parts.size()", parts.size());
+
+	// Each segment renders its own copy of the timeline
+	std::string json = timeline->Json();
+	frames_written = 0;
+	frames_total = length * (has_audio ? 2 : 1);
+
+	// Encode (or copy) each part, and the audio (in parallel)
+	int tasks = parts.size() + (has_audio ? 1 : 0);
+	std::vector<std::exception_ptr> errors(tasks);
+	#pragma omp parallel for schedule(dynamic) num_threads(tasks)
+	for (int task = 0; task < tasks; task++) {
+		try {
+			if (has_audio && task == tasks - 1) {
+				write_audio(json, audio_path, start, end);
+			} else if (!parts[task].source_path.empty()) {
+				write_passthrough(parts[task].source_path, part_paths[task], parts[task].source_start,
+								  parts[task].source_start + parts[task].end - parts[task].start);
+				frames_written += parts[task].end - parts[task].start + 1;
+			} else {
+				write_segment(json, part_paths[task], parts[task].start, parts[task].end, gop);
+			}
+		} catch (...) {
+			errors[task] = std::current_exception();
+		}
+	}
+
+	try {
+		// Raise the first exception (from the main thread)
+		for (const auto& error : errors) {
+			if (error)
+				std::rethrow_exception(error);
+		}
+
+		// Join the parts (and audio)
+		concatenate(part_paths, part_starts, audio_path);
+	} catch (...) {
+		// Remove the temporary files
+		for (const auto& part_path : part_paths)
+			std::remove(part_path.c_str());
+		if (has_audio)
+			std::remove(audio_path.c_str());
+		throw;
+	}
+
+	// Remove the temporary files
+	for (const auto& part_path : part_paths)
+		std::remove(part_path.c_str());
+	if (has_audio)
+		std::remove(audio_path.c_str());
+}
+
+#if IS_FFMPEG_3_2
+// The timestamp (in the time base of the video stream) of frame 1, just like FFmpegReader::UpdatePTSOffset,
+// which shifts the timestamps so the earliest stream (video or audio) starts at zero
+static int64_t first_frame_pts(AVFormatContext *input, AVStream *stream) {
+	// The start of the video, and the first audio stream (if any)
+	double video_seconds = stream->start_time != AV_NOPTS_VALUE ? stream->start_time * av_q2d(stream->time_base) : 0.0;
+	double start_seconds = video_seconds;
+	for (unsigned int i = 0; i < input->nb_streams; i++) {
+		if (input->streams[i]->codecpar->codec_type == AVMEDIA_TYPE_AUDIO) {
+			AVStream *audio_stream = input->streams[i];
+			double audio_seconds = audio_stream->start_time != AV_NOPTS_VALUE ? audio_stream->start_time * av_q2d(audio_stream->time_base) : 0.0;
+			start_seconds = std::min(video_seconds, audio_seconds);
+
+			// Ignore wildly invalid timestamps (no offset)
+			if (std::abs(audio_seconds) > 10.0)
+				start_seconds = 0.0;
+			break;
+		}
+	}
+	if (std::abs(video_seconds) > 10.0)
+		start_seconds = 0.0;
+
+	return llround(start_seconds / av_q2d(stream->time_base));
+}
+#endif // IS_FFMPEG_3_2
+
+// Is a keyframe constant (at this value)
+static bool is_constant(const Keyframe& keyframe, double value) {
+	for (int64_t index = 0; index < keyframe.GetCount(); index++) {
+		if (keyframe.GetPoint(index).co.Y != value)
+			return false;
+	}
+	return true;
+}
+
+// Find the video file (and its first frame number) of a segment which only shows a single (untouched) clip
+bool SegmentExporter::find_passthrough(int64_t start, int64_t end, std::string& source_path, int64_t& source_start) {
+	double timeline_fps = timeline->info.fps.ToDouble();
+	if (timeline->info.fps.num != fps.num || timeline->info.fps.den != fps.den ||
+		timeline->info.width != width || timeline->info.height != height)
+		return false;
+
+	// A single clip (with video) must cover the whole segment
+	Clip* passthrough_clip = NULL;
+	for (auto clip : timeline->Clips()) {
+		long clip_start_position = round(clip->Position() * timeline_fps) + 1;
+		long clip_end_position = round((clip->Position() + clip->Duration()) * timeline_fps);
+		if (clip_end_position < start || clip_start_position > end)
+			continue;
+
+		// Clips without video don't change the image
+		ReaderBase* reader = clip->Reader();
+		if (!reader->info.has_video || (clip->has_video.GetCount() > 0 && is_constant(clip->has_video, 0.0)))
+			continue;
+
+		if (passthrough_clip || clip_start_position > start || clip_end_position < end)
+			return false;
+		passthrough_clip = clip;
+	}
+	if (!passthrough_clip)
+		return false;
+
+	// No transitions or masks
+	for (auto effect : timeline->Effects()) {
+		long effect_start_position = round(effect->Position() * timeline_fps) + 1;
+		long effect_end_position = round((effect->Position() + effect->Duration()) * timeline_fps);
+		if (effect_end_position >= start && effect_start_position <= end)
+			return false;
+	}
+
+	// The clip must be untouched (no effects, transforms, or time mapping)
+	Clip* clip = passthrough_clip;
+	if (!clip->Effects().empty() || clip->waveform || clip->display != FRAME_DISPLAY_NONE ||
+		clip->GetAttachedObject() || clip->GetAttachedClip() || clip->time.GetLength() > 1 ||
+		!is_constant(clip->alpha, 1.0) || !is_constant(clip->scale_x, 1.0) || !is_constant(clip->scale_y, 1.0) ||
+		!is_constant(clip->location_x, 0.0) || !is_constant(clip->location_y, 0.0) ||
+		!is_constant(clip->rotation, 0.0) || !is_constant(clip->shear_x, 0.0) || !is_constant(clip->shear_y, 0.0) ||
+		!is_constant(clip->perspective_c1_x, -1.0) || !is_constant(clip->perspective_c1_y, -1.0) ||
+		!is_constant(clip->perspective_c2_x, -1.0) || !is_constant(clip->perspective_c2_y, -1.0) ||
+		!is_constant(clip->perspective_c3_x, -1.0) || !is_constant(clip->perspective_c3_y, -1.0) ||
+		!is_constant(clip->perspective_c4_x, -1.0) || !is_constant(clip->perspective_c4_y, -1.0))
+		return false;
+
+	// The clip must read a video file (at the timeline's frame rate)
+	ReaderBase* reader = clip->Reader();
+	FrameMapper* mapper = dynamic_cast<FrameMapper*>(reader);
+	if (mapper)
+		reader = mapper->Reader();
+	if (!dynamic_cast<FFmpegReader*>(reader) || reader->info.fps.num != fps.num || reader->info.fps.den != fps.den ||
+		reader->info.width != width || reader->info.height != height || reader->info.interlaced_frame)
+		return false;
+
+	long clip_start_position = round(clip->Position() * timeline_fps) + 1;
+	long clip_start_frame = (clip->Start() * timeline_fps) + 1;
+	source_path = reader->JsonValue()["path"].asString();
+	source_start = start - clip_start_position + clip_start_frame;
+	return true;
+}
+
+// Find the key frames (from first to last frame) of a video file which matches the export (or none)
+std::vector<int64_t> SegmentExporter::find_keyframes(const std::string& source_path, int64_t first, int64_t last) {
+	std::vector<int64_t> keyframes;
+#if IS_FFMPEG_3_2
+	AVFormatContext *input = NULL;
+	if (avformat_open_input(&input, source_path.c_str(), NULL, NULL) != 0)
+		return keyframes;
+	int stream_index = -1;
+	if (avformat_find_stream_info(input, NULL) >= 0)
+		stream_index = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+
+	// The packets must be decodable as if they were encoded with the export options, with the same global
+	// headers (which are shared by all parts), profile, level, and number of reordered frames (so the
+	// timestamps increase at the joins)
+	const AVCodec *encoder = avcodec_find_encoder_by_name(video_codec.c_str());
+	AVStream *stream = stream_index >= 0 ? input->streams[stream_index] : NULL;
+	if (!stream || !encoder || interlaced || !encoded_parameters.found || stream->codecpar->codec_id != encoder->id ||
+		stream->codecpar->width != width || stream->codecpar->height != height ||
+		stream->codecpar->format != AV_PIX_FMT_YUV420P ||
+		std::string((const char *) stream->codecpar->extradata, stream->codecpar->extradata_size) != encoded_parameters.extradata ||
+		stream->codecpar->profile != encoded_parameters.profile || stream->codecpar->level != encoded_parameters.level ||
+		stream->codecpar->video_delay != encoded_parameters.video_delay) {
+		ZmqLogger::Instance()->AppendDebugMethod(
+			"SegmentExporter::find_keyframes (video file does not match the export)",
+			"stream_index", stream_index,
+			"extradata_size", stream ? stream->codecpar->extradata_size : 0,
+			"profile", stream ? stream->codecpar->profile : 0,
+			"level", stream ? stream->codecpar->level : 0,
+			"video_delay", stream ? stream->codecpar->video_delay : 0);
+		avformat_close_input(&input);
+		return keyframes;
+	}
+
+	// Frame numbers of the packets (numbered like FFmpegReader)
+	int64_t start_time = first_frame_pts(input, stream);
+	AVRational frame_base = av_make_q(fps.den, fps.num);
+	auto frame_of = [&](int64_t pts) {
+		return av_rescale_q_rnd(pts - start_time, stream->time_base, frame_base, AV_ROUND_NEAR_INF) + 1;
+	};
+
+	// Seek before the first frame, and read the key frames (until the last frame)
+	int64_t max_frame = 0;
+	bool reached_end = true;
+	AVPacket *packet = av_packet_alloc();
+	av_seek_frame(input, stream_index, start_time + av_rescale_q(first - 1, frame_base, stream->time_base), AVSEEK_FLAG_BACKWARD);
+	while (av_read_frame(input, packet) >= 0) {
+		if (packet->stream_index == stream_index && packet->pts != AV_NOPTS_VALUE) {
+			int64_t frame = frame_of(packet->pts);
+			max_frame = std::max(max_frame, frame);
+			if ((packet->flags & AV_PKT_FLAG_KEY) && frame >= first) {
+				if (frame > last) {
+					reached_end = false;
+					av_packet_unref(packet);
+					break;
+				}
+				keyframes.push_back(frame);
+			}
+		}
+		av_packet_unref(packet);
+	}
+	av_packet_free(&packet);
+	avformat_close_input(&input);
+
+	// The end of the file also ends the last GOP
+	if (reached_end && max_frame > 0 && max_frame + 1 <= last)
+		keyframes.push_back(max_frame + 1);
+#endif // IS_FFMPEG_3_2
+	return keyframes;
+}
+
+// Encode a single frame with the export options, to find the codec parameters of the encoded parts
+void SegmentExporter::probe_encoder(int gop) {
+	encoded_parameters = {false, "", 0, 0, 0};
+#if IS_FFMPEG_3_2
+	std::string extension = path.substr(path.find_last_of('.') + 1);
+	std::string probe_path = path + ".probe." + extension;
+	AVFormatContext *input = NULL;
+	try {
+		FFmpegWriter w(probe_path);
+		set_writer_options(w, gop);
+		w.WriteFrame(std::make_shared<Frame>(1, width, height, "#000000"));
+		w.Close();
+
+		if (avformat_open_input(&input, probe_path.c_str(), NULL, NULL) == 0 &&
+			avformat_find_stream_info(input, NULL) >= 0 && input->nb_streams > 0) {
+			AVCodecParameters *codecpar = input->streams[0]->codecpar;
+			encoded_parameters.found = true;
+			encoded_parameters.extradata = std::string((const char *) codecpar->extradata, codecpar->extradata_size);
+			encoded_parameters.profile = codecpar->profile;
+			encoded_parameters.level = codecpar->level;
+			encoded_parameters.video_delay = codecpar->video_delay;
+		}
+	} catch (...) {
+		// Encode every part (without passthrough)
+		ZmqLogger::Instance()->AppendDebugMethod("SegmentExporter::probe_encoder (failed)", "gop", gop);
+	}
+	if (input)
+		avformat_close_input(&input);
+	std::remove(probe_path.c_str());
+
+	ZmqLogger::Instance()->AppendDebugMethod(
+		"SegmentExporter::probe_encoder",
+		"found", encoded_parameters.found,
+		"extradata_size", encoded_parameters.extradata.size(),
+		"profile", encoded_parameters.profile,
+		"level", encoded_parameters.level,
+		"video_delay", encoded_parameters.video_delay);
+#endif // IS_FFMPEG_3_2
+}
+
+// Set the video options of a writer (the same for each encoded part)
+void SegmentExporter::set_writer_options(FFmpegWriter& writer, int gop) {
+	// Video only (a new encoder, so each part starts a new GOP)
+	writer.SetVideoOptions(true, video_codec, fps, width, height, pixel_ratio, interlaced, top_field_first, video_bit_rate);
+	writer.PrepareStreams();
+	writer.SetOption(VIDEO_STREAM, "g", std::to_string(gop));
+	for (const auto& option : video_options)
+		writer.SetOption(VIDEO_STREAM, option.first, option.second);
+	writer.Open();
+}
+
+// Split a segment into parts (copying the whole GOPs of a single, untouched clip, if possible)
+void SegmentExporter::split_segment(int64_t start, int64_t end, std::vector<Part>& parts) {
+	std::string source_path;
+	int64_t source_start = 0;
+	if (find_passthrough(start, end, source_path, source_start)) {
+		// Copy from the first key frame, to the frame before the last key frame (or the end of the file)
+		int64_t source_end = source_start + end - start;
+		std::vector<int64_t> keyframes = find_keyframes(source_path, source_start, source_end + 1);
+		if (keyframes.size() >= 2) {
+			int64_t copy_start = start + keyframes.front() - source_start;
+			int64_t copy_end = start + keyframes.back() - source_start - 1;
+
+			ZmqLogger::Instance()->AppendDebugMethod(
+				"SegmentExporter::split_segment (passthrough)",
+				"start", start,
+				"end", end,
+				"copy_start", copy_start,
+				"copy_end", copy_end);
+
+			// Encode the frames before (and after) the copied GOPs
+			if (copy_start > start)
+				parts.push_back({start, copy_start - 1, "", 0});
+			parts.push_back({copy_start, copy_end, source_path, keyframes.front()});
+			if (copy_end < end)
+				parts.push_back({copy_end + 1, end, "", 0});
+			return;
+		}
+	}
+
+	// Encode the whole segment
+	parts.push_back({start, end, "", 0});
+}
+
+// Render and encode a video segment of the timeline
+void SegmentExporter::write_segment(const std::string& json, const std::string& segment_path, int64_t start, int64_t end, int gop) {
+	Timeline t(timeline->info);
+	t.SetJson(json);
+	t.Open();
+
+	// Video only (a new encoder, so the segment starts a new GOP)
+	FFmpegWriter w(segment_path);
+	set_writer_options(w, gop);
+
+	for (int64_t number = start; number <= end; number++) {
+		w.WriteFrame(t.GetFrame(number));
+		frames_written++;
+	}
+
+	w.Close();
+	t.Close();
+}
+
+// Render and encode the audio of the timeline
+void SegmentExporter::write_audio(const std::string& json, const std::string& audio_path, int64_t start, int64_t end) {
+	Timeline t(timeline->info);
+	t.SetJson(json);
+	t.AudioOnly(true);
+	t.Open();
+
+	// Audio only
+	FFmpegWriter w(audio_path);
+	w.SetAudioOptions(true, audio_codec, sample_rate, channels, channel_layout, audio_bit_rate);
+	w.Open();
+
+	for (int64_t number = start; number <= end; number++) {
+		w.WriteFrame(t.GetFrame(number));
+		frames_written++;
+	}
+
+	w.Close();
+	t.Close();
+}
+
+// Copy the packets of frames of a video file (without re-encoding)
+void SegmentExporter::write_passthrough(const std::string& source_path, const std::string& part_path, int64_t first, int64_t last) {
+#if IS_FFMPEG_3_2
+	AVFormatContext *input = NULL;
+	AVFormatContext *output = NULL;
+	AVPacket *packet = av_packet_alloc();
+
+	// Close the files (when done, or on errors)
+	auto close_all = [&]() {
+		if (input)
+			avformat_close_input(&input);
+		if (output) {
+			if (!(output->oformat->flags & AVFMT_NOFILE))
+				avio_closep(&output->pb);
+			avformat_free_context(output);
+		}
+		av_packet_free(&packet);
+	};
+
+	try {
+		if (avformat_open_input(&input, source_path.c_str(), NULL, NULL) != 0)
+			throw InvalidFile("Could not open the video file.", source_path);
+		if (avformat_find_stream_info(input, NULL) < 0)
+			throw NoStreamsFound("No streams found in the video file.", source_path);
+		int stream_index = av_find_best_stream(input, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+		if (stream_index < 0)
+			throw NoStreamsFound("No video stream found in the video file.", source_path);
+		AVStream *stream = input->streams[stream_index];
+
+		// A video only part, with the codec parameters (and time base) of the video file
+		avformat_alloc_output_context2(&output, NULL, NULL, part_path.c_str());
+		if (!output)
+			throw InvalidFormat("Could not deduce output format from file extension.", part_path);
+		AVStream *video_st = avformat_new_stream(output, NULL);
+		if (!video_st || avcodec_parameters_copy(video_st->codecpar, stream->codecpar) < 0)
+			throw InvalidCodec("Could not copy the video stream.", part_path);
+		video_st->codecpar->codec_tag = 0;
+		video_st->time_base = stream->time_base;
+		video_st->avg_frame_rate = av_make_q(fps.num, fps.den);
+		if (!(output->oformat->flags & AVFMT_NOFILE) && avio_open(&output->pb, part_path.c_str(), AVIO_FLAG_WRITE) < 0)
+			throw InvalidFile("Could not open or write file.", part_path);
+		if (avformat_write_header(output, NULL) < 0)
+			throw InvalidFile("Could not write header to file.", part_path);
+
+		// Timestamps of the first frame (a key frame), and the frame after the last frame (numbered like FFmpegReader)
+		int64_t start_time = first_frame_pts(input, stream);
+		AVRational frame_base = av_make_q(fps.den, fps.num);
+		int64_t first_pts = start_time + av_rescale_q(first - 1, frame_base, stream->time_base);
+		int64_t end_pts = start_time + av_rescale_q(last, frame_base, stream->time_base);
+		int64_t half_frame = av_rescale_q(1, frame_base, stream->time_base) / 2;
+
+		// Copy the packets (from the first key frame, until the key frame after the last frame)
+		bool copying = false;
+		av_seek_frame(input, stream_index, first_pts, AVSEEK_FLAG_BACKWARD);
+		while (av_read_frame(input, packet) >= 0) {
+			if (packet->stream_index != stream_index || packet->pts == AV_NOPTS_VALUE) {
+				av_packet_unref(packet);
+				continue;
+			}
+			bool is_key = packet->flags & AV_PKT_FLAG_KEY;
+			if (is_key && packet->pts >= end_pts - half_frame) {
+				av_packet_unref(packet);
+				break;
+			}
+			if (is_key && packet->pts >= first_pts - half_frame)
+				copying = true;
+
+			// Skip the packets before the first key frame (and frames of the previous GOP)
+			if (!copying || packet->pts < first_pts - half_frame) {
+				av_packet_unref(packet);
+				continue;
+			}
+
+			packet->pts -= first_pts;
+			if (packet->dts != AV_NOPTS_VALUE)
+				packet->dts -= first_pts;
+			av_packet_rescale_ts(packet, stream->time_base, video_st->time_base);
+			packet->stream_index = video_st->index;
+			packet->pos = -1;
+			int error_code = av_interleaved_write_frame(output, packet);
+			if (error_code < 0)
+				throw InvalidFile("Could not write the copied frames [" + av_err2string(error_code) + "].", part_path);
+		}
+
+		av_write_trailer(output);
+	} catch (...) {
+		close_all();
+		throw;
+	}
+	close_all();
+#else
+	throw InvalidFormat("Segmented exports require FFmpeg 3.2 or newer.", part_path);
+#endif // IS_FFMPEG_3_2
+}
+
+// Concatenate the video segments (and the audio) into the final file
+void SegmentExporter::concatenate(const std::vector<std::string>& segment_paths, const std::vector<int64_t>& segment_starts, const std::string& audio_path) {
+#if IS_FFMPEG_3_2
+	AVFormatContext *output = NULL;
+	std::vector<AVFormatContext *> inputs;
+	AVPacket *video_packet = av_packet_alloc();
+	AVPacket *audio_packet = av_packet_alloc();
+
+	// Close the files (when done, or on errors)
+	auto close_all = [&]() {
+		for (AVFormatContext *input : inputs)
+			avformat_close_input(&input);
+		if (output) {
+			if (!(output->oformat->flags & AVFMT_NOFILE))
+				avio_closep(&output->pb);
+			avformat_free_context(output);
+		}
+		av_packet_free(&video_packet);
+		av_packet_free(&audio_packet);
+	};
+
+	try {
+		// Open the segments (and audio)
+		for (size_t index = 0; index < segment_paths.size() + (audio_path.empty() ? 0 : 1); index++) {
+			const std::string& input_path = index < segment_paths.size() ? segment_paths[index] : audio_path;
+			AVFormatContext *input = NULL;
+			if (avformat_open_input(&input, input_path.c_str(), NULL, NULL) != 0)
+				throw InvalidFile("Could not open the segment.", input_path);
+			inputs.push_back(input);
+			if (avformat_find_stream_info(input, NULL) < 0 || input->nb_streams < 1)
+				throw NoStreamsFound("No streams found in the segment.", input_path);
+		}
+		AVFormatContext *audio_input = audio_path.empty() ? NULL : inputs.back();
+
+		// Create the final file, with the streams of the first segment (and the audio)
+		avformat_alloc_output_context2(&output, NULL, NULL, path.c_str());
+		if (!output)
+			throw InvalidFormat("Could not deduce output format from file extension.", path);
+		AVStream *video_st = avformat_new_stream(output, NULL);
+		if (!video_st || avcodec_parameters_copy(video_st->codecpar, inputs[0]->streams[0]->codecpar) < 0)
+			throw InvalidCodec("Could not copy the video stream.", path);
+		video_st->codecpar->codec_tag = 0;
+		video_st->time_base = inputs[0]->streams[0]->time_base;
+		video_st->avg_frame_rate = av_make_q(fps.num, fps.den);
+		AVStream *audio_st = NULL;
+		if (audio_input) {
+			audio_st = avformat_new_stream(output, NULL);
+			if (!audio_st || avcodec_parameters_copy(audio_st->codecpar, audio_input->streams[0]->codecpar) < 0)
+				throw InvalidCodec("Could not copy the audio stream.", path);
+			audio_st->codecpar->codec_tag = 0;
+			audio_st->time_base = audio_input->streams[0]->time_base;
+		}
+		if (!(output->oformat->flags & AVFMT_NOFILE) && avio_open(&output->pb, path.c_str(), AVIO_FLAG_WRITE) < 0)
+			throw InvalidFile("Could not open or write file.", path);
+		if (avformat_write_header(output, NULL) < 0)
+			throw InvalidFile("Could not write header to file.", path);
+
+		// Read the next video packet (of the current segment, or the next ones), offset by the segment's start
+		size_t segment = 0;
+		auto read_video = [&]() {
+			while (segment < segment_paths.size()) {
+				AVFormatContext *input = inputs[segment];
+				if (av_read_frame(input, video_packet) >= 0) {
+					if (video_packet->stream_index != 0) {
+						av_packet_unref(video_packet);
+						continue;
+					}
+					int64_t offset = av_rescale_q(segment_starts[segment] - segment_starts[0],
+												  av_make_q(fps.den, fps.num), video_st->time_base);
+					av_packet_rescale_ts(video_packet, input->streams[0]->time_base, video_st->time_base);
+					if (video_packet->pts != AV_NOPTS_VALUE)
+						video_packet->pts += offset;
+					if (video_packet->dts != AV_NOPTS_VALUE)
+						video_packet->dts += offset;
+					video_packet->stream_index = video_st->index;
+					video_packet->pos = -1;
+					return true;
+				}
+				segment++;
+			}
+			return false;
+		};
+
+		// Read the next audio packet
+		auto read_audio = [&]() {
+			while (audio_input && av_read_frame(audio_input, audio_packet) >= 0) {
+				if (audio_packet->stream_index == 0) {
+					av_packet_rescale_ts(audio_packet, audio_input->streams[0]->time_base, audio_st->time_base);
+					audio_packet->stream_index = audio_st->index;
+					audio_packet->pos = -1;
+					return true;
+				}
+				av_packet_unref(audio_packet);
+			}
+			return false;
+		};
+
+		// Interleave the packets (in order of their timestamps)
+		auto timestamp = [](AVPacket *packet) {
+			return packet->dts != AV_NOPTS_VALUE ? packet->dts : packet->pts;
+		};
+		bool has_video_packet = read_video();
+		bool has_audio_packet = read_audio();
+		while (has_video_packet || has_audio_packet) {
+			bool write_video = has_video_packet && (!has_audio_packet ||
+				av_compare_ts(timestamp(video_packet), video_st->time_base, timestamp(audio_packet), audio_st->time_base) <= 0);
+			int error_code = av_interleaved_write_frame(output, write_video ? video_packet : audio_packet);
+			if (error_code < 0)
+				throw InvalidFile("Could not write the joined segments [" + av_err2string(error_code) + "].", path);
+			if (write_video)
+				has_video_packet = read_video();
+			else
+				has_audio_packet = read_audio();
+		}
+
+		av_write_trailer(output);
+	} catch (...) {
+		close_all();
+		throw;
+	}
+	close_all();
+#else
+	throw InvalidFormat("Segmented exports require FFmpeg 3.2 or newer.", path);
+#endif // IS_FFMPEG_3_2
+}
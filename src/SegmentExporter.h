@@ -0,0 +1,195 @@
+/**
+ * @file
+ * @brief Header file for SegmentExporter class
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#ifndef OPENSHOT_SEGMENT_EXPORTER_H
+#define OPENSHOT_SEGMENT_EXPORTER_H
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ChannelLayouts.h"
+#include "Fraction.h"
+
+namespace openshot
+{
+	class FFmpegWriter;
+	class Timeline;
+
+	/**
+	 * @brief This class exports a timeline by encoding segments of it in parallel
+	 *
+	 * A single encoder (i.e. FFmpegWriter) only uses a few cores, so this class splits the frames into
+	 * segments (of whole GOPs), and renders each segment with its own copy of the timeline, and encodes it
+	 * with its own FFmpegWriter (in parallel). Each segment starts a new (closed) GOP. The audio is rendered
+	 * and encoded once (in parallel with the segments), and then the segments and audio are concatenated
+	 * into the final file (without re-encoding).
+	 *
+	 * Segments must be encoded by software encoders (with the same options, so the segments can be
+	 * concatenated).
+	 *
+	 * With passthrough (see SetPassthrough), segments which only show a single (untouched) clip, whose video
+	 * file matches the export (codec, size, frame rate and pixel format), are copied from the video file without
+	 * re-encoding, except for the frames before its first key frame, and after its last key frame, in the segment.
+	 * The copied and encoded frames share one video stream, so the video file must also have the same codec
+	 * parameters (global headers, profile, level and B-frame delay) as a probe encode with the export options.
+	 * Otherwise (i.e. most camera files) the whole segment is encoded.
+	 *
+	 * @code
+	 * SegmentExporter exporter(&timeline, "/home/jonathan/Videos/export.mp4");
+	 * exporter.SetVideoOptions(true, "libx264", Fraction(30, 1), 1920, 1080, Fraction(1, 1), false, false, 8000000);
+	 * exporter.SetAudioOptions(true, "aac", 44100, 2, LAYOUT_STEREO, 192000);
+	 * exporter.Export(1, 3000);
+	 * @endcode
+	 */
+	class SegmentExporter
+	{
+	private:
+		openshot::Timeline* timeline;
+		std::string path;
+		int segments;
+		int gop_size;
+		bool passthrough;
+		std::atomic<int64_t> frames_written;
+		std::atomic<int64_t> frames_total;
+
+		// Video options
+		bool has_video;
+		std::string video_codec;
+		openshot::Fraction fps;
+		int width;
+		int height;
+		openshot::Fraction pixel_ratio;
+		bool interlaced;
+		bool top_field_first;
+		int video_bit_rate;
+		std::map<std::string, std::string> video_options;
+
+		// Audio options
+		bool has_audio;
+		std::string audio_codec;
+		int sample_rate;
+		int channels;
+		openshot::ChannelLayout channel_layout;
+		int audio_bit_rate;
+
+		/// A part of the export (encoded, or copied from a video file)
+		struct Part {
+			int64_t start; ///< First frame number
+			int64_t end; ///< Last frame number
+			std::string source_path; ///< Video file to copy the frames from (if any)
+			int64_t source_start; ///< First frame number of the video file (if copied)
+		};
+
+		/// The codec parameters of the encoded parts, which copied parts must match (to share one video stream)
+		struct VideoParameters {
+			bool found; ///< Were the parameters found (by a probe encode)
+			std::string extradata; ///< The global headers (i.e. the SPS / PPS of H.264)
+			int profile; ///< The codec profile
+			int level; ///< The codec level
+			int video_delay; ///< The number of reordered frames (i.e. B-frames)
+		};
+		VideoParameters encoded_parameters;
+
+		/// Concatenate the video segments (and the audio) into the final file (without re-encoding)
+		void concatenate(const std::vector<std::string>& segment_paths, const std::vector<int64_t>& segment_starts, const std::string& audio_path);
+
+		/// Find the video file (and its first frame number) of a segment which only shows a single (untouched) clip
+		bool find_passthrough(int64_t start, int64_t end, std::string& source_path, int64_t& source_start);
+
+		/// Find the key frames (from first to last frame) of a video file which matches the export (or none)
+		std::vector<int64_t> find_keyframes(const std::string& source_path, int64_t first, int64_t last);
+
+		/// Encode a single frame with the export options, to find the codec parameters of the encoded parts
+		void probe_encoder(int gop);
+
+		/// Set the video options of a writer (the same for each encoded part)
+		void set_writer_options(openshot::FFmpegWriter& writer, int gop);
+
+		/// Split a segment into parts (copying the whole GOPs of a single, untouched clip, if possible)
+		void split_segment(int64_t start, int64_t end, std::vector<Part>& parts);
+
+		/// Render and encode the audio of the timeline (from start to end)
+		void write_audio(const std::string& json, const std::string& audio_path, int64_t start, int64_t end);
+
+		/// Copy the packets of frames (first to last, which start with a key frame) of a video file (without re-encoding)
+		void write_passthrough(const std::string& source_path, const std::string& part_path, int64_t first, int64_t last);
+
+		/// Render and encode a video segment of the timeline (from start to end, with GOPs of gop frames)
+		void write_segment(const std::string& json, const std::string& segment_path, int64_t start, int64_t end, int gop);
+
+	public:
+		/// @brief Constructor for SegmentExporter
+		/// @param timeline The timeline to export (copied for each segment, when exporting)
+		/// @param path The path of the exported file
+		SegmentExporter(openshot::Timeline* timeline, std::string path);
+
+		/// @brief Export frames of the timeline
+		/// @param start The first frame number to export
+		/// @param end The last frame number to export
+		void Export(int64_t start, int64_t end);
+
+		/// Get the number of frames in each GOP (and segments are multiples of GOPs)
+		int GetGopSize() const { return gop_size; }
+
+		/// Get the max number of segments (encoded in parallel)
+		int GetSegments() const { return segments; }
+
+		/// Are untouched segments copied from their video file (without re-encoding)
+		bool GetPassthrough() const { return passthrough; }
+
+		/// The progress of the export (from 0.0 to 1.0)
+		float Progress() const;
+
+		/// @brief Set audio export options (see FFmpegWriter::SetAudioOptions)
+		/// @param has_audio Does this file need an audio stream?
+		/// @param codec The codec used to encode the audio for this file
+		/// @param sample_rate The number of audio samples needed in this file
+		/// @param channels The number of audio channels needed in this file
+		/// @param channel_layout The 'layout' of audio channels (i.e. mono, stereo, surround, etc...)
+		/// @param bit_rate The audio bit rate used during encoding
+		void SetAudioOptions(bool has_audio, std::string codec, int sample_rate, int channels, openshot::ChannelLayout channel_layout, int bit_rate);
+
+		/// @brief Set the number of frames in each GOP (and segments are multiples of GOPs)
+		/// @param frames The number of frames between key frames
+		void SetGopSize(int frames);
+
+		/// @brief Set a video codec option (see FFmpegWriter::SetOption)
+		/// @param name The name of the option
+		/// @param value The value of the option
+		void SetOption(std::string name, std::string value);
+
+		/// @brief Copy segments which only show a single (untouched) clip from its video file (without re-encoding)
+		/// @param enable Copy untouched segments (if the video file matches the export)
+		void SetPassthrough(bool enable) { passthrough = enable; }
+
+		/// @brief Set the max number of segments (encoded in parallel)
+		/// @param new_segments The number of segments (defaults to the number of processors)
+		void SetSegments(int new_segments);
+
+		/// @brief Set video export options (see FFmpegWriter::SetVideoOptions)
+		/// @param has_video Does this file need a video stream
+		/// @param codec The codec used to encode the images in this video
+		/// @param fps The number of frames per second
+		/// @param width The width in pixels of this video
+		/// @param height The height in pixels of this video
+		/// @param pixel_ratio The shape of the pixels represented as a openshot::Fraction (1x1 is most common / square pixels)
+		/// @param interlaced Does this video need to be interlaced?
+		/// @param top_field_first Which frame should be used as the top field?
+		/// @param bit_rate The video bit rate used during encoding
+		void SetVideoOptions(bool has_video, std::string codec, openshot::Fraction fps, int width, int height, openshot::Fraction pixel_ratio, bool interlaced, bool top_field_first, int bit_rate);
+	};
+
+}
+
+#endif
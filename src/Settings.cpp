@@ -27,6 +27,7 @@ Settings *Settings::Instance()
 		m_pInstance = new Settings;
 		m_pInstance->HARDWARE_DECODER = 0;
 		m_pInstance->HIGH_QUALITY_SCALING = false;
+		m_pInstance->USE_PROXY_MEDIA = true;
 		m_pInstance->OMP_THREADS = 12;
 		m_pInstance->FF_THREADS = 8;
 		m_pInstance->DE_LIMIT_HEIGHT_MAX = 1100;
@@ -38,6 +39,8 @@ Settings *Settings::Instance()
 		m_pInstance->VIDEO_CACHE_MAX_PREROLL_FRAMES = 48;
 		m_pInstance->VIDEO_CACHE_MAX_FRAMES = 30 * 10;
 		m_pInstance->ENABLE_PLAYBACK_CACHING = true;
+		m_pInstance->REVERSE_PLAYBACK_MAX_FRAMES = 60;
+		m_pInstance->SKIP_NONREF_FRAMES_STEP = 0;
 		m_pInstance->PLAYBACK_AUDIO_DEVICE_NAME = "";
 		m_pInstance->PLAYBACK_AUDIO_DEVICE_TYPE = "";
 		m_pInstance->DEBUG_TO_STDERR = false;
@@ -64,6 +64,9 @@ namespace openshot {
 		/// Scale mode used in FFmpeg decoding and encoding (used as an optimization for faster previews)
 		bool HIGH_QUALITY_SCALING = false;
 
+		/// Read the low resolution proxy of a clip (if any, and if large enough for the preview size). Disable this when exporting.
+		bool USE_PROXY_MEDIA = true;
+
 		/// Number of threads of OpenMP
 		int OMP_THREADS = 12;
 
@@ -97,6 +100,12 @@ namespace openshot {
 		/// Enable/Disable the cache thread to pre-fetch and cache video frames before we need them
 		bool ENABLE_PLAYBACK_CACHING = true;
 
+		/// Max number of frames decoded (and cached) by a reader after one seek, when frames are requested backwards
+		int REVERSE_PLAYBACK_MAX_FRAMES = 60;
+
+		/// Skip decoding non-reference frames during playback at this speed or faster (see TimelineBase::preview_speed, 0 = never skip)
+		int SKIP_NONREF_FRAMES_STEP = 0;
+
 		/// The audio device name to use during playback
 		std::string PLAYBACK_AUDIO_DEVICE_NAME = "";
 
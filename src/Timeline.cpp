@@ -13,11 +13,13 @@
 #include "Timeline.h"
 
 #include "CacheBase.h"
+#include "CacheContent.h"
 #include "CacheDisk.h"
 #include "CacheMemory.h"
 #include "CrashHandler.h"
 #include "FrameMapper.h"
 #include "Exceptions.h"
+#include "Profiler.h"
 
 #include <QDir>
 #include <QFileInfo>
@@ -26,7 +28,7 @@ using namespace openshot;
 
 // Default Constructor for the timeline (which sets the canvas width and height)
 Timeline::Timeline(int width, int height, Fraction fps, int sample_rate, int channels, ChannelLayout channel_layout) :
-		is_open(false), auto_map_clips(true), managed_cache(true), path(""),
+		is_open(false), auto_map_clips(true), audio_only(false), managed_cache(true), path(""),
 		max_concurrent_frames(OPEN_MP_NUM_PROCESSORS), max_time(0.0)
 {
 	// Create CrashHandler and Attach (incase of errors)
@@ -67,6 +69,7 @@ Timeline::Timeline(int width, int height, Fraction fps, int sample_rate, int cha
 
 	// Init cache
 	final_cache = new CacheMemory();
+	content_cache = NULL;
 	final_cache->SetMaxBytesFromInfo(max_concurrent_frames * 4, info.width, info.height, info.sample_rate, info.channels);
 }
 
@@ -77,7 +80,7 @@ Timeline::Timeline(const ReaderInfo info) : Timeline::Timeline(
 
 // Constructor for the timeline (which loads a JSON structure from a file path, and initializes a timeline)
 Timeline::Timeline(const std::string& projectPath, bool convert_absolute_paths) :
-		is_open(false), auto_map_clips(true), managed_cache(true), path(projectPath),
+		is_open(false), auto_map_clips(true), audio_only(false), managed_cache(true), path(projectPath),
 		max_concurrent_frames(OPEN_MP_NUM_PROCESSORS), max_time(0.0) {
 
 	// Create CrashHandler and Attach (incase of errors)
@@ -85,6 +88,7 @@ Timeline::Timeline(const std::string& projectPath, bool convert_absolute_paths)
 
 	// Init final cache as NULL (will be created after loading json)
 	final_cache = NULL;
+	content_cache = NULL;
 
 	// Init viewport size (curve based, because it can be animated)
 	viewport_scale = Keyframe(100.0);
@@ -336,6 +340,7 @@ void Timeline::AddClip(Clip* clip)
 
 	// Assign timeline to clip
 	clip->ParentTimeline(this);
+	content_signatures.erase(clip);
 
 	// Clear cache of clip and nested reader (if any)
 	if (clip->Reader() && clip->Reader()->GetCache())
@@ -359,6 +364,7 @@ void Timeline::AddEffect(EffectBase* effect)
 {
 	// Assign timeline to effect
 	effect->ParentTimeline(this);
+	content_signatures.erase(effect);
 
 	// Add effect to list
 	effects.push_back(effect);
@@ -371,6 +377,7 @@ void Timeline::AddEffect(EffectBase* effect)
 void Timeline::RemoveEffect(EffectBase* effect)
 {
 	effects.remove(effect);
+	content_signatures.erase(effect);
 
 	// Delete effect object (if timeline allocated it)
 	bool allocated = allocated_effects.count(effect);
@@ -391,6 +398,7 @@ void Timeline::RemoveClip(Clip* clip)
 	const std::lock_guard<std::recursive_mutex> guard(getFrameMutex);
 
 	clips.remove(clip);
+	content_signatures.erase(clip);
 	
 	// Delete clip object (if timeline allocated it)
 	bool allocated = allocated_clips.count(clip);
@@ -512,6 +520,30 @@ void Timeline::ApplyMapperToClips()
 	}
 }
 
+// Only render audio (or both audio and video)
+void Timeline::AudioOnly(bool value)
+{
+	// Get lock (prevent getting frames while this happens)
+	const std::lock_guard<std::recursive_mutex> guard(getFrameMutex);
+
+	if (audio_only == value)
+		return;
+	audio_only = value;
+
+	if (audio_only) {
+		// Skip decoding video in all open clips (clips opened later are updated by update_open_clips)
+		for (auto clip : open_clips)
+			apply_audio_only_to_clip(clip.first);
+	} else {
+		// Close all open clips, so their readers decode video again when reopened
+		for (auto clip : clips)
+			update_open_clips(clip, false);
+	}
+
+	// Cached frames (including the readers' frames) were rendered in the other mode
+	ClearAllCache(true);
+}
+
 // Calculate time of a frame number, based on a framerate
 double Timeline::calculate_time(int64_t number, Fraction rate)
 {
@@ -522,6 +554,80 @@ double Timeline::calculate_time(int64_t number, Fraction rate)
 	return double(number - 1) / raw_fps;
 }
 
+// Get the content signature of a clip or effect (a hash of its properties, except its id and position)
+uint64_t Timeline::content_signature(ClipBase* object)
+{
+	// Signatures are cached until the timeline changes
+	auto existing_signature = content_signatures.find(object);
+	if (existing_signature != content_signatures.end())
+		return existing_signature->second;
+
+	// Duplicated or moved objects have the same content
+	Json::Value root = object->JsonValue();
+	root.removeMember("id");
+	root.removeMember("position");
+	root.removeMember("layer");
+	for (auto& effect : root["effects"])
+		effect.removeMember("id");
+
+	uint64_t signature = std::hash<std::string>()(root.toStyledString());
+	content_signatures[object] = signature;
+	return signature;
+}
+
+// Get the content key of a timeline frame (a hash of everything which determines the frame)
+uint64_t Timeline::content_key(int64_t requested_frame, const std::vector<Clip*>& nearby_clips)
+{
+	uint64_t key = 0;
+	auto combine = [&key](uint64_t value) {
+		key ^= value + 0x9e3779b97f4a7c15ULL + (key << 6) + (key >> 2);
+	};
+
+	// Timeline settings and background color
+	combine(preview_width);
+	combine(preview_height);
+	combine(info.fps.num);
+	combine(info.fps.den);
+	combine(info.sample_rate);
+	combine(info.channels);
+	combine(info.channel_layout);
+	combine(Frame::GetSamplesPerFrame(requested_frame, info.fps, info.sample_rate, info.channels));
+	combine(std::hash<std::string>()(color.GetColorHex(requested_frame)));
+	combine(audio_only);
+
+	// Visible clips (in layer order), and the frame of each clip
+	for (auto clip : nearby_clips) {
+		long clip_start_position = round(clip->Position() * info.fps.ToDouble()) + 1;
+		long clip_end_position = round((clip->Position() + clip->Duration()) * info.fps.ToDouble());
+		if (clip_start_position > requested_frame || clip_end_position < requested_frame)
+			continue;
+
+		long clip_start_frame = (clip->Start() * info.fps.ToDouble()) + 1;
+		combine(content_signature(clip));
+		combine(requested_frame - clip_start_position + clip_start_frame);
+		combine(clip->Layer());
+
+		// Attached clips depend on another object's timing
+		if (clip->GetAttachedClip() || clip->GetAttachedObject())
+			combine(requested_frame);
+	}
+
+	// Timeline effects (and the frame of each effect)
+	for (auto effect : effects) {
+		long effect_start_position = round(effect->Position() * info.fps.ToDouble()) + 1;
+		long effect_end_position = round((effect->Position() + (effect->Duration())) * info.fps.ToDouble());
+		if (effect_start_position > requested_frame || effect_end_position < requested_frame)
+			continue;
+
+		long effect_start_frame = (effect->Start() * info.fps.ToDouble()) + 1;
+		combine(content_signature(effect));
+		combine(requested_frame - effect_start_position + effect_start_frame);
+		combine(effect->Layer());
+	}
+
+	return key;
+}
+
 // Apply effects to the source frame (if any)
 std::shared_ptr<Frame> Timeline::apply_effects(std::shared_ptr<Frame> frame, int64_t timeline_frame_number, int layer)
 {
@@ -541,6 +647,10 @@ std::shared_ptr<Frame> Timeline::apply_effects(std::shared_ptr<Frame> frame, int
 
 		bool does_effect_intersect = (effect_start_position <= timeline_frame_number && effect_end_position >= timeline_frame_number && effect->Layer() == layer);
 
+		// Skip effects which only modify video (when only rendering audio)
+		if (audio_only && effect->info.has_video && !effect->info.has_audio)
+			does_effect_intersect = false;
+
 		// Debug output
 		ZmqLogger::Instance()->AppendDebugMethod(
 			"Timeline::apply_effects (Does effect intersect)",
@@ -563,6 +673,7 @@ std::shared_ptr<Frame> Timeline::apply_effects(std::shared_ptr<Frame> frame, int
 				"does_effect_intersect", does_effect_intersect);
 
 			// Apply the effect to this frame
+			ProfileScope profile("effect", effect);
 			frame = effect->GetFrame(frame, effect_frame_number);
 		}
 
@@ -613,13 +724,13 @@ std::shared_ptr<Frame> Timeline::GetOrCreateFrame(std::shared_ptr<Frame> backgro
 void Timeline::add_layer(std::shared_ptr<Frame> new_frame, Clip* source_clip, int64_t clip_frame_number, bool is_top_clip, float max_volume)
 {
     // Create timeline options (with details about this current frame request)
-    TimelineInfoStruct* options = new TimelineInfoStruct();
-    options->is_top_clip = is_top_clip;
+    TimelineInfoStruct options{};
+    options.is_top_clip = is_top_clip;
+    options.is_audio_only = audio_only;
 
     // Get the clip's frame, composited on top of the current timeline frame
 	std::shared_ptr<Frame> source_frame;
-	source_frame = GetOrCreateFrame(new_frame, source_clip, clip_frame_number, options);
-    delete options;
+	source_frame = GetOrCreateFrame(new_frame, source_clip, clip_frame_number, &options);
 
 	// No frame found... so bail
 	if (!source_frame)
@@ -641,43 +752,27 @@ void Timeline::add_layer(std::shared_ptr<Frame> new_frame, Clip* source_clip, in
 			"info.channels", info.channels,
 			"clip_frame_number", clip_frame_number);
 
-		if (source_frame->GetAudioChannelsCount() == info.channels && source_clip->has_audio.GetInt(clip_frame_number) != 0)
-			for (int channel = 0; channel < source_frame->GetAudioChannelsCount(); channel++)
-			{
-				// Get volume from previous frame and this frame
-				float previous_volume = source_clip->volume.GetValue(clip_frame_number - 1);
-				float volume = source_clip->volume.GetValue(clip_frame_number);
-				int channel_filter = source_clip->channel_filter.GetInt(clip_frame_number); // optional channel to filter (if not -1)
-				int channel_mapping = source_clip->channel_mapping.GetInt(clip_frame_number); // optional channel to map this channel to (if not -1)
-
-				// Apply volume mixing strategy
-				if (source_clip->mixing == VOLUME_MIX_AVERAGE && max_volume > 1.0) {
-					// Don't allow this clip to exceed 100% (divide volume equally between all overlapping clips with volume
-					previous_volume = previous_volume / max_volume;
-					volume = volume / max_volume;
-				}
-				else if (source_clip->mixing == VOLUME_MIX_REDUCE && max_volume > 1.0) {
-					// Reduce clip volume by a bit, hoping it will prevent exceeding 100% (but it is very possible it will)
-					previous_volume = previous_volume * 0.77;
-					volume = volume * 0.77;
-				}
-
-				// If channel filter enabled, check for correct channel (and skip non-matching channels)
-				if (channel_filter != -1 && channel_filter != channel)
-					continue; // skip to next channel
-
-				// If no volume on this frame or previous frame, do nothing
-				if (previous_volume == 0.0 && volume == 0.0)
-					continue; // skip to next channel
-
-				// If channel mapping disabled, just use the current channel
-				if (channel_mapping == -1)
-					channel_mapping = channel;
-
-				// Apply ramp to source frame (if needed)
-				if (!isEqual(previous_volume, 1.0) || !isEqual(volume, 1.0))
-					source_frame->ApplyGainRamp(channel_mapping, 0, source_frame->GetAudioSamplesCount(), previous_volume, volume);
+		if (source_frame->GetAudioChannelsCount() == info.channels && source_clip->has_audio.GetInt(clip_frame_number) != 0) {
+			// Get volume from previous frame and this frame
+			float previous_volume = source_clip->volume.GetValue(clip_frame_number - 1);
+			float volume = source_clip->volume.GetValue(clip_frame_number);
+			int channel_filter = source_clip->channel_filter.GetInt(clip_frame_number); // optional channel to filter (if not -1)
+			int channel_mapping = source_clip->channel_mapping.GetInt(clip_frame_number); // optional channel to map each channel to (if not -1)
+
+			// Apply volume mixing strategy
+			if (source_clip->mixing == VOLUME_MIX_AVERAGE && max_volume > 1.0) {
+				// Don't allow this clip to exceed 100% (divide volume equally between all overlapping clips with volume
+				previous_volume = previous_volume / max_volume;
+				volume = volume / max_volume;
+			}
+			else if (source_clip->mixing == VOLUME_MIX_REDUCE && max_volume > 1.0) {
+				// Reduce clip volume by a bit, hoping it will prevent exceeding 100% (but it is very possible it will)
+				previous_volume = previous_volume * 0.77;
+				volume = volume * 0.77;
+			}
 
+			// If no volume on this frame or previous frame, do nothing
+			if (previous_volume != 0.0 || volume != 0.0) {
 				// TODO: Improve FrameMapper (or Timeline) to always get the correct number of samples per frame.
 				// Currently, the ResampleContext sometimes leaves behind a few samples for the next call, and the
 				// number of samples returned is variable... and does not match the number expected.
@@ -686,10 +781,23 @@ void Timeline::add_layer(std::shared_ptr<Frame> new_frame, Clip* source_clip, in
 					// Force timeline frame to match the source frame
 					new_frame->ResizeAudio(info.channels, source_frame->GetAudioSamplesCount(), info.sample_rate, info.channel_layout);
 				}
-				// Copy audio samples (and set initial volume).  Mix samples with existing audio samples.  The gains are added together, to
-				// be sure to set the gain's correctly, so the sum does not exceed 1.0 (of audio distortion will happen).
-				new_frame->AddAudio(false, channel_mapping, 0, source_frame->GetAudioSamples(channel), source_frame->GetAudioSamplesCount(), 1.0);
+
+				for (int channel = 0; channel < source_frame->GetAudioChannelsCount(); channel++)
+				{
+					// If channel filter enabled, check for correct channel (and skip non-matching channels)
+					if (channel_filter != -1 && channel_filter != channel)
+						continue; // skip to next channel
+
+					// If channel mapping disabled, just use the current channel
+					int dest_channel = (channel_mapping == -1) ? channel : channel_mapping;
+
+					// Mix samples with existing audio samples, ramping the volume from the previous frame (in a single pass).
+					// The gains are added together, to be sure to set the gain's correctly, so the sum does not exceed 1.0
+					// (of audio distortion will happen).
+					new_frame->AddAudioWithRamp(dest_channel, 0, source_frame->GetAudioSamples(channel), source_frame->GetAudioSamplesCount(), previous_volume, volume);
+				}
 			}
+		}
 		else
 			// Debug output
 			ZmqLogger::Instance()->AppendDebugMethod(
@@ -706,8 +814,21 @@ void Timeline::add_layer(std::shared_ptr<Frame> new_frame, Clip* source_clip, in
 	ZmqLogger::Instance()->AppendDebugMethod(
 		"Timeline::add_layer (Transform: Composite Image Layer: Completed)",
 		"source_frame->number", source_frame->number,
-		"new_frame->GetImage()->width()", new_frame->GetImage()->width(),
-		"new_frame->GetImage()->height()", new_frame->GetImage()->height());
+		"new_frame->GetWidth()", new_frame->GetWidth(),
+		"new_frame->GetHeight()", new_frame->GetHeight());
+}
+
+// Skip decoding video in the reader of an open clip (when only rendering audio)
+void Timeline::apply_audio_only_to_clip(Clip* clip)
+{
+	// Find the clip's original reader (if mapped)
+	ReaderBase* clip_reader = clip->Reader();
+	if (clip_reader && clip_reader->Name() == "FrameMapper")
+		clip_reader = ((FrameMapper *) clip_reader)->Reader();
+
+	// Readers reset has_video when they are opened, so only override open readers
+	if (clip_reader && clip_reader->IsOpen())
+		clip_reader->info.has_video = false;
 }
 
 // Update the list of 'opened' clips
@@ -742,6 +863,10 @@ void Timeline::update_open_clips(Clip *clip, bool does_clip_intersect)
 			// Open the clip
 			clip->Open();
 
+			// Skip decoding video (if only rendering audio)
+			if (audio_only)
+				apply_audio_only_to_clip(clip);
+
 		} catch (const InvalidFile & e) {
 			// ...
 		}
@@ -888,6 +1013,9 @@ bool Timeline::isEqual(double a, double b)
 // Get an openshot::Frame object for a specific frame number of this reader.
 std::shared_ptr<Frame> Timeline::GetFrame(int64_t requested_frame)
 {
+	// Time the whole frame request (including cached frames)
+	ProfileScope profile("timeline", "GetFrame");
+
 	// Adjust out of bounds frame number
 	if (requested_frame < 1)
 		requested_frame = 1;
@@ -900,6 +1028,7 @@ std::shared_ptr<Frame> Timeline::GetFrame(int64_t requested_frame)
 		ZmqLogger::Instance()->AppendDebugMethod(
 			"Timeline::GetFrame (Cached frame found)",
 			"requested_frame", requested_frame);
+		Profiler::Instance()->Count("cache", "hit");
 
 		// Return cached frame
 		return frame;
@@ -917,6 +1046,7 @@ std::shared_ptr<Frame> Timeline::GetFrame(int64_t requested_frame)
             ZmqLogger::Instance()->AppendDebugMethod(
                     "Timeline::GetFrame (Cached frame found on 2nd check)",
                     "requested_frame", requested_frame);
+            Profiler::Instance()->Count("cache", "hit");
 
             // Return cached frame
             return frame;
@@ -926,17 +1056,40 @@ std::shared_ptr<Frame> Timeline::GetFrame(int64_t requested_frame)
             std::vector<Clip *> nearby_clips;
             nearby_clips = find_intersecting_clips(requested_frame, 1, true);
 
+            // Reuse identical content (if the cache is content-addressed)
+            uint64_t key = 0;
+            if (content_cache) {
+                key = content_key(requested_frame, nearby_clips);
+                frame = content_cache->GetFrame(requested_frame, key);
+                if (frame) {
+                    // Debug output
+                    ZmqLogger::Instance()->AppendDebugMethod(
+                            "Timeline::GetFrame (Cached content found)",
+                            "requested_frame", requested_frame);
+                    Profiler::Instance()->Count("cache", "content hit");
+
+                    // Return cached frame
+                    return frame;
+                }
+            }
+
             // Debug output
             ZmqLogger::Instance()->AppendDebugMethod(
                     "Timeline::GetFrame (processing frame)",
                     "requested_frame", requested_frame,
                     "omp_get_thread_num()", omp_get_thread_num());
+            Profiler::Instance()->Count("cache", "miss");
 
             // Init some basic properties about this frame
             int samples_in_frame = Frame::GetSamplesPerFrame(requested_frame, info.fps, info.sample_rate, info.channels);
 
             // Create blank frame (which will become the requested frame)
-            std::shared_ptr<Frame> new_frame(std::make_shared<Frame>(requested_frame, preview_width, preview_height, "#000000", samples_in_frame, info.channels));
+            // When only rendering audio, the frame has no image (and no background color)
+            std::shared_ptr<Frame> new_frame;
+            if (audio_only)
+                new_frame = std::make_shared<Frame>(requested_frame, samples_in_frame, info.channels);
+            else
+                new_frame = std::make_shared<Frame>(requested_frame, preview_width, preview_height, "#000000", samples_in_frame, info.channels);
             new_frame->AddAudioSilence(samples_in_frame);
             new_frame->SampleRate(info.sample_rate);
             new_frame->ChannelsLayout(info.channel_layout);
@@ -949,9 +1102,10 @@ std::shared_ptr<Frame> Timeline::GetFrame(int64_t requested_frame)
                     "info.height", info.height);
 
             // Add Background Color to 1st layer (if animated or not black)
-            if ((color.red.GetCount() > 1 || color.green.GetCount() > 1 || color.blue.GetCount() > 1) ||
-                (color.red.GetValue(requested_frame) != 0.0 || color.green.GetValue(requested_frame) != 0.0 ||
-                 color.blue.GetValue(requested_frame) != 0.0))
+            if (!audio_only &&
+                ((color.red.GetCount() > 1 || color.green.GetCount() > 1 || color.blue.GetCount() > 1) ||
+                 (color.red.GetValue(requested_frame) != 0.0 || color.green.GetValue(requested_frame) != 0.0 ||
+                  color.blue.GetValue(requested_frame) != 0.0)))
                 new_frame->AddColor(preview_width, preview_height, color.GetColorHex(requested_frame));
 
             // Debug output
@@ -1037,7 +1191,10 @@ std::shared_ptr<Frame> Timeline::GetFrame(int64_t requested_frame)
             new_frame->SetFrameNumber(requested_frame);
 
             // Add final frame to cache
-            final_cache->Add(new_frame);
+            if (content_cache)
+                content_cache->Add(new_frame, key);
+            else
+                final_cache->Add(new_frame);
 
             // Return frame (or blank frame)
             return new_frame;
@@ -1103,8 +1260,9 @@ void Timeline::SetCache(CacheBase* new_cache) {
 		managed_cache = false;
 	}
 
-	// Set new cache
+	// Set new cache (and check once if it's content-addressed)
 	final_cache = new_cache;
+	content_cache = dynamic_cast<CacheContent*>(new_cache);
 }
 
 // Generate JSON string of this object
@@ -1148,6 +1306,13 @@ Json::Value Timeline::JsonValue() const {
 	return root;
 }
 
+// Generate JSON string of the render-time profiling data
+std::string Timeline::ProfileJson() const {
+
+	// Profiling data is collected by all timelines (and clips / readers outside of a timeline)
+	return Profiler::Instance()->Json();
+}
+
 // Load JSON string into this object
 void Timeline::SetJson(const std::string value) {
 
@@ -1174,9 +1339,10 @@ void Timeline::SetJsonValue(const Json::Value root) {
 	// Get lock (prevent getting frames while this happens)
 	const std::lock_guard<std::recursive_mutex> lock(getFrameMutex);
 
-	// Close timeline before we do anything (this closes all clips)
-	bool was_open = is_open;
-	Close();
+	// Keep the previous settings (to detect changes which invalidate every frame)
+	ReaderInfo previous_info = info;
+	int previous_preview_width = preview_width;
+	int previous_preview_height = preview_height;
 
 	// Set parent data
 	ReaderBase::SetJsonValue(root);
@@ -1185,36 +1351,127 @@ void Timeline::SetJsonValue(const Json::Value root) {
 	if (!root["path"].isNull())
 		path = root["path"].asString();
 
+	// Changes to the frame rate or audio format require all clips to be re-mapped
+	bool mapping_changed = info.fps.num != previous_info.fps.num || info.fps.den != previous_info.fps.den ||
+						   info.sample_rate != previous_info.sample_rate || info.channels != previous_info.channels ||
+						   info.channel_layout != previous_info.channel_layout;
+	bool size_changed = info.width != previous_info.width || info.height != previous_info.height;
+
 	if (!root["clips"].isNull()) {
-		// Clear existing clips
-		clips.clear();
+		// Reconcile clips by ID: unchanged clips are kept as-is (with their open readers and caches),
+		// changed clips are updated in place, and only missing clips are removed.
+		std::set<Clip*> kept_clips;
+		std::set<Clip*> changed_clips;
+		std::vector<Clip*> new_clips;
 
 		// loop through clips
 		for (const Json::Value existing_clip : root["clips"]) {
-			// Create Clip
-			Clip *c = new Clip();
+			// Find matching clip in timeline (if any)
+			Clip *c = NULL;
+			std::string clip_id = existing_clip["id"].asString();
+			for (auto clip : clips) {
+				if (!clip_id.empty() && clip->Id() == clip_id && !kept_clips.count(clip)) {
+					c = clip;
+					break;
+				}
+			}
+
+			if (c) {
+				// Keep track of reconciled clips
+				kept_clips.insert(c);
 
-			// Keep track of allocated clip objects
-			allocated_clips.insert(c);
+				// Compare the current clip properties (the reader is compared separately,
+				// since it might be wrapped in a FrameMapper)
+				Json::Value current_clip = c->JsonValue();
+				current_clip.removeMember("reader");
+				bool reader_changed = !existing_clip["reader"].isNull() && !c->IsSameReader(existing_clip["reader"]);
+				if (!reader_changed && openshot::jsonIsUnchanged(current_clip, existing_clip))
+					continue; // clip is unchanged
 
-			// When a clip is attached to an object, it searches for the object
-			// on it's parent timeline. Setting the parent timeline of the clip here
-			// allows attaching it to an object when exporting the project (because)
-			// the exporter script initializes the clip and it's effects
-			// before setting its parent timeline.
-			c->ParentTimeline(this);
+				// Remove frames from the old position of the clip
+				invalidate_cache(c->Position(), c->Duration());
+				changed_clips.insert(c);
 
-			// Load Json into Clip
-			c->SetJsonValue(existing_clip);
+				// Update clip properties from JSON
+				std::vector<float> previous_scale = clip_image_scale(c);
+				c->SetJsonValue(existing_clip);
 
-			// Add Clip to Timeline
-			AddClip(c);
+				// Apply framemapper (only needed for new readers, since re-mapping clears the mapper's cache)
+				if (auto_map_clips && reader_changed && !mapping_changed)
+					apply_mapper_to_clip(c);
+
+				// The readers decode images at a size based on the scaling of the clip, so their
+				// cached frames are only kept when the reader and the scaling are unchanged
+				if (reader_changed || previous_scale != clip_image_scale(c))
+					clear_clip_cache(c);
+
+				// Remove frames from the new position of the clip
+				invalidate_cache(c->Position(), c->Duration());
+
+			} else {
+				// Create Clip
+				c = new Clip();
+
+				// Keep track of allocated clip objects
+				allocated_clips.insert(c);
+
+				// When a clip is attached to an object, it searches for the object
+				// on it's parent timeline. Setting the parent timeline of the clip here
+				// allows attaching it to an object when exporting the project (because)
+				// the exporter script initializes the clip and it's effects
+				// before setting its parent timeline.
+				c->ParentTimeline(this);
+
+				// Load Json into Clip
+				c->SetJsonValue(existing_clip);
+
+				// Add Clip to Timeline (after removing missing clips)
+				new_clips.push_back(c);
+			}
+		}
+
+		// Remove clips which are no longer part of the JSON
+		std::list<Clip*> removed_clips;
+		for (auto clip : clips) {
+			if (!kept_clips.count(clip))
+				removed_clips.push_back(clip);
+		}
+		for (auto clip : removed_clips) {
+			// Remove frames from the old position of the clip
+			invalidate_cache(clip->Position(), clip->Duration());
+			changed_clips.insert(clip);
+
+			// Close clip and remove it from timeline
+			update_open_clips(clip, false);
+			clips.remove(clip);
+
+			// Delete clip object (if timeline allocated it)
+			if (allocated_clips.count(clip)) {
+				allocated_clips.erase(clip);
+				delete clip;
+			}
+		}
+
+		// Add new clips to timeline
+		for (auto clip : new_clips) {
+			invalidate_cache(clip->Position(), clip->Duration());
+			AddClip(clip);
+		}
+
+		// Clips attached to a changed (or removed) clip must be re-attached and re-rendered
+		for (auto clip : clips) {
+			if (clip->GetAttachedClip() && changed_clips.count(clip->GetAttachedClip())) {
+				clip->SetAttachedClip(NULL);
+				clip->AttachToObject(clip->GetAttachedId());
+				invalidate_cache(clip->Position(), clip->Duration());
+			}
 		}
 	}
 
 	if (!root["effects"].isNull()) {
-		// Clear existing effects
-		effects.clear();
+		// Reconcile effects by ID (the same as clips)
+		std::set<EffectBase*> kept_effects;
+		std::vector<EffectBase*> new_effects;
 
 		// loop through effects
 		for (const Json::Value existing_effect :root["effects"]) {
@@ -1222,8 +1479,31 @@ void Timeline::SetJsonValue(const Json::Value root) {
 			EffectBase *e = NULL;
 
 			if (!existing_effect["type"].isNull()) {
+				// Find matching effect in timeline (if any)
+				std::string effect_id = existing_effect["id"].asString();
+				for (auto effect : effects) {
+					if (!effect_id.empty() && effect->Id() == effect_id && !kept_effects.count(effect) &&
+						effect->info.class_name == existing_effect["type"].asString()) {
+						e = effect;
+						break;
+					}
+				}
+
+				if (e) {
+					// Keep track of reconciled effects
+					kept_effects.insert(e);
+
+					// Skip unchanged effects
+					if (openshot::jsonIsUnchanged(e->JsonValue(), existing_effect))
+						continue;
+
+					// Update effect properties from JSON (and remove frames from the old and new position)
+					invalidate_cache(e->Position(), e->Duration());
+					e->SetJsonValue(existing_effect);
+					invalidate_cache(e->Position(), e->Duration());
+
 				// Create instance of effect
-				if ( (e = EffectInfo().CreateEffect(existing_effect["type"].asString())) ) {
+				} else if ( (e = EffectInfo().CreateEffect(existing_effect["type"].asString())) ) {
 
 					// Keep track of allocated effect objects
 					allocated_effects.insert(e);
@@ -1231,11 +1511,35 @@ void Timeline::SetJsonValue(const Json::Value root) {
 					// Load Json into Effect
 					e->SetJsonValue(existing_effect);
 
-					// Add Effect to Timeline
-					AddEffect(e);
+					// Add Effect to Timeline (after removing missing effects)
+					new_effects.push_back(e);
 				}
 			}
 		}
+
+		// Remove effects which are no longer part of the JSON
+		std::list<EffectBase*> removed_effects;
+		for (auto effect : effects) {
+			if (!kept_effects.count(effect))
+				removed_effects.push_back(effect);
+		}
+		for (auto effect : removed_effects) {
+			// Remove frames from the old position of the effect
+			invalidate_cache(effect->Position(), effect->Duration());
+			effects.remove(effect);
+
+			// Delete effect object (if timeline allocated it)
+			if (allocated_effects.count(effect)) {
+				allocated_effects.erase(effect);
+				delete effect;
+			}
+		}
+
+		// Add new effects to timeline
+		for (auto effect : new_effects) {
+			invalidate_cache(effect->Position(), effect->Duration());
+			AddEffect(effect);
+		}
 	}
 
 	if (!root["duration"].isNull()) {
@@ -1247,10 +1551,23 @@ void Timeline::SetJsonValue(const Json::Value root) {
 	// Update preview settings
 	preview_width = info.width;
 	preview_height = info.height;
+	bool preview_changed = preview_width != previous_preview_width || preview_height != previous_preview_height;
 
-	// Re-open if needed
-	if (was_open)
-		Open();
+	if (mapping_changed) {
+		// Re-map all clips to the new frame rate and audio format (this clears all cache)
+		if (auto_map_clips)
+			ApplyMapperToClips();
+		else
+			ClearAllCache();
+	}
+	if (preview_changed) {
+		// Every cached frame (and every image decoded by the readers) has the wrong size
+		ClearAllCache(true);
+	}
+	else if (size_changed && final_cache) {
+		// Every cached frame has the wrong size
+		final_cache->Clear();
+	}
 }
 
 // Apply a special formatted JSON object, which represents a change to the timeline (insert, update, delete)
@@ -1338,14 +1655,9 @@ void Timeline::apply_json_to_clips(Json::Value change) {
 				for (auto e : effect_list)
 				{
 					if (e->Id() == effect_id) {
-						// Apply the change to the effect directly
+						// Apply the change to the effect directly (which also removes the affected frames from the cache)
 						apply_json_to_effects(change, e);
 
-						// Calculate start and end frames that this impacts, and remove those frames from the cache
-                        int64_t new_starting_frame = (existing_clip->Position() * info.fps.ToDouble()) + 1;
-                        int64_t new_ending_frame = ((existing_clip->Position() + existing_clip->Duration()) * info.fps.ToDouble()) + 1;
-                        final_cache->Remove(new_starting_frame - 8, new_ending_frame + 8);
-
 						return; // effect found, don't update clip
 					}
 				}
@@ -1353,13 +1665,6 @@ void Timeline::apply_json_to_clips(Json::Value change) {
 		}
 	}
 
-	// Calculate start and end frames that this impacts, and remove those frames from the cache
-	if (!change["value"].isArray() && !change["value"]["position"].isNull()) {
-		int64_t new_starting_frame = (change["value"]["position"].asDouble() * info.fps.ToDouble()) + 1;
-		int64_t new_ending_frame = ((change["value"]["position"].asDouble() + change["value"]["end"].asDouble() - change["value"]["start"].asDouble()) * info.fps.ToDouble()) + 1;
-		final_cache->Remove(new_starting_frame - 8, new_ending_frame + 8);
-	}
-
 	// Determine type of change operation
 	if (change_type == "insert") {
 
@@ -1372,6 +1677,9 @@ void Timeline::apply_json_to_clips(Json::Value change) {
 		// Set properties of clip from JSON
 		clip->SetJsonValue(change["value"]);
 
+		// Remove the frames covered by the new clip from the cache
+		invalidate_cache(clip->Position(), clip->Duration());
+
 		// Add clip to timeline
 		AddClip(clip);
 
@@ -1380,22 +1688,35 @@ void Timeline::apply_json_to_clips(Json::Value change) {
 		// Update existing clip
 		if (existing_clip) {
 
-			// Calculate start and end frames that this impacts, and remove those frames from the cache
-			int64_t old_starting_frame = (existing_clip->Position() * info.fps.ToDouble()) + 1;
-			int64_t old_ending_frame = ((existing_clip->Position() + existing_clip->Duration()) * info.fps.ToDouble()) + 1;
-			final_cache->Remove(old_starting_frame - 8, old_ending_frame + 8);
-
-			// Remove cache on clip's Reader (if found)
-			if (existing_clip->Reader() && existing_clip->Reader()->GetCache())
-				existing_clip->Reader()->GetCache()->Remove(old_starting_frame - 8, old_ending_frame + 8);
+			// Keep the previous state of the clip (to determine which frames are affected by this change)
+			Json::Value previous_json = existing_clip->JsonValue();
+			std::vector<float> previous_scale = clip_image_scale(existing_clip);
 
 			// Update clip properties from JSON
 			existing_clip->SetJsonValue(change["value"]);
+			Json::Value current_json = existing_clip->JsonValue();
+			bool reader_changed = !jsonIsUnchanged(previous_json["reader"], current_json["reader"]);
 
-			// Apply framemapper (or update existing framemapper)
-			if (auto_map_clips) {
+			// Apply framemapper (only needed when the reader was replaced, since
+			// updating an existing framemapper clears its cache)
+			if (auto_map_clips && (reader_changed || existing_clip->Reader()->Name() != "FrameMapper")) {
 				apply_mapper_to_clip(existing_clip);
 			}
+
+			// The readers decode images at a size based on the scaling of the clip, so their
+			// cached frames are only kept when the reader and the scaling are unchanged
+			if (reader_changed || previous_scale != clip_image_scale(existing_clip))
+				clear_clip_cache(existing_clip);
+
+			// Remove only the affected frames from the cache
+			if (!jsonIsUnchanged(previous_json, current_json)) {
+				invalidate_cache(previous_json, current_json, NULL);
+
+				// Clips attached to this clip follow its changes
+				for (auto clip : clips)
+					if (clip->GetAttachedClip() == existing_clip)
+						invalidate_cache(clip->Position(), clip->Duration());
+			}
 		}
 
 	} else if (change_type == "delete") {
@@ -1461,13 +1782,6 @@ void Timeline::apply_json_to_effects(Json::Value change, EffectBase* existing_ef
 	// Get key and type of change
 	std::string change_type = change["type"].asString();
 
-	// Calculate start and end frames that this impacts, and remove those frames from the cache
-	if (!change["value"].isArray() && !change["value"]["position"].isNull()) {
-		int64_t new_starting_frame = (change["value"]["position"].asDouble() * info.fps.ToDouble()) + 1;
-		int64_t new_ending_frame = ((change["value"]["position"].asDouble() + change["value"]["end"].asDouble() - change["value"]["start"].asDouble()) * info.fps.ToDouble()) + 1;
-		final_cache->Remove(new_starting_frame - 8, new_ending_frame + 8);
-	}
-
 	// Determine type of change operation
 	if (change_type == "insert") {
 
@@ -1486,6 +1800,9 @@ void Timeline::apply_json_to_effects(Json::Value change, EffectBase* existing_ef
 			// Load Json into Effect
 			e->SetJsonValue(change["value"]);
 
+			// Remove the frames covered by the new effect from the cache
+			invalidate_cache(e->Position(), e->Duration());
+
 			// Add Effect to Timeline
 			AddEffect(e);
 		}
@@ -1495,13 +1812,14 @@ void Timeline::apply_json_to_effects(Json::Value change, EffectBase* existing_ef
 		// Update existing effect
 		if (existing_effect) {
 
-			// Calculate start and end frames that this impacts, and remove those frames from the cache
-			int64_t old_starting_frame = (existing_effect->Position() * info.fps.ToDouble()) + 1;
-			int64_t old_ending_frame = ((existing_effect->Position() + existing_effect->Duration()) * info.fps.ToDouble()) + 1;
-			final_cache->Remove(old_starting_frame - 8, old_ending_frame + 8);
+			// Keep the previous state of the effect (to determine which frames are affected by this change)
+			Json::Value previous_json = existing_effect->JsonValue();
 
 			// Update effect properties from JSON
 			existing_effect->SetJsonValue(change["value"]);
+
+			// Remove only the affected frames from the cache (effects on a clip use the clip's frames)
+			invalidate_cache(previous_json, existing_effect->JsonValue(), existing_effect->ParentClip());
 		}
 
 	} else if (change_type == "delete") {
@@ -1509,10 +1827,11 @@ void Timeline::apply_json_to_effects(Json::Value change, EffectBase* existing_ef
 		// Remove existing effect
 		if (existing_effect) {
 
-			// Calculate start and end frames that this impacts, and remove those frames from the cache
-			int64_t old_starting_frame = (existing_effect->Position() * info.fps.ToDouble()) + 1;
-			int64_t old_ending_frame = ((existing_effect->Position() + existing_effect->Duration()) * info.fps.ToDouble()) + 1;
-			final_cache->Remove(old_starting_frame - 8, old_ending_frame + 8);
+			// Remove the frames covered by the effect (or its parent clip) from the cache
+			if (existing_effect->ParentClip())
+				invalidate_cache(existing_effect->ParentClip()->Position(), existing_effect->ParentClip()->Duration());
+			else
+				invalidate_cache(existing_effect->Position(), existing_effect->Duration());
 
 			// Remove effect from timeline
 			RemoveEffect(existing_effect);
@@ -1652,9 +1971,131 @@ void Timeline::apply_json_to_timeline(Json::Value change) {
 	}
 }
 
+// Remove the frames of a clip or effect (at a given position and duration) from the final cache
+void Timeline::invalidate_cache(double position, double duration) {
+	// Clips or effects have changed
+	content_signatures.clear();
+	if (!final_cache)
+		return;
+
+	// Calculate start and end frames that this impacts, and remove those frames from the cache
+	int64_t starting_frame = (position * info.fps.ToDouble()) + 1;
+	int64_t ending_frame = ((position + duration) * info.fps.ToDouble()) + 1;
+	final_cache->Remove(starting_frame - 8, ending_frame + 8);
+}
+
+// Remove the frames affected by a change to a clip or effect (from its previous to its current JSON) from the final cache
+void Timeline::invalidate_cache(const Json::Value& previous_json, const Json::Value& current_json, ClipBase* parent_clip) {
+	// Clips or effects have changed
+	content_signatures.clear();
+	if (!final_cache)
+		return;
+
+	// Effects on a clip are evaluated with the frame numbers of their parent clip
+	double position = parent_clip ? parent_clip->Position() : current_json["position"].asDouble();
+	double start = parent_clip ? parent_clip->Start() : current_json["start"].asDouble();
+	double end = parent_clip ? parent_clip->End() : current_json["end"].asDouble();
+
+	// Moving, trimming, re-timing, or replacing the reader affects every frame (at the old and new position)
+	for (const auto key : {"position", "start", "end", "layer", "time", "reader"}) {
+		if (!jsonIsUnchanged(previous_json[key], current_json[key])) {
+			if (!parent_clip)
+				invalidate_cache(previous_json["position"].asDouble(), previous_json["end"].asDouble() - previous_json["start"].asDouble());
+			invalidate_cache(position, end - start);
+			return;
+		}
+	}
+
+	// Find the frames where the interpolated keyframe values changed
+	double fps = info.fps.ToDouble();
+	int64_t start_frame = (start * fps) + 1;
+	int64_t end_frame = (end * fps) + 1;
+	int64_t first_frame = end_frame + 1;
+	int64_t last_frame = start_frame - 1;
+	if (!find_changed_frames(previous_json, current_json, start_frame, end_frame, first_frame, last_frame)) {
+		// A non-keyframe property changed (which affects every frame)
+		invalidate_cache(position, end - start);
+		return;
+	}
+
+	if (first_frame <= last_frame) {
+		// Convert to timeline frame numbers (and include the neighbouring frames, which
+		// depend on the previous frame's values, i.e. volume ramps)
+		int64_t offset = (round(position * fps) + 1) - start_frame;
+		final_cache->Remove(first_frame + offset - 1, last_frame + offset + 1);
+	}
+}
+
+// Find the range of frames affected by keyframe changes (returns false if a non-keyframe property changed)
+bool Timeline::find_changed_frames(const Json::Value& previous_json, const Json::Value& current_json,
+								   int64_t min_frame, int64_t max_frame, int64_t& first_frame, int64_t& last_frame) {
+	if (previous_json.isObject() && current_json.isObject()) {
+		if (current_json.isMember("Points")) {
+			// Compare the interpolated values of both keyframes
+			Keyframe previous_keyframe;
+			Keyframe current_keyframe;
+			previous_keyframe.SetJsonValue(previous_json);
+			current_keyframe.SetJsonValue(current_json);
+
+			int64_t first = 0;
+			int64_t last = 0;
+			if (current_keyframe.GetChangedRange(previous_keyframe, min_frame, max_frame, first, last)) {
+				first_frame = std::min(first_frame, first);
+				last_frame = std::max(last_frame, last);
+			}
+			return true;
+		}
+
+		// Compare each property (i.e. the red, green, blue, and alpha keyframes of a color)
+		for (const auto& name : current_json.getMemberNames())
+			if (!find_changed_frames(previous_json[name], current_json[name], min_frame, max_frame, first_frame, last_frame))
+				return false;
+		return true;
+	}
+
+	if (previous_json.isArray() && current_json.isArray() && previous_json.size() == current_json.size()) {
+		// Compare each item (i.e. the effects of a clip)
+		for (Json::ArrayIndex index = 0; index < current_json.size(); index++)
+			if (!find_changed_frames(previous_json[index], current_json[index], min_frame, max_frame, first_frame, last_frame))
+				return false;
+		return true;
+	}
+
+	return jsonIsUnchanged(previous_json, current_json);
+}
+
+// Get the properties of a clip which determine the size of its decoded images (see FFmpegReader::GetTargetSize)
+std::vector<float> Timeline::clip_image_scale(Clip* clip) {
+	return {float(clip->scale), float(clip->scale_x.GetMaxPoint().co.Y), float(clip->scale_y.GetMaxPoint().co.Y)};
+}
+
+// Clear the cached frames of a clip's reader (and of the reader wrapped by its FrameMapper)
+void Timeline::clear_clip_cache(Clip* clip) {
+	try {
+		// Proxy images are decoded at a size based on the scaling of the clip too
+		if (clip->Proxy() && clip->Proxy()->GetCache())
+			clip->Proxy()->GetCache()->Clear();
+
+		if (!clip->Reader()->GetCache())
+			return;
+		clip->Reader()->GetCache()->Clear();
+
+		if (clip->Reader()->Name() == "FrameMapper") {
+			FrameMapper *nested_reader = (FrameMapper *) clip->Reader();
+			if (nested_reader->Reader() && nested_reader->Reader()->GetCache())
+				nested_reader->Reader()->GetCache()->Clear();
+		}
+	} catch (const ReaderClosed & e) {
+		// ...
+	}
+}
+
 // Clear all caches
 void Timeline::ClearAllCache(bool deep) {
 
+	// Clear content signatures of clips and effects
+	content_signatures.clear();
+
 	// Clear primary cache
 	if (final_cache) {
 		final_cache->Clear();
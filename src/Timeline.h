@@ -42,6 +42,7 @@ namespace openshot {
 	// Forward decls
 	class FrameMapper;
 	class CacheBase;
+	class CacheContent;
 
 	/// Comparison method for sorting clip pointers (by Layer and then Position). Clips are sorted
 	/// from lowest layer to top layer (since that is the sequence they need to be combined), and then
@@ -151,6 +152,7 @@ namespace openshot {
 	private:
 		bool is_open; ///<Is Timeline Open?
 		bool auto_map_clips; ///< Auto map framerates and sample rates to all clips
+		bool audio_only; ///< Only render audio (no images, video decoding, or video effects)
 		std::list<openshot::Clip*> clips; ///<List of clips on this timeline
 		std::list<openshot::Clip*> closing_clips; ///<List of clips that need to be closed
 		std::map<openshot::Clip*, openshot::Clip*> open_clips; ///<List of 'opened' clips on this timeline
@@ -158,6 +160,7 @@ namespace openshot {
 		std::list<openshot::EffectBase*> effects; ///<List of clips on this timeline
 		std::set<openshot::EffectBase*> allocated_effects; ///<List of effects that were allocated by this timeline
 		openshot::CacheBase *final_cache; ///<Final cache of timeline frames
+		openshot::CacheContent *content_cache; ///< The final cache, if it's content-addressed (or NULL)
 		std::set<openshot::FrameMapper*> allocated_frame_mappers; ///< all the frame mappers we allocated and must free
 		bool managed_cache; ///< Does this timeline instance manage the cache object
 		std::string path; ///< Optional path of loaded UTF-8 OpenShot JSON project file
@@ -165,10 +168,14 @@ namespace openshot {
 		double max_time; ///> The max duration (in seconds) of the timeline, based on all the clips
 
 		std::map<std::string, std::shared_ptr<openshot::TrackedObjectBase>> tracked_objects; ///< map of TrackedObjectBBoxes and their IDs
+		std::map<openshot::ClipBase*, uint64_t> content_signatures; ///< Content signatures of clips and effects (used by CacheContent)
 
 		/// Process a new layer of video or audio
 		void add_layer(std::shared_ptr<openshot::Frame> new_frame, openshot::Clip* source_clip, int64_t clip_frame_number, bool is_top_clip, float max_volume);
 
+		/// Skip decoding video in the reader of an open clip (when only rendering audio)
+		void apply_audio_only_to_clip(openshot::Clip* clip);
+
 		/// Apply a FrameMapper to a clip which matches the settings of this timeline
 		void apply_mapper_to_clip(openshot::Clip* clip);
 
@@ -184,6 +191,29 @@ namespace openshot {
 		/// Calculate time of a frame number, based on a framerate
 		double calculate_time(int64_t number, openshot::Fraction rate);
 
+		/// Get the content signature of a clip or effect (a hash of its properties, except its id and position)
+		uint64_t content_signature(openshot::ClipBase* object);
+
+		/// Get the content key of a timeline frame (a hash of everything which determines the frame, used by CacheContent)
+		uint64_t content_key(int64_t requested_frame, const std::vector<openshot::Clip*>& nearby_clips);
+
+		/// Get the properties of a clip which determine the size of its decoded images (see FFmpegReader::GetTargetSize)
+		std::vector<float> clip_image_scale(openshot::Clip* clip);
+
+		/// Clear the cached frames of a clip's reader (and of the reader wrapped by its FrameMapper)
+		void clear_clip_cache(openshot::Clip* clip);
+
+		/// Remove the frames of a clip or effect (at a given position and duration) from the final cache
+		void invalidate_cache(double position, double duration);
+
+		/// Remove the frames affected by a change to a clip or effect (from its previous to its current JSON) from
+		/// the final cache. Keyframe changes only remove the frames whose interpolated values changed.
+		void invalidate_cache(const Json::Value& previous_json, const Json::Value& current_json, openshot::ClipBase* parent_clip);
+
+		/// Find the range of frames affected by keyframe changes (returns false if a non-keyframe property changed)
+		bool find_changed_frames(const Json::Value& previous_json, const Json::Value& current_json,
+								 int64_t min_frame, int64_t max_frame, int64_t& first_frame, int64_t& last_frame);
+
 		/// Find intersecting (or non-intersecting) openshot::Clip objects
 		///
 		/// @returns A list of openshot::Clip objects
@@ -258,6 +288,14 @@ namespace openshot {
 		/// Apply the timeline's framerate and samplerate to all clips
 		void ApplyMapperToClips();
 
+		/// Determine if only audio is rendered
+		bool AudioOnly() const { return audio_only; };
+
+		/// @brief Only render audio (i.e. for audio exports or waveforms). Frames have no image, the clips'
+		/// readers skip decoding video, and effects which only modify video are skipped.
+		/// @param value Render only audio (true), or both audio and video (false)
+		void AudioOnly(bool value);
+
 		/// Determine if clips are automatically mapped to the timeline's framerate and samplerate
 		bool AutoMapClips() { return auto_map_clips; };
 
@@ -330,6 +368,9 @@ namespace openshot {
 		Json::Value JsonValue() const override; ///< Generate Json::Value for this object
 		void SetJsonValue(const Json::Value root) override; ///< Load Json::Value into this object
 
+		/// Generate JSON string of the render-time profiling data (timings of frames, clips and effects, see openshot::Profiler)
+		std::string ProfileJson() const;
+
 		/// Set Max Image Size (used for performance optimization). Convenience function for setting
 		/// Settings::Instance()->MAX_WIDTH and Settings::Instance()->MAX_HEIGHT.
 		void SetMaxSize(int width, int height);
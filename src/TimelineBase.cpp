@@ -17,5 +17,6 @@ using namespace openshot;
 /// Constructor for the base timeline
 TimelineBase::TimelineBase()
     : preview_width(1920),
-      preview_height(1080) { }
+      preview_height(1080),
+      preview_speed(0) { }
 
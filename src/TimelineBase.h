@@ -32,6 +32,7 @@ namespace openshot {
     struct TimelineInfoStruct
     {
         bool is_top_clip;                 ///< Is clip on top (if overlapping another clip)
+        bool is_audio_only;               ///< Is only audio needed (skip video effects and image processing)
     };
 
 	/**
@@ -42,6 +43,7 @@ namespace openshot {
 	public:
 		int preview_width; ///< Optional preview width of timeline image. If your preview window is smaller than the timeline, it's recommended to set this.
 		int preview_height; ///< Optional preview width of timeline image. If your preview window is smaller than the timeline, it's recommended to set this.
+		int preview_speed; ///< Optional playback speed of the preview (i.e. 4 when fast forwarding, 0 when not playing). Readers can skip decoding images which are not displayed at this speed.
 
 		/// Constructor for the base timeline
 		TimelineBase();
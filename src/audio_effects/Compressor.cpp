@@ -14,6 +14,9 @@
 #include "Exceptions.h"
 #include "Frame.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace openshot;
 
 Compressor::Compressor() : Compressor::Compressor(-10, 1, 1, 1, 1, false) {}
@@ -22,8 +25,7 @@ Compressor::Compressor(Keyframe threshold, Keyframe ratio, Keyframe attack,
                        Keyframe release, Keyframe makeup_gain,
                        Keyframe bypass):
     threshold(threshold), ratio(ratio), attack(attack),
-    release(release), makeup_gain(makeup_gain), bypass(bypass),
-    input_level(0.0), yl_prev(0.0)
+    release(release), makeup_gain(makeup_gain), bypass(bypass)
 {
 	// Init effect properties
 	init_effect_details();
@@ -47,14 +49,24 @@ void Compressor::init_effect_details()
 // modified openshot::Frame object
 std::shared_ptr<openshot::Frame> Compressor::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number)
 {
+	return GetFrame(frame, frame_number, &state);
+}
+
+// Apply the compressor to a frame, continuing from the gain of a specific EffectState
+std::shared_ptr<openshot::Frame> Compressor::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state)
+{
+	CompressorState* s = dynamic_cast<CompressorState*>(effect_state);
+	if (!s)
+		s = &state;
+
 	// Adding Compressor
     const int num_input_channels = frame->audio->getNumChannels();
     const int num_output_channels = frame->audio->getNumChannels();
     const int num_samples = frame->audio->getNumSamples();
 
-    mixed_down_input.setSize(1, num_samples);
-	inverse_sample_rate = 1.0f / frame->SampleRate();
-    inverseE = 1.0f / M_E;
+    const int sample_rate = frame->SampleRate();
+    juce::AudioBuffer<float>& mixed_down_input = s->mixed_down_input;
+    mixed_down_input.setSize(1, num_samples, false, false, true);
 
 	if ((bool)bypass.GetValue(frame_number))
         return frame;
@@ -67,29 +79,31 @@ std::shared_ptr<openshot::Frame> Compressor::GetFrame(std::shared_ptr<openshot::
     for (int sample = 0; sample < num_samples; ++sample) {
         float T = threshold.GetValue(frame_number);
         float R = ratio.GetValue(frame_number);
-        float alphaA = calculateAttackOrRelease(attack.GetValue(frame_number));
-        float alphaR = calculateAttackOrRelease(release.GetValue(frame_number));
+        float alphaA = calculateAttackOrRelease(attack.GetValue(frame_number), sample_rate);
+        float alphaR = calculateAttackOrRelease(release.GetValue(frame_number), sample_rate);
         float gain = makeup_gain.GetValue(frame_number);
 		float input_squared = powf(mixed_down_input.getSample(0, sample), 2.0f);
 
-		input_level = input_squared;
+		float input_level = input_squared;
 
-        xg = (input_level <= 1e-6f) ? -60.0f : 10.0f * log10f(input_level);
+        float xg = (input_level <= 1e-6f) ? -60.0f : 10.0f * log10f(input_level);
 
+		float yg;
 		if (xg < T)
 			yg = xg;
 		else
 			yg = T + (xg - T) / R;
 
-		xl = xg - yg;
+		float xl = xg - yg;
+		float yl;
 
-		if (xl > yl_prev)
-			yl = alphaA * yl_prev + (1.0f - alphaA) * xl;
+		if (xl > s->yl_prev)
+			yl = alphaA * s->yl_prev + (1.0f - alphaA) * xl;
 		else
-			yl = alphaR * yl_prev + (1.0f - alphaR) * xl;
+			yl = alphaR * s->yl_prev + (1.0f - alphaR) * xl;
 
-        control = powf (10.0f, (gain - yl) * 0.05f);
-        yl_prev = yl;
+        float control = powf (10.0f, (gain - yl) * 0.05f);
+        s->yl_prev = yl;
 
         for (int channel = 0; channel < num_input_channels; ++channel) {
             float new_value = frame->audio->getSample(channel, sample)*control;
@@ -104,14 +118,27 @@ std::shared_ptr<openshot::Frame> Compressor::GetFrame(std::shared_ptr<openshot::
 	return frame;
 }
 
-float Compressor::calculateAttackOrRelease(float value)
+float Compressor::calculateAttackOrRelease(float value, int sample_rate) const
 {
+    const float inverse_sample_rate = 1.0f / sample_rate;
+    const float inverseE = 1.0f / M_E;
+
     if (value == 0.0f)
         return 0.0f;
     else
         return pow (inverseE, inverse_sample_rate / value);
 }
 
+// Get the number of previous samples which are needed for the gain to settle
+int64_t Compressor::LookBackSamples(int sample_rate) const
+{
+	// The gain follows the input with the attack and release time constants (in seconds),
+	// so count the samples until the previous gain decays below -60 dB (no more than 2 seconds)
+	double time_constant = std::max(attack.GetMaxPoint().co.Y, release.GetMaxPoint().co.Y);
+	double samples = std::log(1000.0) * std::max(0.0, time_constant) * sample_rate;
+	return (int64_t)std::ceil(std::min(samples, 2.0 * sample_rate));
+}
+
 // Generate JSON string of this object
 std::string Compressor::Json() const {
 
@@ -14,6 +14,9 @@
 #include "Exceptions.h"
 #include "Frame.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace openshot;
 
 Delay::Delay() : Delay::Delay(1) { }
@@ -35,24 +38,23 @@ void Delay::init_effect_details()
 	info.description = "Adjust the synchronism between the audio and video track.";
 	info.has_audio = true;
 	info.has_video = false;
-	initialized = false;
 }
 
-void Delay::setup(std::shared_ptr<openshot::Frame> frame)
+void Delay::setup(std::shared_ptr<openshot::Frame> frame, DelayState& s)
 {
-	if (!initialized)
+	if (!s.initialized)
 	{
 		const float max_delay_time = 5;
-		delay_buffer_samples = (int)(max_delay_time * (float)frame->SampleRate()) + 1;
+		s.delay_buffer_samples = (int)(max_delay_time * (float)frame->SampleRate()) + 1;
 
-		if (delay_buffer_samples < 1)
-			delay_buffer_samples = 1;
+		if (s.delay_buffer_samples < 1)
+			s.delay_buffer_samples = 1;
 
-		delay_buffer_channels = frame->audio->getNumChannels();
-		delay_buffer.setSize(delay_buffer_channels, delay_buffer_samples);
-		delay_buffer.clear();
-		delay_write_position = 0;
-		initialized = true;
+		s.delay_buffer_channels = frame->audio->getNumChannels();
+		s.delay_buffer.setSize(s.delay_buffer_channels, s.delay_buffer_samples);
+		s.delay_buffer.clear();
+		s.delay_write_position = 0;
+		s.initialized = true;
 	}
 }
 
@@ -60,47 +62,70 @@ void Delay::setup(std::shared_ptr<openshot::Frame> frame)
 // modified openshot::Frame object
 std::shared_ptr<openshot::Frame> Delay::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number)
 {
+	return GetFrame(frame, frame_number, &state);
+}
+
+// Apply the delay to a frame, using the delay buffer of a specific EffectState
+std::shared_ptr<openshot::Frame> Delay::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state)
+{
+	DelayState* s = dynamic_cast<DelayState*>(effect_state);
+	if (!s)
+		s = &state;
+
 	const float delay_time_value = (float)delay_time.GetValue(frame_number)*(float)frame->SampleRate();
 	int local_write_position;
 
-	setup(frame);
+	setup(frame, *s);
 
 	for (int channel = 0; channel < frame->audio->getNumChannels(); channel++)
 	{
 		float *channel_data = frame->audio->getWritePointer(channel);
-        float *delay_data = delay_buffer.getWritePointer(channel);
-        local_write_position = delay_write_position;
+        float *delay_data = s->delay_buffer.getWritePointer(channel);
+        local_write_position = s->delay_write_position;
 
 		for (auto sample = 0; sample < frame->audio->getNumSamples(); ++sample)
 		{
 			const float in = (float)(channel_data[sample]);
             float out = 0.0f;
 
-            float read_position = fmodf((float)local_write_position - delay_time_value + (float)delay_buffer_samples, delay_buffer_samples);
+            float read_position = fmodf((float)local_write_position - delay_time_value + (float)s->delay_buffer_samples, s->delay_buffer_samples);
             int local_read_position = floorf(read_position);
 
             if (local_read_position != local_write_position)
 			{
                 float fraction = read_position - (float)local_read_position;
                 float delayed1 = delay_data[(local_read_position + 0)];
-                float delayed2 = delay_data[(local_read_position + 1) % delay_buffer_samples];
+                float delayed2 = delay_data[(local_read_position + 1) % s->delay_buffer_samples];
                 out = (float)(delayed1 + fraction * (delayed2 - delayed1));
 
                 channel_data[sample] = in + (out - in);
 				delay_data[local_write_position] = in;
             }
 
-            if (++local_write_position >= delay_buffer_samples)
-                local_write_position -= delay_buffer_samples;
+            if (++local_write_position >= s->delay_buffer_samples)
+                local_write_position -= s->delay_buffer_samples;
 		}
 	}
 
-    delay_write_position = local_write_position;
+    s->delay_write_position = local_write_position;
 
 	// return the modified frame
 	return frame;
 }
 
+// Get the number of previous samples which are needed to delay a frame
+int64_t Delay::LookBackSamples(int sample_rate) const
+{
+	// The delay buffer holds no more than 5 seconds of audio
+	const double max_delay_time = 5;
+	const double delay_time_value = std::min(max_delay_time, std::max(0.0, delay_time.GetMaxPoint().co.Y));
+	if (delay_time_value <= 0.0)
+		return 0;
+
+	// One more sample is needed to interpolate between samples
+	return (int64_t)std::ceil(delay_time_value * sample_rate) + 1;
+}
+
 // Generate JSON string of this object
 std::string Delay::Json() const {
 
@@ -35,18 +35,28 @@ namespace openshot
 	class Delay : public EffectBase
 	{
 	private:
+		/// The delay buffer, which carries the audio of previous frames into the next frames
+		struct DelayState : public EffectState
+		{
+			juce::AudioBuffer<float> delay_buffer;
+			int delay_buffer_samples = 0;
+			int delay_buffer_channels = 0;
+			int delay_write_position = 0;
+			bool initialized = false;
+		};
+
+		/// The state of frames which are requested without an EffectState (in order)
+		DelayState state;
+
 		/// Init effect settings
 		void init_effect_details();
 
+		/// Allocate the delay buffer (for the sample rate and channels of the first frame)
+		void setup(std::shared_ptr<openshot::Frame> frame, DelayState& s);
+
 	public:
 		Keyframe delay_time;
 
-		juce::AudioBuffer<float> delay_buffer;
-		int delay_buffer_samples;
-		int delay_buffer_channels;
-		int delay_write_position;
-		bool initialized;
-
 		/// Default constructor
 		Delay();
 
@@ -57,11 +67,17 @@ namespace openshot
 			return GetFrame(std::make_shared<openshot::Frame>(), frame_number);
 		}
 
-		void setup(std::shared_ptr<openshot::Frame> frame);
-
 		std::shared_ptr<openshot::Frame>
 		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number) override;
 
+		std::shared_ptr<openshot::Frame>
+		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state) override;
+
+		int64_t LookBackSamples(int sample_rate) const override;
+		std::shared_ptr<openshot::EffectState> CreateState() override {
+			return std::make_shared<DelayState>();
+		}
+
 		// Get and Set JSON methods
 		std::string Json() const override; ///< Generate JSON string of this object
 		void SetJson(const std::string value) override; ///< Load JSON string into this object
@@ -14,6 +14,9 @@
 #include "Exceptions.h"
 #include "Frame.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace openshot;
 
 Echo::Echo() : Echo::Echo(0.1, 0.5, 0.5) { }
@@ -37,24 +40,23 @@ void Echo::init_effect_details()
 	info.description = "Reflection of sound with a delay after the direct sound.";
 	info.has_audio = true;
 	info.has_video = false;
-	initialized = false;
 }
 
-void Echo::setup(std::shared_ptr<openshot::Frame> frame)
+void Echo::setup(std::shared_ptr<openshot::Frame> frame, EchoState& s)
 {
-	if (!initialized)
+	if (!s.initialized)
 	{
 		const float max_echo_time = 5;
-		echo_buffer_samples = (int)(max_echo_time * (float)frame->SampleRate()) + 1;
+		s.echo_buffer_samples = (int)(max_echo_time * (float)frame->SampleRate()) + 1;
 
-		if (echo_buffer_samples < 1)
-			echo_buffer_samples = 1;
+		if (s.echo_buffer_samples < 1)
+			s.echo_buffer_samples = 1;
 
-		echo_buffer_channels = frame->audio->getNumChannels();
-		echo_buffer.setSize(echo_buffer_channels, echo_buffer_samples);
-		echo_buffer.clear();
-		echo_write_position = 0;
-		initialized = true;
+		s.echo_buffer_channels = frame->audio->getNumChannels();
+		s.echo_buffer.setSize(s.echo_buffer_channels, s.echo_buffer_samples);
+		s.echo_buffer.clear();
+		s.echo_write_position = 0;
+		s.initialized = true;
 	}
 }
 
@@ -62,48 +64,77 @@ void Echo::setup(std::shared_ptr<openshot::Frame> frame)
 // modified openshot::Frame object
 std::shared_ptr<openshot::Frame> Echo::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number)
 {
+	return GetFrame(frame, frame_number, &state);
+}
+
+// Apply the echo to a frame, using the echo buffer of a specific EffectState
+std::shared_ptr<openshot::Frame> Echo::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state)
+{
+	EchoState* s = dynamic_cast<EchoState*>(effect_state);
+	if (!s)
+		s = &state;
+
 	const float echo_time_value = (float)echo_time.GetValue(frame_number)*(float)frame->SampleRate();
 	const float feedback_value = feedback.GetValue(frame_number);
 	const float mix_value = mix.GetValue(frame_number);
 	int local_write_position;
 
-	setup(frame);
+	setup(frame, *s);
 
 	for (int channel = 0; channel < frame->audio->getNumChannels(); channel++)
 	{
 		float *channel_data = frame->audio->getWritePointer(channel);
-        float *echo_data = echo_buffer.getWritePointer(channel);
-        local_write_position = echo_write_position;
+        float *echo_data = s->echo_buffer.getWritePointer(channel);
+        local_write_position = s->echo_write_position;
 
 		for (auto sample = 0; sample < frame->audio->getNumSamples(); ++sample)
 		{
 			const float in = (float)(channel_data[sample]);
             float out = 0.0f;
 
-            float read_position = fmodf((float)local_write_position - echo_time_value + (float)echo_buffer_samples, echo_buffer_samples);
+            float read_position = fmodf((float)local_write_position - echo_time_value + (float)s->echo_buffer_samples, s->echo_buffer_samples);
             int local_read_position = floorf(read_position);
 
             if (local_read_position != local_write_position)
 			{
                 float fraction = read_position - (float)local_read_position;
                 float echoed1 = echo_data[(local_read_position + 0)];
-                float echoed2 = echo_data[(local_read_position + 1) % echo_buffer_samples];
+                float echoed2 = echo_data[(local_read_position + 1) % s->echo_buffer_samples];
                 out = (float)(echoed1 + fraction * (echoed2 - echoed1));
                 channel_data[sample] = in + mix_value*(out - in);
 				echo_data[local_write_position] = in + out*feedback_value;
             }
 
-            if (++local_write_position >= echo_buffer_samples)
-                local_write_position -= echo_buffer_samples;
+            if (++local_write_position >= s->echo_buffer_samples)
+                local_write_position -= s->echo_buffer_samples;
 		}
 	}
 
-    echo_write_position = local_write_position;
+    s->echo_write_position = local_write_position;
 
 	// return the modified frame
 	return frame;
 }
 
+// Get the number of previous samples which are still audible in the echo of a frame
+int64_t Echo::LookBackSamples(int sample_rate) const
+{
+	const double max_echo_time = 5;
+	const double echo_time_value = std::min(max_echo_time, echo_time.GetMaxPoint().co.Y);
+	const double feedback_value = std::fabs(feedback.GetMaxPoint().co.Y);
+
+	// Each echo is quieter by the feedback, so only count the echoes above -60 dB
+	double echoes = 1.0;
+	if (feedback_value > 0.0 && feedback_value < 1.0)
+		echoes += std::ceil(std::log(0.001) / std::log(feedback_value));
+	else if (feedback_value >= 1.0)
+		echoes = max_echo_time / std::max(echo_time_value, 0.001);
+
+	// The echo buffer holds no more than 5 seconds of audio
+	const double seconds = std::min(max_echo_time, std::max(0.0, echo_time_value) * echoes);
+	return (int64_t)std::ceil(seconds * sample_rate);
+}
+
 // Generate JSON string of this object
 std::string Echo::Json() const {
 
@@ -35,20 +35,30 @@ namespace openshot
 	class Echo : public EffectBase
 	{
 	private:
+		/// The echo buffer, which carries the audio of previous frames into the next frames
+		struct EchoState : public EffectState
+		{
+			juce::AudioBuffer<float> echo_buffer;
+			int echo_buffer_samples = 0;
+			int echo_buffer_channels = 0;
+			int echo_write_position = 0;
+			bool initialized = false;
+		};
+
+		/// The state of frames which are requested without an EffectState (in order)
+		EchoState state;
+
 		/// Init effect settings
 		void init_effect_details();
 
+		/// Allocate the echo buffer (for the sample rate and channels of the first frame)
+		void setup(std::shared_ptr<openshot::Frame> frame, EchoState& s);
+
 	public:
 		Keyframe echo_time;
 		Keyframe feedback;
 		Keyframe mix;
 
-		juce::AudioBuffer<float> echo_buffer;
-		int echo_buffer_samples;
-		int echo_buffer_channels;
-		int echo_write_position;
-		bool initialized;
-
 		/// Default constructor
 		Echo();
 
@@ -59,11 +69,17 @@ namespace openshot
 			return GetFrame(std::make_shared<openshot::Frame>(), frame_number);
 		}
 
-		void setup(std::shared_ptr<openshot::Frame> frame);
-
 		std::shared_ptr<openshot::Frame>
 		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number) override;
 
+		std::shared_ptr<openshot::Frame>
+		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state) override;
+
+		int64_t LookBackSamples(int sample_rate) const override;
+		std::shared_ptr<openshot::EffectState> CreateState() override {
+			return std::make_shared<EchoState>();
+		}
+
 		// Get and Set JSON methods
 		std::string Json() const override; ///< Generate JSON string of this object
 		void SetJson(const std::string value) override; ///< Load JSON string into this object
@@ -14,6 +14,9 @@
 #include "Exceptions.h"
 #include "Frame.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace openshot;
 
 Expander::Expander(): Expander::Expander(-10, 1, 1, 1, 1, false) { }
@@ -40,25 +43,30 @@ void Expander::init_effect_details()
 	info.description = "Louder parts of audio becomes relatively louder and quieter parts becomes quieter.";
 	info.has_audio = true;
 	info.has_video = false;
-
-    input_level = 0.0f;
-    yl_prev = 0.0f;
-
-
 }
 
 // This method is required for all derived classes of EffectBase, and returns a
 // modified openshot::Frame object
 std::shared_ptr<openshot::Frame> Expander::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number)
 {
+	return GetFrame(frame, frame_number, &state);
+}
+
+// Apply the expander to a frame, continuing from the gain of a specific EffectState
+std::shared_ptr<openshot::Frame> Expander::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state)
+{
+	ExpanderState* s = dynamic_cast<ExpanderState*>(effect_state);
+	if (!s)
+		s = &state;
+
 	// Adding Expander
     const int num_input_channels = frame->audio->getNumChannels();
     const int num_output_channels = frame->audio->getNumChannels();
     const int num_samples = frame->audio->getNumSamples();
 
-    mixed_down_input.setSize(1, num_samples);
-	inverse_sample_rate = 1.0f / frame->SampleRate();
-    inverseE = 1.0f / M_E;
+    const int sample_rate = frame->SampleRate();
+    juce::AudioBuffer<float>& mixed_down_input = s->mixed_down_input;
+    mixed_down_input.setSize(1, num_samples, false, false, true);
 
 	if ((bool)bypass.GetValue(frame_number))
         return frame;
@@ -71,31 +79,34 @@ std::shared_ptr<openshot::Frame> Expander::GetFrame(std::shared_ptr<openshot::Fr
     for (int sample = 0; sample < num_samples; ++sample) {
         float T = threshold.GetValue(frame_number);
         float R = ratio.GetValue(frame_number);
-        float alphaA = calculateAttackOrRelease(attack.GetValue(frame_number));
-        float alphaR = calculateAttackOrRelease(release.GetValue(frame_number));
+        float alphaA = calculateAttackOrRelease(attack.GetValue(frame_number), sample_rate);
+        float alphaR = calculateAttackOrRelease(release.GetValue(frame_number), sample_rate);
         float gain = makeup_gain.GetValue(frame_number);
 		float input_squared = powf(mixed_down_input.getSample(0, sample), 2.0f);
 
 		const float average_factor = 0.9999f;
-		input_level = average_factor * input_level + (1.0f - average_factor) * input_squared;
+		s->input_level = average_factor * s->input_level + (1.0f - average_factor) * input_squared;
+		float input_level = s->input_level;
 
-        xg = (input_level <= 1e-6f) ? -60.0f : 10.0f * log10f(input_level);
+        float xg = (input_level <= 1e-6f) ? -60.0f : 10.0f * log10f(input_level);
 
+		float yg;
 		if (xg > T)
 			yg = xg;
 		else
 			yg = T + (xg - T) * R;
 
-		xl = xg - yg;
+		float xl = xg - yg;
+		float yl;
 
-		if (xl < yl_prev)
-			yl = alphaA * yl_prev + (1.0f - alphaA) * xl;
+		if (xl < s->yl_prev)
+			yl = alphaA * s->yl_prev + (1.0f - alphaA) * xl;
 		else
-			yl = alphaR * yl_prev + (1.0f - alphaR) * xl;
+			yl = alphaR * s->yl_prev + (1.0f - alphaR) * xl;
 
 
-        control = powf (10.0f, (gain - yl) * 0.05f);
-        yl_prev = yl;
+        float control = powf (10.0f, (gain - yl) * 0.05f);
+        s->yl_prev = yl;
 
         for (int channel = 0; channel < num_input_channels; ++channel) {
             float new_value = frame->audio->getSample(channel, sample)*control;
@@ -110,14 +121,30 @@ std::shared_ptr<openshot::Frame> Expander::GetFrame(std::shared_ptr<openshot::Fr
 	return frame;
 }
 
-float Expander::calculateAttackOrRelease(float value)
+float Expander::calculateAttackOrRelease(float value, int sample_rate) const
 {
+    const float inverse_sample_rate = 1.0f / sample_rate;
+    const float inverseE = 1.0f / M_E;
+
     if (value == 0.0f)
         return 0.0f;
     else
         return pow (inverseE, inverse_sample_rate / value);
 }
 
+// Get the number of previous samples which are needed for the gain to settle
+int64_t Expander::LookBackSamples(int sample_rate) const
+{
+	// The gain follows the input with the attack and release time constants (in seconds),
+	// so count the samples until the previous gain decays below -60 dB (no more than 2 seconds)
+	double time_constant = std::max(attack.GetMaxPoint().co.Y, release.GetMaxPoint().co.Y);
+	double samples = std::log(1000.0) * std::max(0.0, time_constant) * sample_rate;
+
+	// The input level is also averaged (with a factor of 0.9999 per sample)
+	samples += std::log(1000.0) / -std::log(0.9999);
+	return (int64_t)std::ceil(std::min(samples, 2.0 * sample_rate));
+}
+
 // Generate JSON string of this object
 std::string Expander::Json() const {
 
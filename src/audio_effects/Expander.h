@@ -36,10 +36,20 @@ namespace openshot
 	class Expander : public EffectBase
 	{
 	private:
+		/// The the averaged input level and gain reduction of the previous sample, which carries into the next frames
+		struct ExpanderState : public EffectState
+		{
+			juce::AudioBuffer<float> mixed_down_input;
+			float input_level = 0.0f;
+			float yl_prev = 0.0f;
+		};
+
+		/// The state of frames which are requested without an EffectState (in order)
+		ExpanderState state;
+
 		/// Init effect settings
 		void init_effect_details();
 
-
 	public:
 		Keyframe threshold;
 		Keyframe ratio;
@@ -48,19 +58,6 @@ namespace openshot
 		Keyframe makeup_gain;
 		Keyframe bypass;
 
-		juce::AudioBuffer<float> mixed_down_input;
-		float xl;
-		float yl;
-		float xg;
-		float yg;
-		float control;
-
-		float input_level;
-		float yl_prev;
-
-		float inverse_sample_rate;
-		float inverseE;
-
 		/// Default constructor
 		Expander();
 
@@ -68,7 +65,7 @@ namespace openshot
 		Expander(Keyframe threshold, Keyframe ratio, Keyframe attack,
 		         Keyframe release, Keyframe makeup_gain, Keyframe bypass);
 
-		float calculateAttackOrRelease(float value);
+		float calculateAttackOrRelease(float value, int sample_rate) const;
 
 		std::shared_ptr<openshot::Frame> GetFrame(int64_t frame_number) override {
 			return GetFrame(std::make_shared<openshot::Frame>(), frame_number);
@@ -77,6 +74,14 @@ namespace openshot
 		std::shared_ptr<openshot::Frame>
 		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number) override;
 
+		std::shared_ptr<openshot::Frame>
+		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state) override;
+
+		int64_t LookBackSamples(int sample_rate) const override;
+		std::shared_ptr<openshot::EffectState> CreateState() override {
+			return std::make_shared<ExpanderState>();
+		}
+
 		// Get and Set JSON methods
 		std::string Json() const override; ///< Generate JSON string of this object
 		void SetJson(const std::string value) override; ///< Load JSON string into this object
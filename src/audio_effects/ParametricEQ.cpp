@@ -13,6 +13,9 @@
 #include "ParametricEQ.h"
 #include "Exceptions.h"
 
+#include <algorithm>
+#include <cmath>
+
 using namespace openshot;
 using namespace juce;
 
@@ -39,34 +42,43 @@ void ParametricEQ::init_effect_details()
 	info.description = "Filter that allows you to adjust the volume level of a frequency in the audio track.";
 	info.has_audio = true;
 	info.has_video = false;
-	initialized = false;
 }
 
 // This method is required for all derived classes of EffectBase, and returns a
 // modified openshot::Frame object
 std::shared_ptr<openshot::Frame> ParametricEQ::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number)
 {
-	if (!initialized)
+	return GetFrame(frame, frame_number, &state);
+}
+
+// Apply the equalization to a frame, using the filters of a specific EffectState
+std::shared_ptr<openshot::Frame> ParametricEQ::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state)
+{
+	EQState* s = dynamic_cast<EQState*>(effect_state);
+	if (!s)
+		s = &state;
+
+	if (!s->initialized)
 	{
-		filters.clear();
+		s->filters.clear();
 
 		for (int i = 0; i < frame->audio->getNumChannels(); ++i) {
 			Filter *filter;
-			filters.add(filter = new Filter());
+			s->filters.add(filter = new Filter());
 		}
 
-		initialized = true;
+		s->initialized = true;
 	}
 
 	const int num_input_channels = frame->audio->getNumChannels();
     const int num_output_channels = frame->audio->getNumChannels();
     const int num_samples = frame->audio->getNumSamples();
-    updateFilters(frame_number, num_samples);
+    updateFilters(s->filters, frame_number, num_samples);
 
 	for (int channel = 0; channel < frame->audio->getNumChannels(); channel++)
 	{
 		auto *channel_data = frame->audio->getWritePointer(channel);
-		filters[channel]->processSamples(channel_data, num_samples);
+		s->filters[channel]->processSamples(channel_data, num_samples);
 	}
 
     for (int channel = num_input_channels; channel < num_output_channels; ++channel)
@@ -159,7 +171,7 @@ void ParametricEQ::Filter::updateCoefficients (
 	setCoefficients(coefficients);
 }
 
-void ParametricEQ::updateFilters(int64_t frame_number, double sample_rate)
+void ParametricEQ::updateFilters(juce::OwnedArray<Filter>& filters, int64_t frame_number, double sample_rate)
 {
     double discrete_frequency = 2.0 * M_PI * (double)frequency.GetValue(frame_number) / sample_rate;
 	double q_value = (double)q_factor.GetValue(frame_number);
@@ -170,6 +182,21 @@ void ParametricEQ::updateFilters(int64_t frame_number, double sample_rate)
 		filters[i]->updateCoefficients(discrete_frequency, q_value, gain_value, filter_type_value);
 }
 
+// Get the number of previous samples which are needed for the filters to settle
+int64_t ParametricEQ::LookBackSamples(int sample_rate) const
+{
+	// The lowest frequency (and highest q factor) settle the slowest
+	double min_frequency = frequency.GetValue(1);
+	for (int64_t i = 0; i < frequency.GetCount(); ++i)
+		min_frequency = std::min(min_frequency, frequency.GetPoint(i).co.Y);
+	const double max_q = std::max(1.0, q_factor.GetMaxPoint().co.Y);
+	const double discrete_frequency = 2.0 * M_PI * std::max(1.0, min_frequency) / sample_rate;
+
+	// Samples until the filter history decays below -60 dB (no more than 1 second)
+	const double samples = std::log(1000.0) * 2.0 * max_q / discrete_frequency;
+	return (int64_t)std::ceil(std::min(samples, (double)sample_rate));
+}
+
 // Generate JSON string of this object
 std::string ParametricEQ::Json() const {
 
@@ -45,7 +45,6 @@ namespace openshot
 		Keyframe frequency;
 		Keyframe q_factor;
 		Keyframe gain;
-		bool initialized;
 
 		/// Blank constructor, useful when using Json to load the effect properties
 		ParametricEQ();
@@ -61,6 +60,14 @@ namespace openshot
 		std::shared_ptr<openshot::Frame>
 		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number) override;
 
+		std::shared_ptr<openshot::Frame>
+		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state) override;
+
+		int64_t LookBackSamples(int sample_rate) const override;
+		std::shared_ptr<openshot::EffectState> CreateState() override {
+			return std::make_shared<EQState>();
+		}
+
 		// Get and Set JSON methods
 		std::string Json() const override; ///< Generate JSON string of this object
 		void SetJson(const std::string value) override; ///< Load JSON string into this object
@@ -78,9 +85,18 @@ namespace openshot
 			                         const int filter_type);
 		};
 
-		juce::OwnedArray<Filter> filters;
+		void updateFilters(juce::OwnedArray<Filter>& filters, int64_t frame_number, double sample_rate);
+
+	private:
+		/// The filter of each channel, whose history carries into the next frames
+		struct EQState : public EffectState
+		{
+			juce::OwnedArray<Filter> filters;
+			bool initialized = false;
+		};
 
-		void updateFilters(int64_t frame_number, double sample_rate);
+		/// The state of frames which are requested without an EffectState (in order)
+		EQState state;
 	};
 
 }
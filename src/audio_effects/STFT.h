@@ -21,7 +21,7 @@ namespace openshot
     class STFT
     {
     public:
-        STFT() : num_channels (1) { }
+        STFT() : num_channels (1), fft_size (0), overlap (0) { }
 
         virtual ~STFT() { }
 
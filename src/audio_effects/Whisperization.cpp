@@ -49,23 +49,48 @@ void Whisperization::init_effect_details()
 std::shared_ptr<openshot::Frame> Whisperization::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number)
 {
     const std::lock_guard<std::recursive_mutex> lock(mutex);
+    apply_stft(frame, stft);
+
+	// return the modified frame
+	return frame;
+}
+
+// Apply the whisperization to a frame, using the STFT buffers of a specific EffectState
+std::shared_ptr<openshot::Frame> Whisperization::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state)
+{
+	WhisperizationState* s = dynamic_cast<WhisperizationState*>(effect_state);
+	if (!s)
+		return GetFrame(frame, frame_number);
+
+    apply_stft(frame, s->stft);
+
+	// return the modified frame
+	return frame;
+}
+
+// Apply the STFT to the audio of a frame
+void Whisperization::apply_stft(std::shared_ptr<openshot::Frame> frame, WhisperizationEffect& effect)
+{
     ScopedNoDenormals noDenormals;
 
-    const int num_input_channels = frame->audio->getNumChannels();
     const int num_output_channels = frame->audio->getNumChannels();
-    const int num_samples = frame->audio->getNumSamples();
     const int hop_size_value = 1 << ((int)hop_size + 1);
 	const int fft_size_value = 1 << ((int)fft_size + 5);
 
-    stft.setup(num_output_channels);
-    stft.updateParameters((int)fft_size_value,
-                          (int)hop_size_value,
-                          (int)window_type);
+    effect.setup(num_output_channels);
+    effect.updateParameters((int)fft_size_value,
+                            (int)hop_size_value,
+                            (int)window_type);
 
-    stft.process(*frame->audio);
+    effect.process(*frame->audio);
+}
 
-	// return the modified frame
-	return frame;
+// Get the number of previous samples which fill the STFT buffers
+int64_t Whisperization::LookBackSamples(int sample_rate) const
+{
+	// The input buffer and the overlapping output buffer are each one FFT long
+	const int fft_size_value = 1 << ((int)fft_size + 5);
+	return 2 * fft_size_value;
 }
 
 void Whisperization::WhisperizationEffect::modification(const int channel)
@@ -64,6 +64,14 @@ namespace openshot
 		std::shared_ptr<openshot::Frame>
 		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number) override;
 
+		std::shared_ptr<openshot::Frame>
+		GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number, openshot::EffectState* effect_state) override;
+
+		int64_t LookBackSamples(int sample_rate) const override;
+		std::shared_ptr<openshot::EffectState> CreateState() override {
+			return std::make_shared<WhisperizationState>(*this);
+		}
+
 		// Get and Set JSON methods
 		std::string Json() const override; ///< Generate JSON string of this object
 		void SetJson(const std::string value) override; ///< Load JSON string into this object
@@ -84,6 +92,16 @@ namespace openshot
 			Whisperization &parent;
 		};
 
+		/// The STFT buffers of a sequence of frames (i.e. a render lane)
+		struct WhisperizationState : public EffectState
+		{
+			WhisperizationState(Whisperization& p) : stft(p) { }
+			WhisperizationEffect stft;
+		};
+
+		/// Apply the STFT to the audio of a frame
+		void apply_stft(std::shared_ptr<openshot::Frame> frame, WhisperizationEffect& effect);
+
 		std::recursive_mutex mutex;
     	WhisperizationEffect stft;
 		std::unique_ptr<juce::dsp::FFT> fft;
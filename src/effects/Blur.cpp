@@ -13,18 +13,24 @@
 #include "Blur.h"
 #include "Exceptions.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
 using namespace openshot;
 
 /// Blank constructor, useful when using Json to load the effect properties
-Blur::Blur() : horizontal_radius(6.0), vertical_radius(6.0), sigma(3.0), iterations(3.0) {
+Blur::Blur() : horizontal_radius(6.0), vertical_radius(6.0), sigma(3.0), iterations(3.0), method(BLUR_BOX) {
 	// Init effect properties
 	init_effect_details();
 }
 
 // Default constructor
-Blur::Blur(Keyframe new_horizontal_radius, Keyframe new_vertical_radius, Keyframe new_sigma, Keyframe new_iterations) :
+Blur::Blur(Keyframe new_horizontal_radius, Keyframe new_vertical_radius, Keyframe new_sigma, Keyframe new_iterations,
+		   BlurMethod new_method) :
 		horizontal_radius(new_horizontal_radius), vertical_radius(new_vertical_radius),
-		sigma(new_sigma), iterations(new_iterations)
+		sigma(new_sigma), iterations(new_iterations), method(new_method)
 {
 	// Init effect properties
 	init_effect_details();
@@ -57,96 +63,158 @@ std::shared_ptr<openshot::Frame> Blur::GetFrame(std::shared_ptr<openshot::Frame>
 	float sigma_value = sigma.GetValue(frame_number);
 	int iteration_value = iterations.GetInt(frame_number);
 
+	// Number of passes in each direction (the Gaussian blur only needs a single pass)
+	int passes = iteration_value;
+	if (method == BLUR_GAUSSIAN)
+		passes = (sigma_value >= 0.5) ? 1 : 0;
+	if (passes <= 0 || (horizontal_radius_value <= 0 && vertical_radius_value <= 0))
+		return frame;
+
 	int w = frame_image->width();
 	int h = frame_image->height();
-
-	// Grab two copies of the image pixel data
-	QImage image_copy = frame_image->copy();
-	std::shared_ptr<QImage> frame_image_2 = std::make_shared<QImage>(image_copy);
-
-	// Loop through each iteration
-	for (int iteration = 0; iteration < iteration_value; ++iteration)
-	{
-		// HORIZONTAL BLUR (if any)
-		if (horizontal_radius_value > 0.0) {
-			// Apply horizontal blur to target RGBA channels
-			boxBlurH(frame_image->bits(), frame_image_2->bits(), w, h, horizontal_radius_value);
-
-			// Swap output image back to input
-			frame_image.swap(frame_image_2);
+	unsigned char *pixels = frame_image->bits();
+
+	// Scratch buffers, which the passes alternate between (the horizontal and vertical
+	// blurs are separable, so all horizontal passes are done before the vertical passes)
+	std::vector<unsigned char> buffer_1(w * h * 4);
+	std::vector<unsigned char> buffer_2(w * h * 4);
+	auto other_buffer = [&](unsigned char *buffer) {
+		return (buffer == buffer_1.data()) ? buffer_2.data() : buffer_1.data();
+	};
+	unsigned char *current = pixels;
+
+	// HORIZONTAL BLUR (if any)
+	if (horizontal_radius_value > 0) {
+		for (int pass = 0; pass < passes; ++pass) {
+			unsigned char *target = other_buffer(current);
+			if (method == BLUR_GAUSSIAN)
+				gaussianBlurH(current, target, w, h, sigma_value);
+			else
+				boxBlurH(current, target, w, h, horizontal_radius_value);
+			current = target;
 		}
+	}
 
-		// VERTICAL BLUR (if any)
-		if (vertical_radius_value > 0.0) {
-			// Apply vertical blur to target RGBA channels
-			boxBlurT(frame_image->bits(), frame_image_2->bits(), w, h, vertical_radius_value);
-
-			// Swap output image back to input
-			frame_image.swap(frame_image_2);
+	// VERTICAL BLUR (if any)
+	if (vertical_radius_value > 0) {
+		// Blur the rows of the transposed image (which keeps memory access sequential)
+		unsigned char *transposed = other_buffer(current);
+		transpose(current, transposed, w, h);
+		current = transposed;
+
+		for (int pass = 0; pass < passes; ++pass) {
+			unsigned char *target = other_buffer(current);
+			if (method == BLUR_GAUSSIAN)
+				gaussianBlurH(current, target, h, w, sigma_value);
+			else
+				boxBlurH(current, target, h, w, vertical_radius_value);
+			current = target;
 		}
+
+		// Transpose the result back into the frame's image
+		transpose(current, pixels, h, w);
+		current = pixels;
 	}
 
+	// Copy the result into the frame's image (if needed)
+	if (current != pixels)
+		std::memcpy(pixels, current, w * h * 4);
+
 	// return the modified frame
 	return frame;
 }
 
 // Credit: http://blog.ivank.net/fastest-gaussian-blur.html (MIT License)
-// Modified to process all four channels in a pixel array
+// Modified to process all four (interleaved) channels of a pixel together
 void Blur::boxBlurH(unsigned char *scl, unsigned char *tcl, int w, int h, int r) {
 	float iarr = 1.0 / (r + r + 1);
 
 	#pragma omp parallel for shared (scl, tcl)
 	for (int i = 0; i < h; ++i) {
+		const unsigned char *src = scl + i * w * 4;
+		unsigned char *dst = tcl + i * w * 4;
+
+		// Running sum of each channel (pixels beyond the edges repeat the edge pixel)
+		int val[4];
 		for (int ch = 0; ch < 4; ++ch) {
-			int ti = i * w, li = ti, ri = ti + r;
-			int fv = scl[ti * 4 + ch], lv = scl[(ti + w - 1) * 4 + ch], val = (r + 1) * fv;
-			for (int j = 0; j < r; ++j) {
-				val += scl[(ti + j) * 4 + ch];
-			}
-			for (int j = 0; j <= r; ++j) {
-				val += scl[ri++ * 4 + ch] - fv;
-				tcl[ti++ * 4 + ch] = round(val * iarr);
+			val[ch] = (r + 1) * src[ch];
+			for (int j = 1; j <= r; ++j)
+				val[ch] += src[std::min(j, w - 1) * 4 + ch];
+		}
+
+		for (int j = 0; j < w; ++j) {
+			const unsigned char *add = src + std::min(j + r + 1, w - 1) * 4;
+			const unsigned char *sub = src + std::max(j - r, 0) * 4;
+			for (int ch = 0; ch < 4; ++ch) {
+				dst[j * 4 + ch] = val[ch] * iarr + 0.5f;
+				val[ch] += add[ch] - sub[ch];
 			}
-			for (int j = r + 1; j < w - r; ++j) {
-				val += scl[ri++ * 4 + ch] - scl[li++ * 4 + ch];
-				tcl[ti++ * 4 + ch] = round(val * iarr);
+		}
+	}
+}
+
+// Recursive Gaussian filter (I.T. Young, L.J. van Vliet, "Recursive implementation of the Gaussian filter", 1995)
+void Blur::gaussianBlurH(unsigned char *scl, unsigned char *tcl, int w, int h, float sigma) {
+	// Calculate filter coefficients
+	double q = (sigma >= 2.5) ? 0.98711 * sigma - 0.96330 : 3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+	double b0 = 1.57825 + 2.44413 * q + 1.4281 * q * q + 0.422205 * q * q * q;
+	float b1 = (2.44413 * q + 2.85619 * q * q + 1.26661 * q * q * q) / b0;
+	float b2 = -(1.4281 * q * q + 1.26661 * q * q * q) / b0;
+	float b3 = (0.422205 * q * q * q) / b0;
+	float B = 1.0 - (b1 + b2 + b3);
+
+	#pragma omp parallel shared (scl, tcl)
+	{
+		// Intermediate (forward filtered) row
+		std::vector<float> row(w * 4);
+
+		#pragma omp for
+		for (int i = 0; i < h; ++i) {
+			const unsigned char *src = scl + i * w * 4;
+			unsigned char *dst = tcl + i * w * 4;
+
+			// Forward pass (starting with the edge pixel, as if it repeats)
+			float w1[4], w2[4], w3[4];
+			for (int ch = 0; ch < 4; ++ch)
+				w1[ch] = w2[ch] = w3[ch] = src[ch];
+			for (int j = 0; j < w; ++j) {
+				for (int ch = 0; ch < 4; ++ch) {
+					float value = B * src[j * 4 + ch] + b1 * w1[ch] + b2 * w2[ch] + b3 * w3[ch];
+					row[j * 4 + ch] = value;
+					w3[ch] = w2[ch];
+					w2[ch] = w1[ch];
+					w1[ch] = value;
+				}
 			}
-			for (int j = w - r; j < w; ++j) {
-				val += lv - scl[li++ * 4 + ch];
-				tcl[ti++ * 4 + ch] = round(val * iarr);
+
+			// Backward pass
+			for (int ch = 0; ch < 4; ++ch)
+				w1[ch] = w2[ch] = w3[ch] = row[(w - 1) * 4 + ch];
+			for (int j = w - 1; j >= 0; --j) {
+				for (int ch = 0; ch < 4; ++ch) {
+					float value = B * row[j * 4 + ch] + b1 * w1[ch] + b2 * w2[ch] + b3 * w3[ch];
+					dst[j * 4 + ch] = std::min(std::max(value + 0.5f, 0.0f), 255.0f);
+					w3[ch] = w2[ch];
+					w2[ch] = w1[ch];
+					w1[ch] = value;
+				}
 			}
 		}
 	}
 }
 
-void Blur::boxBlurT(unsigned char *scl, unsigned char *tcl, int w, int h, int r) {
-	float iarr = 1.0 / (r + r + 1);
+// Transpose the RGBA pixels of an image (in blocks, which fit in the CPU cache)
+void Blur::transpose(unsigned char *scl, unsigned char *tcl, int w, int h) {
+	const int block_size = 32;
 
 	#pragma omp parallel for shared (scl, tcl)
-	for (int i = 0; i < w; i++) {
-		for (int ch = 0; ch < 4; ++ch) {
-			int ti = i, li = ti, ri = ti + r * w;
-			int fv = scl[ti * 4 + ch], lv = scl[(ti + w * (h - 1)) * 4 + ch], val = (r + 1) * fv;
-			for (int j = 0; j < r; j++) val += scl[(ti + j * w) * 4 + ch];
-			for (int j = 0; j <= r; j++) {
-				val += scl[ri * 4 + ch] - fv;
-				tcl[ti * 4 + ch] = round(val * iarr);
-				ri += w;
-				ti += w;
-			}
-			for (int j = r + 1; j < h - r; j++) {
-				val += scl[ri * 4 + ch] - scl[li * 4 + ch];
-				tcl[ti * 4 + ch] = round(val * iarr);
-				li += w;
-				ri += w;
-				ti += w;
-			}
-			for (int j = h - r; j < h; j++) {
-				val += lv - scl[li * 4 + ch];
-				tcl[ti * 4 + ch] = round(val * iarr);
-				li += w;
-				ti += w;
-			}
+	for (int block_row = 0; block_row < h; block_row += block_size) {
+		for (int block_col = 0; block_col < w; block_col += block_size) {
+			int row_end = std::min(block_row + block_size, h);
+			int col_end = std::min(block_col + block_size, w);
+			for (int i = block_row; i < row_end; ++i)
+				for (int j = block_col; j < col_end; ++j)
+					std::memcpy(tcl + (j * h + i) * 4, scl + (i * w + j) * 4, 4);
 		}
 	}
 }
@@ -168,6 +236,7 @@ Json::Value Blur::JsonValue() const {
 	root["vertical_radius"] = vertical_radius.JsonValue();
 	root["sigma"] = sigma.JsonValue();
 	root["iterations"] = iterations.JsonValue();
+	root["blur_method"] = method;
 
 	// return JsonValue
 	return root;
@@ -205,6 +274,8 @@ void Blur::SetJsonValue(const Json::Value root) {
 		sigma.SetJsonValue(root["sigma"]);
 	if (!root["iterations"].isNull())
 		iterations.SetJsonValue(root["iterations"]);
+	if (!root["blur_method"].isNull())
+		method = (BlurMethod) root["blur_method"].asInt();
 }
 
 // Get all properties for a specific frame
@@ -224,6 +295,9 @@ std::string Blur::PropertiesJSON(int64_t requested_frame) const {
 	root["vertical_radius"] = add_property_json("Vertical Radius", vertical_radius.GetValue(requested_frame), "float", "", &vertical_radius, 0, 100, false, requested_frame);
 	root["sigma"] = add_property_json("Sigma", sigma.GetValue(requested_frame), "float", "", &sigma, 0, 100, false, requested_frame);
 	root["iterations"] = add_property_json("Iterations", iterations.GetValue(requested_frame), "float", "", &iterations, 0, 100, false, requested_frame);
+	root["blur_method"] = add_property_json("Blur Method", method, "int", "", NULL, 0, BLUR_LAST_METHOD, false, requested_frame);
+	root["blur_method"]["choices"].append(add_property_choice_json("Box", BLUR_BOX, method));
+	root["blur_method"]["choices"].append(add_property_choice_json("Gaussian", BLUR_GAUSSIAN, method));
 
 	// Set the parent effect which properties this effect will inherit
 	root["parent_effect_id"] = add_property_json("Parent", 0.0, "string", info.parent_effect_id, NULL, -1, -1, false, requested_frame);
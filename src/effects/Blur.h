@@ -15,6 +15,7 @@
 
 #include "../EffectBase.h"
 
+#include "../Enums.h"
 #include "../Frame.h"
 #include "../Json.h"
 #include "../KeyFrame.h"
@@ -32,6 +33,9 @@ namespace openshot
 	 * Adjusting the blur of an image over time can create many different powerful effects. To achieve a
 	 * box blur effect, use identical horizontal and vertical blur values. To achieve a Gaussian blur,
 	 * use 3 iterations, a sigma of 3.0, and a radius between 3 and X (depending on how much blur you want).
+	 *
+	 * The BLUR_GAUSSIAN method applies a true Gaussian blur (with the sigma value) to each direction with a radius
+	 * larger than 0. Its speed does not depend on the amount of blur.
 	 */
 	class Blur : public EffectBase
 	{
@@ -40,15 +44,19 @@ namespace openshot
 		void init_effect_details();
 
 		// Internal blur methods (inspired and credited to http://blog.ivank.net/fastest-gaussian-blur.html)
+		// Both blur the rows of RGBA pixels (vertical blurs are applied to the transposed image)
 		void boxBlurH(unsigned char *scl, unsigned char *tcl, int w, int h, int r);
-		void boxBlurT(unsigned char *scl, unsigned char *tcl, int w, int h, int r);
+		void gaussianBlurH(unsigned char *scl, unsigned char *tcl, int w, int h, float sigma);
 
+		/// Transpose the RGBA pixels of an image (so columns can be processed as rows)
+		void transpose(unsigned char *scl, unsigned char *tcl, int w, int h);
 
 	public:
 		Keyframe horizontal_radius;	///< Horizontal blur radius keyframe. The size of the horizontal blur operation in pixels.
 		Keyframe vertical_radius;	///< Vertical blur radius keyframe. The size of the vertical blur operation in pixels.
 		Keyframe sigma;				///< Sigma keyframe. The amount of spread in the blur operation. Should be larger than radius.
 		Keyframe iterations;		///< Iterations keyframe. The # of blur iterations per pixel. 3 iterations = Gaussian.
+		openshot::BlurMethod method;	///< Blur algorithm (box or Gaussian)
 
 		/// Blank constructor, useful when using Json to load the effect properties
 		Blur();
@@ -60,7 +68,9 @@ namespace openshot
 		/// @param new_vertical_radius The curve to adjust the vertical blur radius (between 0 and 100, rounded to int)
 		/// @param new_sigma The curve to adjust the sigma amount (the size of the blur brush (between 0 and 100), float values accepted)
 		/// @param new_iterations The curve to adjust the # of iterations (between 1 and 100)
-		Blur(Keyframe new_horizontal_radius, Keyframe new_vertical_radius, Keyframe new_sigma, Keyframe new_iterations);
+		/// @param new_method The blur algorithm (box or Gaussian)
+		Blur(Keyframe new_horizontal_radius, Keyframe new_vertical_radius, Keyframe new_sigma, Keyframe new_iterations,
+			 openshot::BlurMethod new_method = BLUR_BOX);
 
 		/// @brief This method is required for all derived classes of ClipBase, and returns a
 		/// new openshot::Frame object. All Clip keyframes and effects are resolved into
@@ -16,13 +16,15 @@
 #if USE_BABL
 #include <babl/babl.h>
 #endif
+#include <algorithm>
 #include <vector>
 #include <cmath>
 
 using namespace openshot;
 
 /// Blank constructor, useful when using Json to load the effect properties
-ChromaKey::ChromaKey() : fuzz(5.0), halo(0), method(CHROMAKEY_BASIC) {
+ChromaKey::ChromaKey() : fuzz(5.0), halo(0), method(CHROMAKEY_BASIC),
+	key_R(-1), key_G(-1), key_B(-1), key_method(CHROMAKEY_BASIC) {
 	// Init default color
 	color = Color();
 
@@ -33,7 +35,8 @@ ChromaKey::ChromaKey() : fuzz(5.0), halo(0), method(CHROMAKEY_BASIC) {
 // Standard constructor, which takes an openshot::Color object, a 'fuzz' factor,
 // an optional halo distance and an optional keying method.
 ChromaKey::ChromaKey(Color color, Keyframe fuzz, Keyframe halo, ChromaKeyMethod method) :
-	color(color), fuzz(fuzz), halo(halo), method(method)
+	color(color), fuzz(fuzz), halo(halo), method(method),
+	key_R(-1), key_G(-1), key_B(-1), key_method(CHROMAKEY_BASIC)
 {
 	// Init effect properties
 	init_effect_details();
@@ -53,6 +56,173 @@ void ChromaKey::init_effect_details()
 	info.has_video = true;
 }
 
+#if USE_BABL
+// CIEDE2000 distance between the key color and a pixel (both in "CIE Lab u8")
+static float cie_distance(const float *key, const unsigned char *pc)
+{
+	float KL = 1.0;
+	float KC = 1.0;
+	float KH = 1.0;
+	float pi = 4 * std::atan(1);
+
+	float L1 = key[0] / 2.55;
+	float a1 = key[1] - 127;
+	float b1 = key[2] - 127;
+	float C1 = std::sqrt(a1 * a1 + b1 * b1);
+
+	float L2 = ((float) pc[0]) / 2.55;
+	int   a2 = pc[1] - 127;
+	int   b2 = pc[2] - 127;
+	float C2 = std::sqrt(a2 * a2 + b2 * b2);
+
+	float delta_L_prime = L2 - L1;
+	float L_bar = (L1 + L2) / 2;
+	float C_bar = (C1 + C2) / 2;
+
+	float a_prime_multiplier = 1 + 0.5 * (1 - std::sqrt(C_bar / (C_bar + 25)));
+	float a1_prime = a1 * a_prime_multiplier;
+	float a2_prime = a2 * a_prime_multiplier;
+
+	float C1_prime = std::sqrt(a1_prime * a1_prime + b1 * b1);
+	float C2_prime = std::sqrt(a2_prime * a2_prime + b2 * b2);
+	float C_prime_bar = (C1_prime + C2_prime) / 2;
+	float delta_C_prime = C2_prime - C1_prime;
+
+	float h1_prime = std::atan2(b1, a1_prime) * 180 / pi;
+	float h2_prime = std::atan2(b2, a2_prime) * 180 / pi;
+
+	float delta_h_prime = h2_prime - h1_prime;
+	double H_prime_bar = (C1_prime != 0 && C2_prime != 0) ? (h1_prime + h2_prime) / 2 : (h1_prime + h2_prime);
+
+	if (delta_h_prime < -180)
+	{
+		delta_h_prime += 360;
+		if (H_prime_bar < 180)
+			H_prime_bar += 180;
+		else
+			H_prime_bar -= 180;
+	}
+	else if (delta_h_prime > 180)
+	{
+		delta_h_prime -= 360;
+		if (H_prime_bar < 180)
+			H_prime_bar += 180;
+		else
+			H_prime_bar -= 180;
+	}
+
+	float delta_H_prime = 2 * std::sqrt(C1_prime * C2_prime) * std::sin(delta_h_prime * pi / 360);
+
+	float T = 1
+		- 0.17 * std::cos((H_prime_bar - 30) * pi / 180)
+		+ 0.24 * std::cos(H_prime_bar * pi / 90)
+		+ 0.32 * std::cos((3 * H_prime_bar + 6) * pi / 180)
+		- 0.20 * std::cos((4 * H_prime_bar - 64) * pi / 180);
+
+	float SL = 1 + 0.015 * std::pow(L_bar - 50, 2) / std::sqrt(20 + std::pow(L_bar - 50, 2));
+	float SC = 1 + 0.045 * C_prime_bar;
+	float SH = 1 + 0.015 * C_prime_bar * T;
+	float RT = -2 * std::sqrt(C_prime_bar / (C_prime_bar + 25)) * std::sin(pi / 3 * std::exp(-std::pow((H_prime_bar - 275) / 25, 2)));
+	return std::sqrt(std::pow(delta_L_prime / KL / SL, 2)
+				+ std::pow(delta_C_prime / KC / SC, 2)
+				+ std::pow(delta_h_prime / KH / SH, 2)
+				+ RT * delta_C_prime / KC / SC * delta_H_prime / KH / SH);
+}
+
+// Calculate the distances between a block of converted pixels and the (converted) key color.
+// Each method is a simple loop without branches, which the compiler can vectorize.
+static void key_distances(ChromaKeyMethod method, const unsigned char *converted, const float *key, float *distances, int count)
+{
+	const float *pf = (const float *) converted;
+	const unsigned char *pc = converted;
+
+	switch(method)
+	{
+	case CHROMAKEY_HSVL_H:
+		for (int i = 0; i < count; ++i)
+		{
+			// Hues wrap around (from 1.0 to 0.0), so use the shortest distance
+			float tmp = std::fabs(pf[i * 3] - key[0]);
+			distances[i] = std::min(tmp, 1.0f - tmp) * 500;
+		}
+		break;
+
+	case CHROMAKEY_HSV_S:
+	case CHROMAKEY_HSL_S:
+		for (int i = 0; i < count; ++i)
+			distances[i] = std::fabs(pf[i * 3 + 1] - key[1]) * 255;
+		break;
+
+	case CHROMAKEY_HSV_V:
+	case CHROMAKEY_HSL_L:
+		for (int i = 0; i < count; ++i)
+			distances[i] = std::fabs(pf[i * 3 + 2] - key[2]) * 255;
+		break;
+
+	case CHROMAKEY_YCBCR:
+		for (int i = 0; i < count; ++i)
+		{
+			float db = pc[i * 3 + 1] - key[1];
+			float dr = pc[i * 3 + 2] - key[2];
+			distances[i] = std::sqrt(db * db + dr * dr);
+		}
+		break;
+
+	case CHROMAKEY_CIE_LCH_L:
+		for (int i = 0; i < count; ++i)
+			distances[i] = std::fabs(pf[i * 3] - key[0]);
+		break;
+
+	case CHROMAKEY_CIE_LCH_C:
+		for (int i = 0; i < count; ++i)
+			distances[i] = std::fabs(pf[i * 3 + 1] - key[1]);
+		break;
+
+	case CHROMAKEY_CIE_LCH_H:
+		for (int i = 0; i < count; ++i)
+		{
+			// Hues in LCH(ab) are an angle on a color wheel.
+			// We are tring to find the angular distance
+			// between the two angles. It can never be more
+			// than 180 degrees - if it is, there is a closer
+			// angle that can be calculated by going in the
+			// other diretion, which  can be found by
+			// subtracting the angle we have from 360.
+			float tmp = std::fabs(pf[i * 3 + 2] - key[2]);
+			distances[i] = std::min(tmp, 360.0f - tmp);
+		}
+		break;
+
+	case CHROMAKEY_CIE_DISTANCE:
+		for (int i = 0; i < count; ++i)
+			distances[i] = cie_distance(key, pc + i * 3);
+		break;
+
+	case CHROMAKEY_BASIC:
+		break;
+	}
+}
+#endif
+
+// Remove pixels which match the key color (and fade pixels within the halo)
+static void apply_key(unsigned char *pixels, const float *distances, int count, float threshold, float halothreshold)
+{
+	for (int i = 0; i < count; ++i)
+	{
+		float distance = distances[i];
+		float alphamult = (distance <= threshold) ? 0.0f :
+			(distance <= threshold + halothreshold) ? (distance - threshold) / halothreshold : 1.0f;
+
+		// Due to premultiplied alpha, we must also scale the individual
+		// color channels (or else artifacts are left behind)
+		unsigned char *pixel = pixels + i * 4;
+		pixel[0] *= alphamult;
+		pixel[1] *= alphamult;
+		pixel[2] *= alphamult;
+		pixel[3] *= alphamult;
+	}
+}
+
 // This method is required for all derived classes of EffectBase, and returns a
 // modified openshot::Frame object
 //
@@ -111,7 +281,12 @@ std::shared_ptr<openshot::Frame> ChromaKey::GetFrame(std::shared_ptr<openshot::F
 	int width = image->width();
 	int height = image->height();
 
-	int pixelcount = width * height;
+	// Get the pixel buffer once (before any threads access it). Scanlines of
+	// 32 bit images are not padded, so rows of pixels are contiguous.
+	unsigned char *pixels = image->bits();
+
+	// The image is processed in tiles of rows (in parallel), each converted with a single babl call
+	int tile_rows = std::max(1, 16384 / std::max(width, 1));
 
 #if USE_BABL
 	if (method > CHROMAKEY_BASIC && method <= CHROMAKEY_LAST_METHOD)
@@ -127,8 +302,7 @@ std::shared_ptr<openshot::Frame> ChromaKey::GetFrame(std::shared_ptr<openshot::F
 		Babl const *rgb = babl_format("R'G'B'A u8");
 		Babl const *format = 0;
 		Babl const *fish = 0;
-		std::vector<unsigned char> pixelbuf;
-		int rowwidth = 0;
+		int pixelsize = 0;
 
 		switch(method)
 		{
@@ -136,348 +310,77 @@ std::shared_ptr<openshot::Frame> ChromaKey::GetFrame(std::shared_ptr<openshot::F
 		case CHROMAKEY_HSV_S:
 		case CHROMAKEY_HSV_V:
 			format = babl_format("HSV float");
-			rowwidth = width * sizeof(float) * 3;
+			pixelsize = sizeof(float) * 3;
 			break;
 
 		case CHROMAKEY_HSL_S:
 		case CHROMAKEY_HSL_L:
 			format = babl_format("HSL float");
-			rowwidth = width * sizeof(float) * 3;
+			pixelsize = sizeof(float) * 3;
 			break;
 
 		case CHROMAKEY_CIE_LCH_L:
 		case CHROMAKEY_CIE_LCH_C:
 		case CHROMAKEY_CIE_LCH_H:
 			format = babl_format("CIE LCH(ab) float");
-			rowwidth = width * sizeof(float) * 3;
+			pixelsize = sizeof(float) * 3;
 			break;
 
 		case CHROMAKEY_CIE_DISTANCE:
 			format = babl_format("CIE Lab u8");
-			rowwidth = width * 3;
+			pixelsize = 3;
 			break;
 
 		case CHROMAKEY_YCBCR:
 			format = babl_format("Y'CbCr u8");
-			rowwidth = width * 3;
+			pixelsize = 3;
 			break;
 
 		case CHROMAKEY_BASIC:
 			break;
 		}
 
-		pixelbuf.resize(rowwidth * height);
-
 		if (rgb && format && (fish = babl_fish(rgb, format)) != 0)
 		{
-			int		idx = 0;
-			unsigned char	mask_in[4];
-			union { float f[4]; unsigned char u[4]; } mask;
-			float const *pf = (float *) pixelbuf.data();
-			unsigned char const *pc = pixelbuf.data();
-
-			mask_in[0] = mask_R;
-			mask_in[1] = mask_G;
-			mask_in[2] = mask_B;
-			mask_in[3] = 255;
-			babl_process(fish, mask_in, &mask, 1);
-
-			if (0) //image->bytesPerLine() == width * 4)
-			{
-				// Because babl_process is expensive to call, but efficient
-				// with long sequences of pixels, attempt to convert the
-				// entire buffer at once if we can
-				babl_process(fish, image->bits(), pixelbuf.data(), pixelcount);
-			}
-			else
-			{
-				unsigned char *rowdata = pixelbuf.data();
-
-				for (int y = 0; y < height; ++y, rowdata += rowwidth)
-					babl_process(fish, image->scanLine(y), rowdata, width);
-			}
-
-			switch(method)
+			// Convert the key color (which is cached until the color or method changes)
+			float key[3];
 			{
-			case CHROMAKEY_HSVL_H:
-				for (int y = 0; y < height; ++y)
-				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pf += 3)
-					{
-						float tmp = fabs(pf[0] - mask.f[0]);
-
-						if (tmp > 0.5)
-							tmp = 1.0 - tmp;
-						tmp *= 500;
-						if (tmp <= threshold)
-						{
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-						}
-						else if (tmp <= threshold + halothreshold)
-						{
-							float alphamult = (tmp - threshold) / halothreshold;
-
-							pixel[0] *= alphamult;
-							pixel[1] *= alphamult;
-							pixel[2] *= alphamult;
-							pixel[3] *= alphamult;
-						}
-					}
-				}
-				break;
-
-			case CHROMAKEY_HSV_S:
-			case CHROMAKEY_HSL_S:
-				for (int y = 0; y < height; ++y)
-				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pf += 3)
-					{
-						float tmp = fabs(pf[1] - mask.f[1]) * 255;
-
-						if (tmp <= threshold)
-						{
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-						}
-						else if (tmp <= threshold + halothreshold)
-						{
-							float alphamult = (tmp - threshold) / halothreshold;
-
-							pixel[0] *= alphamult;
-							pixel[1] *= alphamult;
-							pixel[2] *= alphamult;
-							pixel[3] *= alphamult;
-						}
-					}
-				}
-				break;
-
-			case CHROMAKEY_HSV_V:
-			case CHROMAKEY_HSL_L:
-				for (int y = 0; y < height; ++y)
-				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pf += 3)
-					{
-						float tmp = fabs(pf[2] - mask.f[2]) * 255;
-
-						if (tmp <= threshold)
-						{
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-						}
-						else if (tmp <= threshold + halothreshold)
-						{
-							float alphamult = (tmp - threshold) / halothreshold;
-
-							pixel[0] *= alphamult;
-							pixel[1] *= alphamult;
-							pixel[2] *= alphamult;
-							pixel[3] *= alphamult;
-						}
-					}
-				}
-				break;
-
-			case CHROMAKEY_YCBCR:
-				for (int y = 0; y < height; ++y)
-				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pc += 3)
-					{
-						int db = (int) pc[1] - mask.u[1];
-						int dr = (int) pc[2] - mask.u[2];
-						float tmp = sqrt(db * db + dr * dr);
-
-						if (tmp <= threshold)
-						{
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-						}
-						else if (tmp <= threshold + halothreshold)
-						{
-							float alphamult = (tmp - threshold) / halothreshold;
-
-							pixel[0] *= alphamult;
-							pixel[1] *= alphamult;
-							pixel[2] *= alphamult;
-							pixel[3] *= alphamult;
-						}
-					}
-				}
-				break;
-
-			case CHROMAKEY_CIE_LCH_L:
-				for (int y = 0; y < height; ++y)
+				const std::lock_guard<std::mutex> lock(key_mutex);
+				if (key_R != mask_R || key_G != mask_G || key_B != mask_B || key_method != method)
 				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pf += 3)
-					{
-						float tmp = fabs(pf[0] - mask.f[0]);
-
-						if (tmp <= threshold)
-						{
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-						}
-						else if (tmp <= threshold + halothreshold)
-						{
-							float alphamult = (tmp - threshold) / halothreshold;
-
-							pixel[0] *= alphamult;
-							pixel[1] *= alphamult;
-							pixel[2] *= alphamult;
-							pixel[3] *= alphamult;
-						}
-					}
+					unsigned char	mask_in[4];
+					union { float f[4]; unsigned char u[4]; } mask;
+
+					mask_in[0] = mask_R;
+					mask_in[1] = mask_G;
+					mask_in[2] = mask_B;
+					mask_in[3] = 255;
+					babl_process(fish, mask_in, &mask, 1);
+
+					for (int c = 0; c < 3; ++c)
+						key_values[c] = (pixelsize == 3) ? mask.u[c] : mask.f[c];
+					key_R = mask_R;
+					key_G = mask_G;
+					key_B = mask_B;
+					key_method = method;
 				}
-				break;
-
-			case CHROMAKEY_CIE_LCH_C:
-				for (int y = 0; y < height; ++y)
-				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pf += 3)
-					{
-						float tmp = fabs(pf[1] - mask.f[1]);
-
-						if (tmp <= threshold)
-						{
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-						}
-						else if (tmp <= threshold + halothreshold)
-						{
-							float alphamult = (tmp - threshold) / halothreshold;
-
-							pixel[0] *= alphamult;
-							pixel[1] *= alphamult;
-							pixel[2] *= alphamult;
-							pixel[3] *= alphamult;
-						}
-					}
-				}
-				break;
+				std::copy(key_values, key_values + 3, key);
+			}
 
-			case CHROMAKEY_CIE_LCH_H:
-				for (int y = 0; y < height; ++y)
-				{
-					unsigned char *pixel = image->scanLine(y);
-
-					for (int x = 0; x < width; ++x, pixel += 4, pf += 3)
-					{
-						// Hues in LCH(ab) are an angle on a color wheel.
-						// We are tring to find the angular distance
-						// between the two angles. It can never be more
-						// than 180 degrees - if it is, there is a closer
-						// angle that can be calculated by going in the
-						// other diretion, which  can be found by
-						// subtracting the angle we have from 360.
-						float tmp = fabs(pf[2] - mask.f[2]);
-
-						if (tmp > 180.0)
-							tmp = 360.0 - tmp;
-						if (tmp <= threshold)
-							pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-					}
-				}
-				break;
+			// LCH hue keying has no halo
+			float halo_value = (method == CHROMAKEY_CIE_LCH_H) ? 0 : halothreshold;
 
-			case CHROMAKEY_CIE_DISTANCE:
-				{
-					float KL = 1.0;
-					float KC = 1.0;
-					float KH = 1.0;
-					float pi = 4 * std::atan(1);
-
-					float L1 = ((float) mask.u[0]) / 2.55;
-					float a1 = mask.u[1] - 127;
-					float b1 = mask.u[2] - 127;
-					float C1 = std::sqrt(a1 * a1 + b1 * b1);
-
-					for (int y = 0; y < height; ++y)
-					{
-						unsigned char *pixel = image->scanLine(y);
-
-						for (int x = 0; x < width; ++x, pixel += 4, pc += 3)
-						{
-							float L2 = ((float) pc[0]) / 2.55;
-							int   a2 = pc[1] - 127;
-							int   b2 = pc[2] - 127;
-							float C2 = std::sqrt(a2 * a2 + b2 * b2);
-
-							float delta_L_prime = L2 - L1;
-							float L_bar = (L1 + L2) / 2;
-							float C_bar = (C1 + C2) / 2;
-
-							float a_prime_multiplier = 1 + 0.5 * (1 - std::sqrt(C_bar / (C_bar + 25)));
-							float a1_prime = a1 * a_prime_multiplier;
-							float a2_prime = a2 * a_prime_multiplier;
-
-							float C1_prime = std::sqrt(a1_prime * a1_prime + b1 * b1);
-							float C2_prime = std::sqrt(a2_prime * a2_prime + b2 * b2);
-							float C_prime_bar = (C1_prime + C2_prime) / 2;
-							float delta_C_prime = C2_prime - C1_prime;
-
-							float h1_prime = std::atan2(b1, a1_prime) * 180 / pi;
-							float h2_prime = std::atan2(b2, a2_prime) * 180 / pi;
-
-							float delta_h_prime = h2_prime - h1_prime;
-							double H_prime_bar = (C1_prime != 0 && C2_prime != 0) ? (h1_prime + h2_prime) / 2 : (h1_prime + h2_prime);
-
-							if (delta_h_prime < -180)
-							{
-								delta_h_prime += 360;
-								if (H_prime_bar < 180)
-									H_prime_bar += 180;
-								else
-									H_prime_bar -= 180;
-							}
-							else if (delta_h_prime > 180)
-							{
-								delta_h_prime -= 360;
-								if (H_prime_bar < 180)
-									H_prime_bar += 180;
-								else
-									H_prime_bar -= 180;
-							}
-
-							float delta_H_prime = 2 * std::sqrt(C1_prime * C2_prime) * std::sin(delta_h_prime * pi / 360);
-
-							float T = 1
-								- 0.17 * std::cos((H_prime_bar - 30) * pi / 180)
-								+ 0.24 * std::cos(H_prime_bar * pi / 90)
-								+ 0.32 * std::cos((3 * H_prime_bar + 6) * pi / 180)
-								- 0.20 * std::cos((4 * H_prime_bar - 64) * pi / 180);
-
-							float SL = 1 + 0.015 * std::pow(L_bar - 50, 2) / std::sqrt(20 + std::pow(L_bar - 50, 2));
-							float SC = 1 + 0.045 * C_prime_bar;
-							float SH = 1 + 0.015 * C_prime_bar * T;
-							float RT = -2 * std::sqrt(C_prime_bar / (C_prime_bar + 25)) * std::sin(pi / 3 * std::exp(-std::pow((H_prime_bar - 275) / 25, 2)));
-							float delta_E = std::sqrt(std::pow(delta_L_prime / KL / SL, 2)
-										+ std::pow(delta_C_prime / KC / SC, 2)
-										+ std::pow(delta_h_prime / KH / SH, 2)
-										+ RT * delta_C_prime / KC / SC * delta_H_prime / KH / SH);
-							if (delta_E <= threshold)
-							{
-								pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-							}
-							else if (delta_E <= threshold + halothreshold)
-							{
-								float alphamult = (delta_E - threshold) / halothreshold;
-
-								pixel[0] *= alphamult;
-								pixel[1] *= alphamult;
-								pixel[2] *= alphamult;
-								pixel[3] *= alphamult;
-							}
-						}
-					}
-				}
-				break;
+			#pragma omp parallel for shared (pixels) schedule(dynamic)
+			for (int tile = 0; tile < height; tile += tile_rows)
+			{
+				int count = std::min(tile_rows, height - tile) * width;
+				unsigned char *tile_pixels = pixels + tile * width * 4;
+				std::vector<unsigned char> converted(count * pixelsize);
+				std::vector<float> distances(count);
+
+				babl_process(fish, tile_pixels, converted.data(), count);
+				key_distances(method, converted.data(), key, distances.data(), count);
+				apply_key(tile_pixels, distances.data(), count, threshold, halo_value);
 			}
 
 			return frame;
@@ -485,28 +388,29 @@ std::shared_ptr<openshot::Frame> ChromaKey::GetFrame(std::shared_ptr<openshot::F
 	}
 #endif
 
-	// Loop through pixels
-	for (int y = 0; y < height; ++y)
+	#pragma omp parallel for shared (pixels) schedule(dynamic)
+	for (int tile = 0; tile < height; tile += tile_rows)
 	{
-		unsigned char * pixel = image->scanLine(y);
+		int count = std::min(tile_rows, height - tile) * width;
+		unsigned char *tile_pixels = pixels + tile * width * 4;
+		std::vector<float> distances(count);
 
-		for (int x = 0; x < width; ++x, pixel += 4)
+		for (int i = 0; i < count; ++i)
 		{
-			float A = pixel[3];
-			unsigned char R = (pixel[0] / A) * 255.0;
-			unsigned char G = (pixel[1] / A) * 255.0;
-			unsigned char B = (pixel[2] / A) * 255.0;
-
-		        // Get distance between mask color and pixel color
-			long distance = Color::GetDistance((long)R, (long)G, (long)B, mask_R, mask_G, mask_B);
-
-			if (distance <= threshold) {
-				// MATCHED - Make pixel transparent
-				// Due to premultiplied alpha, we must also zero out
-				// the individual color channels (or else artifacts are left behind)
-				pixel[0] = pixel[1] = pixel[2] = pixel[3] = 0;
-			}
+			const unsigned char *pixel = tile_pixels + i * 4;
+
+			// Undo the premultiplied alpha (fully transparent pixels are black)
+			float A = std::max<float>(pixel[3], 1.0f);
+			long R = (unsigned char) ((pixel[0] / A) * 255.0);
+			long G = (unsigned char) ((pixel[1] / A) * 255.0);
+			long B = (unsigned char) ((pixel[2] / A) * 255.0);
+
+			// Get distance between mask color and pixel color
+			distances[i] = Color::GetDistance(R, G, B, mask_R, mask_G, mask_B);
 		}
+
+		// MATCHED pixels are made transparent (the basic method has no halo)
+		apply_key(tile_pixels, distances.data(), count, threshold, 0);
 	}
 
 	// return the modified frame
@@ -22,6 +22,7 @@
 #include "../Enums.h"
 
 #include <memory>
+#include <mutex>
 #include <string>
 
 namespace openshot
@@ -41,6 +42,11 @@ namespace openshot
 		Keyframe halo;
 		ChromaKeyMethod method;
 
+		long key_R, key_G, key_B;	///< Key color of the cached key conversion
+		ChromaKeyMethod key_method;	///< Keying method of the cached key conversion
+		float key_values[3];		///< Key color converted to the color space of the keying method
+		std::mutex key_mutex;		///< Protects the cached key conversion (frames can be processed in parallel)
+
 		/// Init effect settings
 		void init_effect_details();
 
@@ -13,6 +13,9 @@
 #include "Mask.h"
 
 #include "Exceptions.h"
+#include "OpenMPUtilities.h"
+
+#include <algorithm>
 
 #include "ReaderBase.h"
 #include "ChunkReader.h"
@@ -26,14 +29,14 @@
 using namespace openshot;
 
 /// Blank constructor, useful when using Json to load the effect properties
-Mask::Mask() : reader(NULL), replace_image(false), needs_refresh(true) {
+Mask::Mask() : reader(NULL), replace_image(false) {
 	// Init effect properties
 	init_effect_details();
 }
 
 // Default constructor
 Mask::Mask(ReaderBase *mask_reader, Keyframe mask_brightness, Keyframe mask_contrast) :
-		reader(mask_reader), brightness(mask_brightness), contrast(mask_contrast), replace_image(false), needs_refresh(true)
+		reader(mask_reader), brightness(mask_brightness), contrast(mask_contrast), replace_image(false)
 {
 	// Init effect properties
 	init_effect_details();
@@ -53,95 +56,136 @@ void Mask::init_effect_details()
 	info.has_video = true;
 }
 
+// Get the mask image for a frame, scaled to a specific size
+std::shared_ptr<QImage> Mask::get_mask_image(int64_t frame_number, QSize size) {
+	std::shared_ptr<QImage> mask_image;
+	ReaderBase *mask_reader = NULL;
+	{
+		// Only lock this effect's reader (other masks can be processed at the same time)
+		const std::lock_guard<std::mutex> lock(reader_mutex);
+
+		// No reader (bail on applying the mask)
+		if (!reader)
+			return mask_image;
+		mask_reader = reader;
+
+		// Check if mask reader is open
+		if (!reader->IsOpen()) {
+			// Decode the mask no larger than our parent clip needs (if any)
+			reader->ParentClip(ParentClip());
+			reader->Open();
+		}
+
+		// A single image is the same mask for every frame
+		if (reader->info.has_single_image)
+			frame_number = 1;
+
+		// Use cached mask (if it was already scaled to this size)
+		std::shared_ptr<Frame> cached_mask = mask_cache.GetFrame(frame_number);
+		if (cached_mask && cached_mask->GetImage()->size() == size)
+			return cached_mask->GetImage();
+
+		mask_image = reader->GetFrame(frame_number)->GetImage();
+	}
+
+	// Resize mask image to match frame size (only if needed)
+	if (mask_image->size() != size)
+		mask_image = std::make_shared<QImage>(
+			mask_image->scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
+
+	// Cache scaled mask (unless the reader was replaced in the meantime)
+	const std::lock_guard<std::mutex> lock(reader_mutex);
+	if (reader == mask_reader) {
+		auto mask_frame = std::make_shared<Frame>(frame_number, size.width(), size.height(), "#000000");
+		mask_frame->AddImage(mask_image);
+		mask_cache.SetMaxBytesFromInfo(OPEN_MP_NUM_PROCESSORS * 2, size.width(), size.height(), 0, 0);
+		mask_cache.Add(mask_frame);
+	}
+
+	return mask_image;
+}
+
 // This method is required for all derived classes of EffectBase, and returns a
 // modified openshot::Frame object
 std::shared_ptr<openshot::Frame> Mask::GetFrame(std::shared_ptr<openshot::Frame> frame, int64_t frame_number) {
-	// Get the mask image (from the mask reader)
+	// Get the frame image
 	std::shared_ptr<QImage> frame_image = frame->GetImage();
 
-	// Check if mask reader is open
-	#pragma omp critical (open_mask_reader)
-	{
-		if (reader && !reader->IsOpen())
-			reader->Open();
-	}
+	// Get mask image (scaled to the frame size)
+	std::shared_ptr<QImage> mask_image = get_mask_image(frame_number, frame_image->size());
 
 	// No reader (bail on applying the mask)
-	if (!reader)
+	if (!mask_image)
 		return frame;
 
-	// Get mask image (if missing or different size than frame image)
-	#pragma omp critical (open_mask_reader)
-	{
-		if (!original_mask || !reader->info.has_single_image || needs_refresh ||
-			(original_mask && original_mask->size() != frame_image->size())) {
-
-			// Only get mask if needed
-			auto mask_without_sizing = std::make_shared<QImage>(
-				*reader->GetFrame(frame_number)->GetImage());
-
-			// Resize mask image to match frame size
-			original_mask = std::make_shared<QImage>(
-				mask_without_sizing->scaled(
-					frame_image->width(), frame_image->height(),
-					Qt::IgnoreAspectRatio, Qt::SmoothTransformation));
-		}
-	}
-
-	// Refresh no longer needed
-	needs_refresh = false;
-
 	// Get pixel arrays
 	unsigned char *pixels = (unsigned char *) frame_image->bits();
-	unsigned char *mask_pixels = (unsigned char *) original_mask->bits();
+	const unsigned char *mask_pixels = (const unsigned char *) mask_image->constBits();
 
 	double contrast_value = (contrast.GetValue(frame_number));
 	double brightness_value = (brightness.GetValue(frame_number));
 
-	// Loop through mask pixels, and apply average gray value to frame alpha channel
-	for (int pixel = 0, byte_index=0; pixel < original_mask->width() * original_mask->height(); pixel++, byte_index+=4)
-	{
-		// Get the RGB values from the pixel
-		int R = mask_pixels[byte_index];
-		int G = mask_pixels[byte_index + 1];
-		int B = mask_pixels[byte_index + 2];
-		int A = mask_pixels[byte_index + 3];
-
-		// Get the average luminosity
-		int gray_value = qGray(R, G, B);
-
-		// Adjust the brightness
-		gray_value += (255 * brightness_value);
+	// Adjust the brightness and contrast of every possible gray value (once per frame)
+	int adjusted_gray[256];
+	float factor = (20 / std::fmax(0.00001, 20.0 - contrast_value));
+	for (int gray = 0; gray < 256; gray++) {
+		int gray_value = gray + (255 * brightness_value);
+		adjusted_gray[gray] = (factor * (gray_value - 128) + 128);
+	}
 
-		// Adjust the contrast
-		float factor = (20 / std::fmax(0.00001, 20.0 - contrast_value));
-		gray_value = (factor * (gray_value - 128) + 128);
+	// Loop through mask pixels, and apply average gray value to frame alpha channel
+	// (rows are independent, and the loops below are simple enough to vectorize)
+	const int width = mask_image->width();
+	const int height = mask_image->height();
 
-		// Calculate the % change in alpha
-		float alpha_percent = float(constrain(A - gray_value)) / 255.0;
+	#pragma omp parallel for shared(pixels, mask_pixels, adjusted_gray)
+	for (int row = 0; row < height; row++)
+	{
+		const unsigned char *mask_row = mask_pixels + (row * width * 4);
+		unsigned char *row_pixels = pixels + (row * width * 4);
 
-		// Set the alpha channel to the gray value
 		if (replace_image) {
-			// Replace frame pixels with gray value (including alpha channel)
-			pixels[byte_index + 0] = constrain(255 * alpha_percent);
-			pixels[byte_index + 1] = constrain(255 * alpha_percent);
-			pixels[byte_index + 2] = constrain(255 * alpha_percent);
-			pixels[byte_index + 3] = constrain(255 * alpha_percent);
+			for (int byte_index = 0; byte_index < width * 4; byte_index += 4) {
+				// Calculate the % change in alpha
+				int gray_value = adjusted_gray[qGray(mask_row[byte_index], mask_row[byte_index + 1], mask_row[byte_index + 2])];
+				float alpha_percent = float(std::min(255, std::max(0, mask_row[byte_index + 3] - gray_value))) / 255.0;
+
+				// Replace frame pixels with gray value (including alpha channel)
+				unsigned char gray = std::min(255, std::max(0, int(255 * alpha_percent)));
+				row_pixels[byte_index + 0] = gray;
+				row_pixels[byte_index + 1] = gray;
+				row_pixels[byte_index + 2] = gray;
+				row_pixels[byte_index + 3] = gray;
+			}
 		} else {
-			// Mulitply new alpha value with all the colors (since we are using a premultiplied
-			// alpha format)
-			pixels[byte_index + 0] *= alpha_percent;
-			pixels[byte_index + 1] *= alpha_percent;
-			pixels[byte_index + 2] *= alpha_percent;
-			pixels[byte_index + 3] *= alpha_percent;
+			for (int byte_index = 0; byte_index < width * 4; byte_index += 4) {
+				// Calculate the % change in alpha
+				int gray_value = adjusted_gray[qGray(mask_row[byte_index], mask_row[byte_index + 1], mask_row[byte_index + 2])];
+				float alpha_percent = float(std::min(255, std::max(0, mask_row[byte_index + 3] - gray_value))) / 255.0;
+
+				// Mulitply new alpha value with all the colors (since we are using a premultiplied
+				// alpha format)
+				row_pixels[byte_index + 0] *= alpha_percent;
+				row_pixels[byte_index + 1] *= alpha_percent;
+				row_pixels[byte_index + 2] *= alpha_percent;
+				row_pixels[byte_index + 3] *= alpha_percent;
+			}
 		}
-
 	}
 
 	// return the modified frame
 	return frame;
 }
 
+// Set a new reader to be used by the mask effect (grayscale image)
+void Mask::Reader(ReaderBase *new_reader) {
+	const std::lock_guard<std::mutex> lock(reader_mutex);
+	reader = new_reader;
+
+	// The cached masks came from the previous reader
+	mask_cache.Clear();
+}
+
 // Generate JSON string of this object
 std::string Mask::Json() const {
 
@@ -199,10 +243,12 @@ void Mask::SetJsonValue(const Json::Value root) {
 		contrast.SetJsonValue(root["contrast"]);
 	if (!root["reader"].isNull()) // does Json contain a reader?
 	{
-		#pragma omp critical (open_mask_reader)
 		{
-			// This reader has changed, so refresh cached assets
-			needs_refresh = true;
+			// Protect the reader from frames being processed in parallel
+			const std::lock_guard<std::mutex> lock(reader_mutex);
+
+			// This reader has changed, so refresh cached masks
+			mask_cache.Clear();
 
 			if (!root["reader"]["type"].isNull()) // does the reader Json contain a 'type'?
 			{
@@ -15,11 +15,15 @@
 
 #include "../EffectBase.h"
 
+#include "../CacheMemory.h"
 #include "../Json.h"
 #include "../KeyFrame.h"
 
 #include <string>
 #include <memory>
+#include <mutex>
+
+#include <QSize>
 
 namespace openshot
 {
@@ -37,12 +41,15 @@ namespace openshot
 	{
 	private:
 		ReaderBase *reader;
-		std::shared_ptr<QImage> original_mask;
-		bool needs_refresh;
+		CacheMemory mask_cache;		///< Mask images (already scaled to the frame size) by mask frame number
+		std::mutex reader_mutex;	///< Protects the reader and the mask cache (frames can be processed in parallel)
 
 		/// Init effect settings
 		void init_effect_details();
 
+		/// Get the mask image for a frame, scaled to a specific size (or NULL shared_ptr if there is no reader)
+		std::shared_ptr<QImage> get_mask_image(int64_t frame_number, QSize size);
+
 	public:
 		bool replace_image;		///< Replace the frame image with a grayscale image representing the mask. Great for debugging a mask.
 		Keyframe brightness;	///< Brightness keyframe to control the wipe / mask effect. A constant value here will prevent animation.
@@ -93,7 +100,7 @@ namespace openshot
 		ReaderBase* Reader() { return reader; };
 
 		/// Set a new reader to be used by the mask effect (grayscale image)
-		void Reader(ReaderBase *new_reader) { reader = new_reader; };
+		void Reader(ReaderBase *new_reader);
 	};
 
 }
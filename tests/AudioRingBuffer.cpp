@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Unit tests for openshot::AudioRingBuffer
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <algorithm>
+#include <thread>
+
+#include "openshot_catch.h"
+
+#include "AudioRingBuffer.h"
+
+#include <AppConfig.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+using namespace openshot;
+
+TEST_CASE( "Wrap around", "[libopenshot][audioringbuffer]" )
+{
+	AudioRingBuffer ring(2, 100);
+	CHECK(ring.Available() == 0);
+	CHECK(ring.Free() == 100);
+
+	// Samples numbered 0 to 149 (negative on the right channel)
+	juce::AudioBuffer<float> source(2, 150);
+	for (int sample = 0; sample < 150; sample++) {
+		source.setSample(0, sample, sample);
+		source.setSample(1, sample, -sample);
+	}
+
+	// Only the free samples are written
+	CHECK(ring.Write(source, 0, 150) == 100);
+	CHECK(ring.Free() == 0);
+
+	juce::AudioBuffer<float> destination(2, 80);
+	CHECK(ring.Read(destination, 0, 80) == 80);
+	CHECK(destination.getSample(0, 79) == 79);
+
+	// Write (and read) across the end of the buffer
+	CHECK(ring.Write(source, 100, 50) == 50);
+	CHECK(ring.Available() == 70);
+	CHECK(ring.Read(destination, 0, 80) == 70);
+	CHECK(destination.getSample(0, 0) == 80);
+	CHECK(destination.getSample(0, 19) == 99);
+	CHECK(destination.getSample(0, 20) == 100);
+	CHECK(destination.getSample(1, 69) == -149);
+	CHECK(ring.Available() == 0);
+}
+
+TEST_CASE( "Discard and missing channels", "[libopenshot][audioringbuffer]" )
+{
+	AudioRingBuffer ring(2, 64);
+	juce::AudioBuffer<float> mono(1, 32);
+	mono.clear();
+	mono.setSample(0, 0, 0.5);
+	CHECK(ring.Write(mono, 0, 32) == 32);
+
+	// The missing channel is silent
+	juce::AudioBuffer<float> destination(2, 32);
+	destination.applyGain(0.0);
+	destination.setSample(1, 0, 1.0);
+	CHECK(ring.Read(destination, 0, 1) == 1);
+	CHECK(destination.getSample(0, 0) == 0.5);
+	CHECK(destination.getSample(1, 0) == 0.0);
+
+	ring.Discard();
+	CHECK(ring.Available() == 0);
+	CHECK(ring.Free() == 64);
+}
+
+TEST_CASE( "Single writer and reader threads", "[libopenshot][audioringbuffer]" )
+{
+	AudioRingBuffer ring(1, 256);
+	const int total = 100000;
+
+	// Write increasing samples (in small blocks)
+	std::thread writer([&ring, total]() {
+		juce::AudioBuffer<float> block(1, 37);
+		int written = 0;
+		while (written < total) {
+			int amount = std::min(37, total - written);
+			for (int sample = 0; sample < amount; sample++)
+				block.setSample(0, sample, written + sample);
+			int count = ring.Write(block, 0, amount);
+			written += count;
+			if (count == 0)
+				std::this_thread::yield();
+		}
+	});
+
+	// Every sample is read once, in order
+	juce::AudioBuffer<float> block(1, 64);
+	int read = 0;
+	bool in_order = true;
+	while (read < total) {
+		int count = ring.Read(block, 0, 64);
+		for (int sample = 0; sample < count; sample++)
+			in_order = in_order && block.getSample(0, sample) == read + sample;
+		read += count;
+		if (count == 0)
+			std::this_thread::yield();
+	}
+	writer.join();
+	CHECK(in_order);
+	CHECK(read == total);
+}
@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Unit tests for openshot::Blur effect
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2021 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+#include "openshot_catch.h"
+
+#include "Frame.h"
+#include "effects/Blur.h"
+
+#include <QColor>
+#include <QImage>
+
+using namespace openshot;
+
+// Reference box blur (the previous per-channel implementation, one horizontal
+// and one vertical pass per iteration), used to check and benchmark the effect
+static void reference_blur(QImage& image, int hr, int vr, int iterations)
+{
+	int w = image.width();
+	int h = image.height();
+	QImage copy = image.copy();
+	unsigned char *scl = image.bits();
+	unsigned char *tcl = copy.bits();
+
+	for (int iteration = 0; iteration < iterations; ++iteration) {
+		if (hr > 0) {
+			float iarr = 1.0 / (hr + hr + 1);
+			for (int i = 0; i < h; ++i) {
+				for (int ch = 0; ch < 4; ++ch) {
+					int ti = i * w, li = ti, ri = ti + hr;
+					int fv = scl[ti * 4 + ch], lv = scl[(ti + w - 1) * 4 + ch], val = (hr + 1) * fv;
+					for (int j = 0; j < hr; ++j) val += scl[(ti + j) * 4 + ch];
+					for (int j = 0; j <= hr; ++j) { val += scl[ri++ * 4 + ch] - fv; tcl[ti++ * 4 + ch] = round(val * iarr); }
+					for (int j = hr + 1; j < w - hr; ++j) { val += scl[ri++ * 4 + ch] - scl[li++ * 4 + ch]; tcl[ti++ * 4 + ch] = round(val * iarr); }
+					for (int j = w - hr; j < w; ++j) { val += lv - scl[li++ * 4 + ch]; tcl[ti++ * 4 + ch] = round(val * iarr); }
+				}
+			}
+			std::swap(scl, tcl);
+		}
+		if (vr > 0) {
+			float iarr = 1.0 / (vr + vr + 1);
+			for (int i = 0; i < w; i++) {
+				for (int ch = 0; ch < 4; ++ch) {
+					int ti = i, li = ti, ri = ti + vr * w;
+					int fv = scl[ti * 4 + ch], lv = scl[(ti + w * (h - 1)) * 4 + ch], val = (vr + 1) * fv;
+					for (int j = 0; j < vr; j++) val += scl[(ti + j * w) * 4 + ch];
+					for (int j = 0; j <= vr; j++) { val += scl[ri * 4 + ch] - fv; tcl[ti * 4 + ch] = round(val * iarr); ri += w; ti += w; }
+					for (int j = vr + 1; j < h - vr; j++) { val += scl[ri * 4 + ch] - scl[li * 4 + ch]; tcl[ti * 4 + ch] = round(val * iarr); li += w; ri += w; ti += w; }
+					for (int j = h - vr; j < h; j++) { val += lv - scl[li * 4 + ch]; tcl[ti * 4 + ch] = round(val * iarr); li += w; ti += w; }
+				}
+			}
+			std::swap(scl, tcl);
+		}
+	}
+
+	if (scl != image.bits())
+		image = copy;
+}
+
+// Frame filled with random (opaque) pixels
+static std::shared_ptr<Frame> random_frame(int width, int height)
+{
+	auto f = std::make_shared<Frame>(1, width, height, "#000000");
+	std::shared_ptr<QImage> image = f->GetImage();
+	std::srand(1);
+	for (int y = 0; y < height; ++y)
+		for (int x = 0; x < width; ++x)
+			image->setPixelColor(x, y, QColor(std::rand() % 256, std::rand() % 256, std::rand() % 256));
+	return f;
+}
+
+TEST_CASE( "box blur of a single pixel", "[libopenshot][effect][blur]" )
+{
+	auto f = std::make_shared<Frame>(1, 21, 21, "#000000");
+	f->GetImage()->setPixelColor(10, 10, QColor(255, 255, 255));
+
+	// Horizontal only
+	Blur e(Keyframe(1), Keyframe(0), Keyframe(3), Keyframe(1));
+	auto f_out = e.GetFrame(f, 1);
+	std::shared_ptr<QImage> i = f_out->GetImage();
+
+	CHECK(i->pixelColor(9, 10).red() == 85);
+	CHECK(i->pixelColor(10, 10).red() == 85);
+	CHECK(i->pixelColor(11, 10).red() == 85);
+	CHECK(i->pixelColor(12, 10).red() == 0);
+	CHECK(i->pixelColor(10, 9).red() == 0);
+	CHECK(i->pixelColor(10, 11).red() == 0);
+}
+
+TEST_CASE( "box blur matches reference", "[libopenshot][effect][blur]" )
+{
+	auto f = random_frame(160, 90);
+	QImage expected = f->GetImage()->copy();
+	reference_blur(expected, 6, 4, 3);
+
+	Blur e(Keyframe(6), Keyframe(4), Keyframe(3), Keyframe(3));
+	std::shared_ptr<QImage> i = e.GetFrame(f, 1)->GetImage();
+
+	// Passes are applied in a different order, which can change the rounding slightly
+	int max_difference = 0;
+	for (int y = 0; y < 90; ++y)
+		for (int x = 0; x < 160; ++x)
+			max_difference = std::max(max_difference, std::abs(i->pixelColor(x, y).green() - expected.pixelColor(x, y).green()));
+	CHECK(max_difference <= 2);
+}
+
+TEST_CASE( "gaussian blur", "[libopenshot][effect][blur]" )
+{
+	// Solid colors are not changed
+	auto f = std::make_shared<Frame>(1, 64, 48, "#00ff00");
+	Blur e(Keyframe(1), Keyframe(1), Keyframe(5), Keyframe(1), BLUR_GAUSSIAN);
+	CHECK(e.GetFrame(f, 1)->GetImage()->pixelColor(32, 24) == QColor(Qt::green));
+	CHECK(e.GetFrame(f, 1)->GetImage()->pixelColor(0, 0) == QColor(Qt::green));
+
+	// A single pixel is spread evenly in all directions
+	auto f2 = std::make_shared<Frame>(1, 21, 21, "#000000");
+	f2->GetImage()->setPixelColor(10, 10, QColor(255, 255, 255));
+	Blur e2(Keyframe(1), Keyframe(1), Keyframe(2), Keyframe(1), BLUR_GAUSSIAN);
+	std::shared_ptr<QImage> i = e2.GetFrame(f2, 1)->GetImage();
+
+	CHECK(i->pixelColor(10, 10).red() > i->pixelColor(11, 10).red());
+	CHECK(i->pixelColor(11, 10).red() > i->pixelColor(13, 10).red());
+	CHECK(std::abs(i->pixelColor(9, 10).red() - i->pixelColor(11, 10).red()) <= 1);
+	CHECK(std::abs(i->pixelColor(10, 9).red() - i->pixelColor(11, 10).red()) <= 1);
+}
+
+TEST_CASE( "json", "[libopenshot][effect][blur]" )
+{
+	Blur e;
+	e.method = BLUR_GAUSSIAN;
+
+	Blur e2;
+	e2.SetJsonValue(e.JsonValue());
+	CHECK(e2.method == BLUR_GAUSSIAN);
+}
+
+TEST_CASE( "benchmark against reference", "[.benchmark][libopenshot][effect][blur]" )
+{
+	auto f = random_frame(1920, 1080);
+	QImage reference = f->GetImage()->copy();
+
+	auto start_time = std::chrono::steady_clock::now();
+	reference_blur(reference, 6, 6, 3);
+	auto reference_time = std::chrono::steady_clock::now();
+
+	Blur box(Keyframe(6), Keyframe(6), Keyframe(3), Keyframe(3));
+	box.GetFrame(std::make_shared<Frame>(*f), 1);
+	auto box_time = std::chrono::steady_clock::now();
+
+	Blur gaussian(Keyframe(6), Keyframe(6), Keyframe(30), Keyframe(1), BLUR_GAUSSIAN);
+	gaussian.GetFrame(std::make_shared<Frame>(*f), 1);
+	auto gaussian_time = std::chrono::steady_clock::now();
+
+	WARN("reference box blur: " << std::chrono::duration<double, std::milli>(reference_time - start_time).count() << " ms");
+	WARN("box blur: " << std::chrono::duration<double, std::milli>(box_time - reference_time).count() << " ms");
+	WARN("gaussian blur (sigma 30): " << std::chrono::duration<double, std::milli>(gaussian_time - box_time).count() << " ms");
+}
@@ -0,0 +1,123 @@
+/**
+ * @file
+ * @brief Unit tests for openshot::BufferPool
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <memory>
+
+#include "openshot_catch.h"
+
+#include "BufferPool.h"
+#include "Frame.h"
+
+#include <AppConfig.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <QColor>
+#include <QImage>
+
+using namespace openshot;
+
+TEST_CASE( "Reuse image buffers", "[libopenshot][bufferpool]" )
+{
+	BufferPool *pool = BufferPool::Instance();
+	pool->Clear();
+	pool->ResetStatistics();
+
+	const unsigned char* pixels = nullptr;
+	{
+		std::shared_ptr<QImage> image = pool->GetImage(640, 360, QImage::Format_RGBA8888_Premultiplied);
+		CHECK(image->width() == 640);
+		CHECK(image->height() == 360);
+		CHECK(image->bytesPerLine() == 640 * 4);
+		pixels = image->constBits();
+
+		// Implicitly shared copies keep the buffer in use
+		QImage copy = *image;
+		image.reset();
+		CHECK(pool->GetBytes() == 0);
+		CHECK(copy.constBits() == pixels);
+	}
+	CHECK(pool->GetMisses() == 1);
+	CHECK(pool->GetBytes() >= 640 * 360 * 4);
+
+	// A slightly smaller image (in the same size class) reuses the buffer
+	std::shared_ptr<QImage> image = pool->GetImage(640, 358, QImage::Format_RGBA8888_Premultiplied);
+	image->fill(QColor(Qt::red));
+	CHECK(image->constBits() == pixels);
+	CHECK(image->pixelColor(639, 357) == QColor(Qt::red));
+	CHECK(pool->GetHits() == 1);
+	CHECK(pool->GetBytes() == 0);
+}
+
+TEST_CASE( "Reuse audio buffers", "[libopenshot][bufferpool]" )
+{
+	BufferPool *pool = BufferPool::Instance();
+	pool->Clear();
+	pool->ResetStatistics();
+
+	pool->GetAudioBuffer(2, 1470).reset();
+	CHECK(pool->GetMisses() == 1);
+	CHECK(pool->GetBytes() >= 2 * 1470 * 4);
+
+	std::shared_ptr<juce::AudioBuffer<float>> audio = pool->GetAudioBuffer(2, 1471);
+	CHECK(audio->getNumChannels() == 2);
+	CHECK(audio->getNumSamples() == 1471);
+	CHECK(pool->GetHits() == 1);
+
+	// Small buffers are not pooled
+	pool->GetAudioBuffer(2, 10).reset();
+	CHECK(pool->GetMisses() == 1);
+	CHECK(pool->GetBytes() == 0);
+}
+
+TEST_CASE( "Frames return buffers", "[libopenshot][bufferpool]" )
+{
+	BufferPool *pool = BufferPool::Instance();
+	pool->Clear();
+	pool->ResetStatistics();
+
+	for (int64_t number = 1; number <= 10; number++) {
+		auto f = std::make_shared<Frame>(number, 320, 180, "#00ff00", 1470, 2);
+		CHECK(f->GetImage()->pixelColor(160, 90) == QColor(Qt::green));
+		CHECK(f->audio->getMagnitude(0, 0, 1470) == 0.0f);
+		f->audio->setSample(0, 100, 1.0f);
+	}
+
+	// Only the first frame allocated its image and audio buffers
+	CHECK(pool->GetMisses() == 2);
+	CHECK(pool->GetHits() == 18);
+}
+
+TEST_CASE( "Max bytes", "[libopenshot][bufferpool]" )
+{
+	BufferPool *pool = BufferPool::Instance();
+	pool->Clear();
+	pool->ResetStatistics();
+	const int64_t max_bytes = pool->GetMaxBytes();
+
+	pool->GetImage(320, 180, QImage::Format_RGBA8888_Premultiplied).reset();
+	CHECK(pool->GetBytes() > 0);
+
+	// Lowering the max bytes frees unused buffers
+	pool->SetMaxBytes(0);
+	CHECK(pool->GetBytes() == 0);
+
+	// A full pool frees returned buffers
+	pool->GetImage(320, 180, QImage::Format_RGBA8888_Premultiplied).reset();
+	CHECK(pool->GetBytes() == 0);
+	CHECK(pool->GetReleased() == 1);
+
+	Json::Value stats = pool->JsonValue();
+	CHECK(stats["misses"].asInt64() == 2);
+	CHECK(stats["released"].asInt64() == 1);
+
+	pool->SetMaxBytes(max_bytes);
+}
@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Unit tests for openshot::CacheContent
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <memory>
+
+#include "openshot_catch.h"
+
+#include "CacheContent.h"
+#include "CacheMemory.h"
+#include "Frame.h"
+#include "Json.h"
+
+using namespace openshot;
+
+TEST_CASE( "add and get frames by number", "[libopenshot][cachecontent]" )
+{
+	CacheMemory content;
+	CacheContent c(&content);
+
+	for (int i = 1; i <= 10; i++)
+	{
+		auto f = std::make_shared<Frame>(i, 320, 240, "#000000");
+		c.Add(f);
+	}
+
+	CHECK(c.Count() == 10);
+	CHECK(c.Contains(5));
+	CHECK_FALSE(c.Contains(11));
+	CHECK(c.GetFrame(5)->number == 5);
+	CHECK(c.GetFrame(11) == nullptr);
+	CHECK(c.GetSmallestFrame()->number == 1);
+}
+
+TEST_CASE( "reuse content by key", "[libopenshot][cachecontent]" )
+{
+	CacheMemory content;
+	CacheContent c(&content);
+
+	// Frames with the same key share their content
+	auto f1 = std::make_shared<Frame>(1, 320, 240, "#ff0000");
+	auto f2 = std::make_shared<Frame>(2, 320, 240, "#ff0000");
+	c.Add(f1, 100);
+	c.Add(f2, 100);
+	CHECK(c.Count() == 2);
+	CHECK(content.Count() == 1);
+
+	// Removing frame numbers keeps the content
+	c.Remove(1, 2);
+	CHECK(c.Count() == 0);
+	CHECK_FALSE(c.Contains(1));
+	CHECK(c.ContainsKey(100));
+
+	// Content is assigned to the requested frame number
+	auto f3 = c.GetFrame(30, 100);
+	REQUIRE(f3 != nullptr);
+	CHECK(f3->number == 30);
+	CHECK(f3->GetImage()->pixelColor(10, 10).red() == 255);
+	CHECK(f3->GetImage()->pixelColor(10, 10).green() == 0);
+	CHECK(c.Contains(30));
+	CHECK(c.GetFrame(31, 200) == nullptr);
+
+	// Clear removes all content
+	c.Clear();
+	CHECK(c.Count() == 0);
+	CHECK_FALSE(c.ContainsKey(100));
+	CHECK(content.Count() == 0);
+}
+
+TEST_CASE( "JSON ranges", "[libopenshot][cachecontent]" )
+{
+	CacheMemory content;
+	CacheContent c(&content);
+
+	for (int i = 1; i <= 10; i++)
+	{
+		auto f = std::make_shared<Frame>(i, 32, 24, "#000000");
+		c.Add(f, i % 2);
+	}
+	c.Remove(5);
+
+	Json::Value root = c.JsonValue();
+	CHECK(root["type"].asString() == "CacheContent");
+	CHECK(root["ranges"].size() == 2);
+	CHECK(root["ranges"][0]["start"].asString() == "1");
+	CHECK(root["ranges"][0]["end"].asString() == "4");
+	CHECK(root["ranges"][1]["start"].asString() == "6");
+	CHECK(root["ranges"][1]["end"].asString() == "10");
+}
+
+TEST_CASE( "forget evicted content", "[libopenshot][cachecontent]" )
+{
+	// The content cache keeps its 20 newest frames
+	CacheMemory content(1);
+	CacheContent c(&content);
+
+	for (int i = 1; i <= 300; i++)
+	{
+		auto f = std::make_shared<Frame>(i, 32, 24, "#000000");
+		c.Add(f, i);
+	}
+
+	CHECK(content.Count() == 20);
+	CHECK(c.Count() == 20);
+	CHECK_FALSE(c.ContainsKey(1));
+
+	// Frame numbers of evicted content are pruned (so they don't grow without bound)
+	Json::Value root = c.JsonValue();
+	REQUIRE(root["ranges"].size() == 1);
+	CHECK(std::stoi(root["ranges"][0]["start"].asString()) > 250);
+	CHECK(root["ranges"][0]["end"].asString() == "300");
+}
+
+TEST_CASE( "max bytes of the content cache", "[libopenshot][cachecontent]" )
+{
+	CacheMemory content(1024 * 1024);
+	CacheContent c(&content);
+	CHECK(c.GetMaxBytes() == 1024 * 1024);
+
+	// Size changes are forwarded to the content cache
+	c.SetMaxBytesFromInfo(10, 320, 240, 44100, 2);
+	CHECK(c.GetMaxBytes() > 0);
+	CHECK(content.GetMaxBytes() == c.GetMaxBytes());
+	CHECK(c.JsonValue()["max_bytes"].asString() == std::to_string(c.GetMaxBytes()));
+}
@@ -10,8 +10,10 @@
 //
 // SPDX-License-Identifier: LGPL-3.0-or-later
 
+#include <cmath>
 #include <sstream>
 #include <memory>
+#include <vector>
 
 #include "openshot_catch.h"
 
@@ -27,7 +29,10 @@
 #include "Fraction.h"
 #include "Timeline.h"
 #include "Json.h"
+#include "Settings.h"
 #include "effects/Negate.h"
+#include "audio_effects/Delay.h"
+#include "audio_effects/Echo.h"
 
 using namespace openshot;
 
@@ -338,6 +343,94 @@ TEST_CASE( "access frames past reader length", "[libopenshot][clip]" )
     CHECK(frame->GetAudioSamples(0)[1200] == Approx(0.0).margin(0.00001));
 }
 
+TEST_CASE( "stateful audio effects out of order", "[libopenshot][clip]" )
+{
+    // Create cache object to hold test frames
+    openshot::CacheMemory cache;
+
+    // Create test frames with a continuous sine wave
+    int sample_count = 1470;
+    for (int64_t frame_number = 1; frame_number <= 30; frame_number++) {
+        auto f = std::make_shared<openshot::Frame>(frame_number, sample_count, 2);
+        std::vector<float> audio_buffer(sample_count);
+        for (int sample_number = 0; sample_number < sample_count; sample_number++) {
+            int64_t position = (frame_number - 1) * sample_count + sample_number;
+            audio_buffer[sample_number] = std::sin(position * 2.0 * M_PI * 440.0 / 44100.0);
+        }
+        f->AddAudio(true, 0, 0, audio_buffer.data(), sample_count, 1.0);
+        f->AddAudio(true, 1, 0, audio_buffer.data(), sample_count, 1.0);
+        cache.Add(f);
+    }
+
+    openshot::DummyReader r(openshot::Fraction(30, 1), 1920, 1080, 44100, 2, 1.0, &cache);
+    r.Open();
+
+    // Render the clip in order
+    openshot::Delay d1(0.1);
+    openshot::Echo e1(0.05, 0.5, 0.5);
+    openshot::Clip c1;
+    c1.Reader(&r);
+    c1.AddEffect(&d1);
+    c1.AddEffect(&e1);
+    c1.Open();
+
+    std::vector<std::shared_ptr<openshot::Frame>> in_order;
+    for (int64_t frame_number = 1; frame_number <= 30; frame_number++)
+        in_order.push_back(c1.GetFrame(frame_number));
+
+    // Render the same clip out of order (each seek pre-rolls the effects)
+    openshot::Delay d2(0.1);
+    openshot::Echo e2(0.05, 0.5, 0.5);
+    openshot::Clip c2;
+    c2.Reader(&r);
+    c2.AddEffect(&d2);
+    c2.AddEffect(&e2);
+    c2.Open();
+
+    for (int64_t frame_number : {20, 21, 5, 22, 6, 30}) {
+        std::shared_ptr<openshot::Frame> f = c2.GetFrame(frame_number);
+        std::shared_ptr<openshot::Frame> expected = in_order[frame_number - 1];
+        for (int sample_number = 0; sample_number < sample_count; sample_number += 49) {
+            // The echo is pre-rolled until it decays below -60 dB
+            CHECK(f->GetAudioSamples(0)[sample_number] == Approx(expected->GetAudioSamples(0)[sample_number]).margin(0.001));
+            CHECK(f->GetAudioSamples(1)[sample_number] == Approx(expected->GetAudioSamples(1)[sample_number]).margin(0.001));
+        }
+    }
+}
+
+TEST_CASE( "pre-roll the audio effects of a video file", "[libopenshot][clip]" )
+{
+    std::stringstream path;
+    path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+
+    // Render the clip in order
+    openshot::Echo e1(0.05, 0.5, 0.5);
+    openshot::Clip c1(path.str());
+    c1.AddEffect(&e1);
+    c1.Open();
+
+    std::vector<std::shared_ptr<openshot::Frame>> in_order;
+    for (int64_t frame_number = 1; frame_number <= 40; frame_number++)
+        in_order.push_back(c1.GetFrame(frame_number));
+
+    // Render the same clip out of order (the pre-roll only decodes audio)
+    openshot::Echo e2(0.05, 0.5, 0.5);
+    openshot::Clip c2(path.str());
+    c2.AddEffect(&e2);
+    c2.Open();
+
+    for (int64_t frame_number : {30, 10, 40}) {
+        std::shared_ptr<openshot::Frame> f = c2.GetFrame(frame_number);
+        std::shared_ptr<openshot::Frame> expected = in_order[frame_number - 1];
+        CHECK(f->GetImage()->width() == 1280);
+        REQUIRE(f->GetAudioSamplesCount() == expected->GetAudioSamplesCount());
+        for (int sample_number = 0; sample_number < f->GetAudioSamplesCount(); sample_number += 49) {
+            CHECK(f->GetAudioSamples(0)[sample_number] == Approx(expected->GetAudioSamples(0)[sample_number]).margin(0.001));
+            CHECK(f->GetAudioSamples(1)[sample_number] == Approx(expected->GetAudioSamples(1)[sample_number]).margin(0.001));
+        }
+    }
+}
+
 TEST_CASE( "setting and clobbering readers", "[libopenshot][clip]" )
 {
     // Create a dummy reader #1, with a pre-existing cache
@@ -369,3 +462,46 @@ TEST_CASE( "setting and clobbering readers", "[libopenshot][clip]" )
     // Clobber reader 2 with reader 1
     c1.Reader(&r1);
 }
+
+TEST_CASE( "proxy reader", "[libopenshot][clip]" )
+{
+    // A 1080p reader, and a (red) 540p proxy of it
+    openshot::DummyReader r(openshot::Fraction(30, 1), 1920, 1080, 44100, 2, 1.0);
+    openshot::CacheMemory proxy_cache;
+    auto proxy_frame = std::make_shared<openshot::Frame>(1, 960, 540, "#ff0000");
+    proxy_cache.Add(proxy_frame);
+    openshot::DummyReader proxy(openshot::Fraction(30, 1), 960, 540, 44100, 2, 1.0, &proxy_cache);
+
+    Timeline t(1920, 1080, openshot::Fraction(30, 1), 44100, 2, openshot::LAYOUT_STEREO);
+    Clip c1(&r);
+    c1.Proxy(&proxy);
+    CHECK(c1.Proxy() == &proxy);
+    t.AddClip(&c1);
+    t.Open();
+
+    // The proxy is too small for a full size preview
+    CHECK_FALSE(c1.UsingProxy());
+
+    // But large enough for a half size preview
+    t.SetMaxSize(960, 540);
+    CHECK(c1.UsingProxy());
+    std::shared_ptr<openshot::Frame> f = t.GetFrame(1);
+    CHECK(f->GetImage()->width() == 960);
+    CHECK(f->GetImage()->pixelColor(480, 270) == QColor(Qt::red));
+
+    // Unless the clip is scaled up
+    c1.scale_x = openshot::Keyframe(2.0);
+    CHECK_FALSE(c1.UsingProxy());
+    c1.scale_x = openshot::Keyframe(1.0);
+
+    // Or proxies are disabled (i.e. when exporting)
+    openshot::Settings::Instance()->USE_PROXY_MEDIA = false;
+    CHECK_FALSE(c1.UsingProxy());
+    openshot::Settings::Instance()->USE_PROXY_MEDIA = true;
+
+    // Remove the proxy
+    c1.Proxy((openshot::ReaderBase*) NULL);
+    CHECK(c1.Proxy() == nullptr);
+    CHECK_FALSE(c1.UsingProxy());
+    t.Close();
+}
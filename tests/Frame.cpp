@@ -13,6 +13,7 @@
 
 #include <sstream>
 #include <memory>
+#include <vector>
 
 #include <QImage>
 
@@ -138,6 +139,34 @@ TEST_CASE( "Copy_Constructor", "[libopenshot][frame]" )
 	CHECK(f1.GetAudioSamplesCount() == f2.GetAudioSamplesCount());
 }
 
+TEST_CASE( "AddAudioWithRamp", "[libopenshot][frame]" )
+{
+	const int sample_count = 1000;
+	std::vector<float> source(sample_count, 0.5f);
+
+	// Mix a source into silence (and into existing audio), while ramping its gain
+	openshot::Frame f1(1, sample_count, 2);
+	f1.AddAudioSilence(sample_count);
+	f1.AddAudioWithRamp(0, 0, source.data(), sample_count, 0.0f, 1.0f);
+	f1.AddAudioWithRamp(1, 0, source.data(), sample_count, 1.0f, 1.0f);
+	f1.AddAudioWithRamp(1, 0, source.data(), sample_count, 1.0f, 0.0f);
+
+	// Same result as applying a gain ramp to the source, and then adding its samples
+	openshot::Frame f2(1, sample_count, 2);
+	f2.AddAudio(true, 0, 0, source.data(), sample_count, 1.0f);
+	f2.ApplyGainRamp(0, 0, sample_count, 0.0f, 1.0f);
+
+	for (int sample = 0; sample < sample_count; sample += 100) {
+		CHECK(f1.GetAudioSamples(0)[sample] == Approx(f2.GetAudioSamples(0)[sample]).margin(0.00001));
+		CHECK(f1.GetAudioSamples(0)[sample] == Approx(0.5f * sample / sample_count).margin(0.00001));
+		CHECK(f1.GetAudioSamples(1)[sample] == Approx(0.5f + 0.5f * (1.0f - float(sample) / sample_count)).margin(0.00001));
+	}
+
+	// The source samples are not changed
+	CHECK(source[sample_count - 1] == 0.5f);
+	CHECK(f1.has_audio_data);
+}
+
 #ifdef USE_OPENCV
 TEST_CASE( "Convert_Image", "[libopenshot][opencv][frame]" )
 {
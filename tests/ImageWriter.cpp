@@ -116,4 +116,64 @@ TEST_CASE( "Gif", "[libopenshot][imagewriter]" )
 	CHECK((int)pixels[pixel_index + 2] == Approx(11).margin(5));
 	CHECK((int)pixels[pixel_index + 3] == Approx(255).margin(5));
 }
+
+TEST_CASE( "Gif written in batches", "[libopenshot][imagewriter]" )
+{
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	FFmpegReader r(path.str());
+	r.Open();
+
+	// The animated GIF is appended to (in batches of 4 frames)
+	ImageWriter w("output-batches.gif");
+	w.SetVideoOptions("GIF", r.info.fps, 320, 180, 70, 0, true);
+	w.SetCacheSize(4);
+	w.Open();
+	w.WriteFrame(&r, 500, 509);
+	w.Close();
+	r.Close();
+
+	// Every frame is part of the GIF (including the last, partial batch)
+	for (int index : {0, 4, 9}) {
+		std::stringstream image_path;
+		image_path << "output-batches.gif[" << index << "]";
+		ImageReader r1(image_path.str());
+		r1.Open();
+		CHECK(r1.info.width == 320);
+		CHECK(r1.info.height == 180);
+		r1.Close();
+	}
+}
+
+TEST_CASE( "Image sequence", "[libopenshot][imagewriter]" )
+{
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	FFmpegReader r(path.str());
+	r.Open();
+
+	// Write each frame as its own image (written in batches of 4 frames)
+	ImageWriter w("output-sequence-%02d.png");
+	w.SetVideoOptions("PNG", r.info.fps, 320, 180, 70, 0, false);
+	w.SetCacheSize(4);
+	w.Open();
+	w.WriteFrame(&r, 500, 509);
+	w.Close();
+	r.Close();
+
+	// The images are numbered in order (starting at 0)
+	for (int index : {0, 4, 9}) {
+		std::stringstream image_path;
+		image_path << "output-sequence-0" << index << ".png";
+		ImageReader r1(image_path.str());
+		r1.Open();
+		CHECK(r1.info.width == 320);
+		CHECK(r1.info.height == 180);
+		r1.Close();
+	}
+
+	// No other images are written
+	ImageReader r2("output-sequence-10.png");
+	CHECK_THROWS_AS(r2.Open(), InvalidFile);
+}
 #endif  // USE_IMAGEMAGICK
@@ -569,6 +569,42 @@ R"(│Frame# (X) │     Y Value │ Delta Y │ Increasing? │ Repeat Fraction
     CHECK(output.str().substr(0, expected.size()) == expected);
 }
 
+TEST_CASE( "GetChangedRange", "[libopenshot][keyframe]" )
+{
+	Keyframe kf1;
+	kf1.AddPoint(1, 0, LINEAR);
+	kf1.AddPoint(50, 10, LINEAR);
+	kf1.AddPoint(100, 20, LINEAR);
+	kf1.AddPoint(200, 0, LINEAR);
+
+	int64_t first = 0;
+	int64_t last = 0;
+
+	// Identical curves
+	Keyframe kf2(kf1);
+	CHECK_FALSE(kf2.GetChangedRange(kf1, 1, 300, first, last));
+
+	// Moving a point only changes its neighbouring segments
+	kf2.RemovePoint(Point(100, 20));
+	kf2.AddPoint(100, 30, LINEAR);
+	CHECK(kf2.GetChangedRange(kf1, 1, 300, first, last));
+	CHECK(first == 51);
+	CHECK(last == 199);
+
+	// Range is limited to the requested indexes
+	CHECK(kf2.GetChangedRange(kf1, 120, 150, first, last));
+	CHECK(first == 120);
+	CHECK(last == 150);
+	CHECK_FALSE(kf2.GetChangedRange(kf1, 1, 50, first, last));
+
+	// Changing the last point affects every index after it
+	Keyframe kf3(kf1);
+	kf3.AddPoint(250, 5, LINEAR);
+	CHECK(kf3.GetChangedRange(kf1, 1, 300, first, last));
+	CHECK(first == 201);
+	CHECK(last == 300);
+}
+
 #ifdef USE_OPENCV
 TEST_CASE( "TrackedObjectBBox init", "[libopenshot][keyframe]" )
 {
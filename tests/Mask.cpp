@@ -0,0 +1,113 @@
+/**
+ * @file
+ * @brief Unit tests for openshot::Mask effect
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2021 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+
+#include "openshot_catch.h"
+
+#include "Frame.h"
+#include "QtImageReader.h"
+#include "effects/Mask.h"
+
+#include <QColor>
+#include <QImage>
+
+using namespace openshot;
+
+// Reference mask (the previous per-pixel implementation), used to check the effect
+static QImage reference_mask(QImage image, QImage mask, double brightness, double contrast)
+{
+	mask = mask.convertToFormat(QImage::Format_RGBA8888_Premultiplied).scaled(
+		image.width(), image.height(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+	unsigned char *pixels = image.bits();
+	const unsigned char *mask_pixels = mask.constBits();
+
+	for (int pixel = 0, byte_index = 0; pixel < mask.width() * mask.height(); pixel++, byte_index += 4) {
+		int gray_value = qGray(mask_pixels[byte_index], mask_pixels[byte_index + 1], mask_pixels[byte_index + 2]);
+		gray_value += (255 * brightness);
+		float factor = (20 / std::fmax(0.00001, 20.0 - contrast));
+		gray_value = (factor * (gray_value - 128) + 128);
+		float alpha_percent = float(std::min(255, std::max(0, mask_pixels[byte_index + 3] - gray_value))) / 255.0;
+		for (int ch = 0; ch < 4; ch++)
+			pixels[byte_index + ch] *= alpha_percent;
+	}
+	return image;
+}
+
+static int max_difference(const QImage& a, const QImage& b)
+{
+	int difference = 0;
+	const unsigned char *a_pixels = a.constBits();
+	const unsigned char *b_pixels = b.constBits();
+	for (int i = 0; i < a.width() * a.height() * 4; i++)
+		difference = std::max(difference, std::abs(a_pixels[i] - b_pixels[i]));
+	return difference;
+}
+
+TEST_CASE( "mask matches reference", "[libopenshot][effect][mask]" )
+{
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "mask.png";
+	QtImageReader r(path.str());
+	Mask e(&r, Keyframe(0.1), Keyframe(3.0));
+
+	QImage mask(QString::fromStdString(path.str()));
+
+	// Apply the mask to frames of different sizes (the cached mask is rescaled)
+	for (int width : {640, 320, 640}) {
+		int height = width * 9 / 16;
+		auto f = std::make_shared<Frame>(1, width, height, "#00ff00");
+		QImage expected = reference_mask(*f->GetImage(), mask, 0.1, 3.0);
+
+		auto f_out = e.GetFrame(f, 1);
+		std::shared_ptr<QImage> i = f_out->GetImage();
+
+		CHECK(i->width() == width);
+		CHECK(i->height() == height);
+		CHECK(max_difference(*i, expected) <= 1);
+	}
+}
+
+TEST_CASE( "replace image", "[libopenshot][effect][mask]" )
+{
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "mask.png";
+	QtImageReader r(path.str());
+	Mask e(&r, Keyframe(0.0), Keyframe(3.0));
+	e.replace_image = true;
+
+	auto f = std::make_shared<Frame>(1, 320, 180, "#00ff00");
+	auto f_out = e.GetFrame(f, 1);
+	std::shared_ptr<QImage> i = f_out->GetImage();
+
+	// Every pixel is replaced with its (gray) mask value
+	for (int y = 0; y < i->height(); y += 20) {
+		for (int x = 0; x < i->width(); x += 20) {
+			QRgb pixel = i->pixel(x, y);
+			CHECK(qRed(pixel) == qGreen(pixel));
+			CHECK(qGreen(pixel) == qBlue(pixel));
+		}
+	}
+}
+
+TEST_CASE( "no reader", "[libopenshot][effect][mask]" )
+{
+	Mask e;
+
+	// Without a mask reader, the frame is not changed
+	auto f = std::make_shared<Frame>(1, 320, 180, "#00ff00");
+	auto f_out = e.GetFrame(f, 1);
+	CHECK(f_out->GetImage()->pixelColor(160, 90) == QColor(Qt::green));
+}
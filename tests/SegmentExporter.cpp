@@ -0,0 +1,180 @@
+/**
+ * @file
+ * @brief Unit tests for openshot::SegmentExporter
+ * @author Jonathan Thomas <jonathan@openshot.org>
+ *
+ * @ref License
+ */
+
+// Copyright (c) 2008-2019 OpenShot Studios, LLC
+//
+// SPDX-License-Identifier: LGPL-3.0-or-later
+
+#include <sstream>
+#include <memory>
+
+#include "openshot_catch.h"
+
+#include <QColor>
+#include <QImage>
+#include <QPoint>
+
+#include "SegmentExporter.h"
+#include "Clip.h"
+#include "Exceptions.h"
+#include "FFmpegReader.h"
+#include "Fraction.h"
+#include "Frame.h"
+#include "Timeline.h"
+
+using namespace openshot;
+
+TEST_CASE( "Export_Segments", "[libopenshot][segmentexporter]" )
+{
+	// Timeline with a video (and audio) clip
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	Timeline t(640, 360, Fraction(24, 1), 44100, 2, LAYOUT_STEREO);
+	Clip c(path.str());
+	t.AddClip(&c);
+
+	// Export 3 segments (of 2 GOPs each)
+	SegmentExporter e(&t, "output-segments.mp4");
+	e.SetVideoOptions(true, "mpeg4", Fraction(24, 1), 640, 360, Fraction(1, 1), false, false, 2000000);
+	e.SetAudioOptions(true, "aac", 44100, 2, LAYOUT_STEREO, 128000);
+	e.SetGopSize(12);
+	e.SetSegments(3);
+	e.Export(1, 72);
+	CHECK(e.Progress() == Approx(1.0f));
+
+	FFmpegReader r("output-segments.mp4");
+	r.Open();
+
+	// Verify the joined segments
+	CHECK(r.info.has_video);
+	CHECK(r.info.has_audio);
+	CHECK(r.info.width == 640);
+	CHECK(r.info.height == 360);
+	CHECK(r.info.fps.num == 24);
+	CHECK(r.info.fps.den == 1);
+	CHECK(r.info.video_length == Approx(72).margin(1));
+
+	// Frames from the start of each segment
+	for (int64_t number : {1, 25, 49, 72}) {
+		std::shared_ptr<Frame> f = r.GetFrame(number);
+		CHECK(f->GetWidth() == 640);
+		CHECK(f->GetAudioSamplesCount() > 0);
+	}
+	r.Close();
+}
+
+TEST_CASE( "Export_Passthrough", "[libopenshot][segmentexporter]" )
+{
+	// Video file (with GOPs of 12 frames) which matches the export
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	Timeline t1(640, 360, Fraction(24, 1), 44100, 2, LAYOUT_STEREO);
+	Clip c1(path.str());
+	t1.AddClip(&c1);
+	SegmentExporter e1(&t1, "output-passthrough-source.mp4");
+	e1.SetVideoOptions(true, "mpeg4", Fraction(24, 1), 640, 360, Fraction(1, 1), false, false, 2000000);
+	e1.SetGopSize(12);
+	e1.SetSegments(1);
+	e1.Export(1, 72);
+
+	// Copy the whole GOPs of an untouched clip (starting mid GOP)
+	Timeline t2(640, 360, Fraction(24, 1), 44100, 2, LAYOUT_STEREO);
+	Clip c2("output-passthrough-source.mp4");
+	c2.Start(0.25);
+	t2.AddClip(&c2);
+	SegmentExporter e2(&t2, "output-passthrough.mp4");
+	e2.SetVideoOptions(true, "mpeg4", Fraction(24, 1), 640, 360, Fraction(1, 1), false, false, 2000000);
+	e2.SetGopSize(12);
+	e2.SetSegments(2);
+	e2.SetPassthrough(true);
+	CHECK(e2.GetPassthrough());
+	e2.Export(1, 48);
+	CHECK(e2.Progress() == Approx(1.0f));
+
+	FFmpegReader source("output-passthrough-source.mp4");
+	source.Open();
+	FFmpegReader r("output-passthrough.mp4");
+	r.Open();
+	CHECK(r.info.has_video);
+	CHECK(r.info.width == 640);
+	CHECK(r.info.height == 360);
+	CHECK(r.info.video_length == Approx(48).margin(1));
+
+	// The source key frames (13, 25, 37 and 49) are frames 7, 19, 31 and 43, so compare the frames on
+	// both sides of each join between copied and encoded frames (and between the segments) with the source
+	for (int64_t number : {1, 6, 7, 18, 19, 24, 25, 30, 31, 42, 43, 48}) {
+		std::shared_ptr<Frame> f = r.GetFrame(number);
+		std::shared_ptr<Frame> expected = source.GetFrame(number + 6);
+		REQUIRE(f->GetWidth() == 640);
+		for (QPoint point : {QPoint(160, 90), QPoint(320, 180), QPoint(480, 270)}) {
+			QColor pixel = f->GetImage()->pixelColor(point);
+			QColor expected_pixel = expected->GetImage()->pixelColor(point);
+			CHECK(pixel.red() == Approx(expected_pixel.red()).margin(24));
+			CHECK(pixel.green() == Approx(expected_pixel.green()).margin(24));
+			CHECK(pixel.blue() == Approx(expected_pixel.blue()).margin(24));
+		}
+	}
+	r.Close();
+	source.Close();
+}
+
+TEST_CASE( "Export_Passthrough_H264", "[libopenshot][segmentexporter]" )
+{
+	// A real H.264 video file, whose headers (SPS / PPS) don't match the encoder
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	Timeline t(1280, 720, Fraction(24, 1), 44100, 2, LAYOUT_STEREO);
+	Clip c(path.str());
+	t.AddClip(&c);
+
+	// The untouched clip is encoded (instead of copied), so every part shares the same headers
+	SegmentExporter e(&t, "output-passthrough-h264.mp4");
+	e.SetVideoOptions(true, "libx264", Fraction(24, 1), 1280, 720, Fraction(1, 1), false, false, 4000000);
+	e.SetGopSize(12);
+	e.SetSegments(2);
+	e.SetPassthrough(true);
+	e.Export(1, 48);
+	CHECK(e.Progress() == Approx(1.0f));
+
+	FFmpegReader source(path.str());
+	source.Open();
+	FFmpegReader r("output-passthrough-h264.mp4");
+	r.Open();
+	CHECK(r.info.vcodec == "h264");
+	CHECK(r.info.width == 1280);
+	CHECK(r.info.height == 720);
+	CHECK(r.info.video_length == Approx(48).margin(1));
+
+	// Every frame decodes (and matches the video file)
+	for (int64_t number : {1, 12, 13, 24, 25, 48}) {
+		std::shared_ptr<Frame> f = r.GetFrame(number);
+		std::shared_ptr<Frame> expected = source.GetFrame(number);
+		CHECK(f->GetWidth() == 1280);
+		QColor pixel = f->GetImage()->pixelColor(640, 360);
+		QColor expected_pixel = expected->GetImage()->pixelColor(640, 360);
+		CHECK(pixel.red() == Approx(expected_pixel.red()).margin(24));
+		CHECK(pixel.green() == Approx(expected_pixel.green()).margin(24));
+		CHECK(pixel.blue() == Approx(expected_pixel.blue()).margin(24));
+	}
+	r.Close();
+	source.Close();
+}
+
+TEST_CASE( "Invalid_Options", "[libopenshot][segmentexporter]" )
+{
+	Timeline t(640, 360, Fraction(24, 1), 44100, 2, LAYOUT_STEREO);
+	SegmentExporter e(&t, "output-segments.mp4");
+
+	// No video stream
+	CHECK_THROWS_AS(e.Export(1, 10), InvalidOptions);
+
+	e.SetVideoOptions(true, "mpeg4", Fraction(24, 1), 640, 360, Fraction(1, 1), false, false, 2000000);
+	CHECK_THROWS_AS(e.Export(10, 1), InvalidOptions);
+	CHECK_THROWS_AS(e.SetGopSize(0), InvalidOptions);
+	CHECK_THROWS_AS(e.SetSegments(0), InvalidOptions);
+}
@@ -14,6 +14,8 @@
 #include <sstream>
 #include <memory>
 #include <list>
+#include <map>
+#include <vector>
 #include <omp.h>
 
 #include "openshot_catch.h"
@@ -24,6 +26,7 @@
 #include "Fraction.h"
 #include "effects/Blur.h"
 #include "effects/Negate.h"
+#include "Profiler.h"
 
 using namespace openshot;
 
@@ -797,3 +800,181 @@ TEST_CASE( "ApplyJSONDiff and FrameMappers", "[libopenshot][timeline]" )
 	CHECK(clip1.Reader()->Name() == "QtImageReader");
 
 }
+
+TEST_CASE( "ApplyJSONDiff clears the reader cache when scaling up", "[libopenshot][timeline]" )
+{
+	// A half size preview of a 720p clip
+	Timeline t(1280, 720, Fraction(24, 1), 44100, 2, LAYOUT_STEREO);
+	t.SetMaxSize(640, 360);
+
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	Clip c(path.str());
+	c.Id("C1");
+	t.AddClip(&c);
+	t.Open();
+
+	// The reader decodes (and caches) images at the preview size
+	t.GetFrame(1);
+	CHECK(c.Reader()->GetFrame(1)->GetWidth() == 640);
+
+	// Scaling the clip up (with a JSON diff) needs larger images
+	std::stringstream json_change;
+	json_change << "[{\"type\":\"update\",\"key\":[\"clips\",{\"id\":\"C1\"}],\"value\":{\"id\":\"C1\",\"scale_x\":{\"Points\":[{\"co\":{\"X\":1.0,\"Y\":2.0},\"interpolation\":1}]}},\"partial\":false}]";
+	t.ApplyJsonDiff(json_change.str());
+
+	t.GetFrame(1);
+	CHECK(c.Reader()->GetFrame(1)->GetWidth() == 1280);
+	t.Close();
+}
+
+TEST_CASE( "SetJson reuses unchanged clips and readers", "[libopenshot][timeline]" )
+{
+	// Create a timeline
+	Timeline t(640, 480, Fraction(30, 1), 44100, 2, LAYOUT_STEREO);
+
+	// Create a project with 2 clips
+	std::stringstream path1;
+	path1 << TEST_MEDIA_PATH << "interlaced.png";
+	Clip clip1(path1.str());
+	clip1.Id("C1");
+	clip1.Layer(1);
+	clip1.End(10);
+	Clip clip2(path1.str());
+	clip2.Id("C2");
+	clip2.Layer(2);
+	clip2.End(10);
+
+	Json::Value project = t.JsonValue();
+	project["clips"].append(clip1.JsonValue());
+	project["clips"].append(clip2.JsonValue());
+	t.SetJsonValue(project);
+	t.Open();
+
+	Clip* c1 = t.GetClip("C1");
+	Clip* c2 = t.GetClip("C2");
+	REQUIRE(c1 != nullptr);
+	REQUIRE(c2 != nullptr);
+	ReaderBase* c1_reader = c1->Reader();
+	CHECK(c1_reader->Name() == "FrameMapper");
+
+	// Render a frame (and verify it's cached)
+	t.GetFrame(1);
+	CHECK(t.GetCache()->Count() == 1);
+
+	// Re-send the same project, with only an alpha change on clip 2
+	project["clips"][1]["alpha"] = Keyframe(0.5).JsonValue();
+	t.SetJsonValue(project);
+
+	// Clips and readers are kept (not re-created)
+	CHECK(t.GetClip("C1") == c1);
+	CHECK(t.GetClip("C2") == c2);
+	CHECK(c1->Reader() == c1_reader);
+	CHECK(c2->alpha.GetValue(1) == Approx(0.5).margin(0.0001));
+
+	// Re-send the project without clip 1 (only clip 2 remains)
+	Json::Value removed_clip = project;
+	removed_clip["clips"] = Json::Value(Json::arrayValue);
+	removed_clip["clips"].append(project["clips"][1]);
+	t.SetJsonValue(removed_clip);
+
+	CHECK(t.GetClip("C1") == nullptr);
+	CHECK(t.GetClip("C2") == c2);
+	CHECK(t.Clips().size() == 1);
+
+	t.Close();
+}
+
+TEST_CASE( "AudioOnly", "[libopenshot][timeline]" )
+{
+	// Create a timeline
+	Timeline t(1280, 720, Fraction(30, 1), 44100, 2, LAYOUT_STEREO);
+
+	// Add a video clip (with audio), and an effect which only modifies video
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	Clip clip(path.str());
+	clip.Layer(1);
+	Blur blur(Keyframe(5.0), Keyframe(5.0), Keyframe(3.0), Keyframe(3.0));
+	clip.AddEffect(&blur);
+	t.AddClip(&clip);
+	t.Open();
+
+	CHECK_FALSE(t.AudioOnly());
+	std::shared_ptr<Frame> f = t.GetFrame(100);
+	CHECK(f->GetWidth() == 1280);
+	std::vector<float> samples(f->GetAudioSamples(0), f->GetAudioSamples(0) + f->GetAudioSamplesCount());
+
+	// Only render audio (frames have no image, and the same audio)
+	t.AudioOnly(true);
+	CHECK(t.AudioOnly());
+	std::shared_ptr<Frame> audio_frame = t.GetFrame(100);
+	CHECK(audio_frame->GetWidth() == 1);
+	CHECK(audio_frame->GetHeight() == 1);
+	REQUIRE(audio_frame->GetAudioSamplesCount() == (int) samples.size());
+	for (int s = 0; s < audio_frame->GetAudioSamplesCount(); s += 100)
+		CHECK(audio_frame->GetAudioSamples(0)[s] == Approx(samples[s]).margin(0.0001));
+
+	// Render both audio and video again
+	t.AudioOnly(false);
+	f = t.GetFrame(100);
+	CHECK(f->GetWidth() == 1280);
+
+	t.Close();
+}
+
+TEST_CASE( "Profiling", "[libopenshot][timeline]" )
+{
+	// Create a timeline
+	Timeline t(640, 480, Fraction(30, 1), 44100, 2, LAYOUT_STEREO);
+
+	std::stringstream path;
+	path << TEST_MEDIA_PATH << "sintel_trailer-720p.mp4";
+	Clip clip(path.str());
+	clip.Id("C1");
+	clip.Layer(1);
+	Blur blur(Keyframe(5.0), Keyframe(5.0), Keyframe(3.0), Keyframe(3.0));
+	blur.Id("E1");
+	clip.AddEffect(&blur);
+	t.AddClip(&clip);
+	t.Open();
+
+	Profiler *profiler = Profiler::Instance();
+	profiler->Reset();
+	profiler->Enable(true, true);
+
+	// Render 2 frames, and request the 1st frame again (from the cache)
+	t.GetFrame(1);
+	t.GetFrame(2);
+	t.GetFrame(1);
+	profiler->Enable(false);
+
+	Json::Value root = openshot::stringToJson(t.ProfileJson());
+	std::map<std::string, int64_t> timer_counts;
+	for (const auto& timer : root["timers"])
+		timer_counts[timer["category"].asString() + ":" + timer["name"].asString()] = timer["count"].asInt64();
+	std::map<std::string, int64_t> counter_counts;
+	for (const auto& counter : root["counters"])
+		counter_counts[counter["name"].asString()] = counter["count"].asInt64();
+
+	CHECK(timer_counts["timeline:GetFrame"] == 3);
+	CHECK(timer_counts["clip:C1"] == 2);
+	CHECK(timer_counts["effect:E1"] == 2);
+	CHECK(timer_counts["composite:C1"] == 2);
+	CHECK(timer_counts["decode:" + path.str()] >= 1);
+	CHECK(counter_counts["hit"] == 1);
+	CHECK(counter_counts["miss"] == 2);
+
+	// Each timing is also a trace event
+	Json::Value trace = openshot::stringToJson(profiler->TraceJson());
+	CHECK(trace["traceEvents"].size() >= 9);
+	CHECK(trace["traceEvents"][0]["ph"].asString() == "X");
+
+	// Nothing is recorded while disabled
+	profiler->Reset();
+	t.GetFrame(3);
+	root = openshot::stringToJson(t.ProfileJson());
+	CHECK(root["timers"].size() == 0);
+
+	t.Close();
+}